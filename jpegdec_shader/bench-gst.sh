@@ -0,0 +1,48 @@
+#!/bin/sh
+# Throughput of glshaderjpegdec against the stock jpegdec ! glupload.
+#
+#   meson setup build && ninja -C build
+#   ./bench-gst.sh build [frames] [width] [height]
+#
+# The pictures are 4:4:4, the element errors out on subsampled ones. Each
+# pipeline ends in GL memory: fakesink stands for a GL consumer that takes
+# the textures as they are, glimagesink for the one that shows them. Both
+# paths give RGBA textures, so the stock one goes through glcolorconvert.
+# The NV12 run is the output that skips the color conversion.
+
+BUILD=${1:-build}
+FRAMES=${2:-300}
+WIDTH=${3:-1920}
+HEIGHT=${4:-1080}
+MJPEG=$(mktemp --suffix=.mjpeg)
+
+export GST_PLUGIN_PATH="$BUILD${GST_PLUGIN_PATH:+:$GST_PLUGIN_PATH}"
+trap 'rm -f "$MJPEG"' EXIT
+
+gst-launch-1.0 -q videotestsrc num-buffers=$FRAMES pattern=smpte \
+    ! video/x-raw,format=Y444,width=$WIDTH,height=$HEIGHT \
+    ! jpegenc quality=85 ! filesink location="$MJPEG" || exit 1
+
+run () {
+  name=$1
+  shift
+  start=$(date +%s.%N)
+  gst-launch-1.0 -q filesrc location="$MJPEG" ! jpegparse ! "$@" || exit 1
+  end=$(date +%s.%N)
+  echo "$name" "$start" "$end" | awk -v frames=$FRAMES \
+      '{ printf "%-40s %8.2f fps\n", $1, frames / ($3 - $2) }'
+}
+
+RGBA_GL="video/x-raw(memory:GLMemory),format=RGBA"
+NV12_GL="video/x-raw(memory:GLMemory),format=NV12"
+
+run "jpegdec!glupload!fakesink" \
+    jpegdec ! glupload ! glcolorconvert ! "$RGBA_GL" ! fakesink sync=false
+run "glshaderjpegdec!fakesink" \
+    glshaderjpegdec ! fakesink sync=false
+run "glshaderjpegdec!NV12!fakesink" \
+    glshaderjpegdec ! "$NV12_GL" ! fakesink sync=false
+run "jpegdec!glupload!glimagesink" \
+    jpegdec ! glupload ! glcolorconvert ! "$RGBA_GL" ! glimagesink sync=false
+run "glshaderjpegdec!glimagesink" \
+    glshaderjpegdec ! glimagesink sync=false
@@ -0,0 +1,585 @@
+/*
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ */
+
+/**
+ * SECTION:element-glshaderjpegdec
+ *
+ * Decodes JPEG pictures with the jpegdec_shader passes: the entropy decoding
+ * is done on the CPU, dequantization, IDCT and the color conversion in GL
+ * shaders, straight into the GstGLMemory of the output buffer. Nothing
+ * comes back to the system memory, so downstream GL elements take the
+ * textures as they are.
+ *
+ * Besides RGBA it outputs NV12 and I420, whichever downstream takes first.
+ * These skip the color conversion, the chroma is taken down to 4:2:0 in the
+ * IDCT pass itself, and half as many bytes get written as with RGBA. The
+ * YUV is the one of the file: full range BT.601, as JFIF has it.
+ *
+ * Only 4:4:4 and grayscale pictures are supported, subsampled ones stop the
+ * stream with an error that says which subsampling it is.
+ *
+ * ## Example launch line
+ * |[
+ * gst-launch-1.0 filesrc location=pictures.mjpeg ! jpegparse ! glshaderjpegdec ! glimagesink
+ * ]|
+ * |[
+ * gst-launch-1.0 filesrc location=pictures.mjpeg ! jpegparse ! glshaderjpegdec ! "video/x-raw(memory:GLMemory), format=NV12" ! glimagesink
+ * ]|
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "rf_gl.h"
+#include "rf_jpeg_decoder.h"
+#include "rf_plane_pool.h"
+#include "gstglshaderjpegdec.h"
+#include <gst/gl/gl.h>
+
+GST_DEBUG_CATEGORY_STATIC (gst_gl_shader_jpeg_dec_debug);
+#define GST_CAT_DEFAULT gst_gl_shader_jpeg_dec_debug
+
+/* rf_gl calls the GLES entry points of libGLESv2 directly, and those only
+ * work with a GLES context */
+#define SUPPORTED_GL_APIS GST_GL_API_GLES2
+
+struct _GstGLShaderJpegDec
+{
+  GstVideoDecoder parent;
+
+  GstGLDisplay *display;
+  GstGLContext *context, *other_context;
+
+  GstVideoCodecState *input_state;
+  RFPlanePool *pool;
+
+  /* of the current picture, the GL thread takes them from here */
+  float *planes[3];
+  int plane_width, plane_height;
+  float tables[3][64];
+  RFGLOutput output;
+  /* a texture per plane of the output format */
+  guint out_tex[3];
+
+  /* only touched in the GL thread */
+  RFGLDecoder gl;
+  gboolean gl_ready, gl_failed;
+};
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("image/jpeg, parsed = (boolean) true")
+    );
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (GST_VIDEO_CAPS_MAKE_WITH_FEATURES
+        (GST_CAPS_FEATURE_MEMORY_GL_MEMORY, "{ RGBA, NV12, I420 }") ", "
+        "texture-target = (string) " GST_GL_TEXTURE_TARGET_2D_STR)
+    );
+
+#define gst_gl_shader_jpeg_dec_parent_class parent_class
+G_DEFINE_TYPE (GstGLShaderJpegDec, gst_gl_shader_jpeg_dec,
+    GST_TYPE_VIDEO_DECODER);
+
+static void
+gst_gl_shader_jpeg_dec_set_context (GstElement * element, GstContext * context)
+{
+  GstGLShaderJpegDec *self = GST_GL_SHADER_JPEG_DEC (element);
+
+  gst_gl_handle_set_context (element, context, &self->display,
+      &self->other_context);
+  if (self->display)
+    gst_gl_display_filter_gl_api (self->display, SUPPORTED_GL_APIS);
+
+  GST_ELEMENT_CLASS (parent_class)->set_context (element, context);
+}
+
+static gboolean
+gst_gl_shader_jpeg_dec_ensure_gl_context (GstGLShaderJpegDec * self)
+{
+  GError *error = NULL;
+
+  if (!gst_gl_ensure_element_data (self, &self->display, &self->other_context))
+    return FALSE;
+
+  gst_gl_display_filter_gl_api (self->display, SUPPORTED_GL_APIS);
+
+  if (!self->context)
+    gst_gl_query_local_gl_context (GST_ELEMENT (self), GST_PAD_SRC,
+        &self->context);
+
+  if (!self->context) {
+    GST_OBJECT_LOCK (self->display);
+    do {
+      if (self->context)
+        gst_object_unref (self->context);
+      self->context =
+          gst_gl_display_get_gl_context_for_thread (self->display, NULL);
+      if (!self->context &&
+          !gst_gl_display_create_context (self->display, self->other_context,
+              &self->context, &error)) {
+        GST_OBJECT_UNLOCK (self->display);
+        GST_ELEMENT_ERROR (self, RESOURCE, NOT_FOUND, ("%s", error->message),
+            (NULL));
+        g_clear_error (&error);
+        return FALSE;
+      }
+    } while (!gst_gl_display_add_context (self->display, self->context));
+    GST_OBJECT_UNLOCK (self->display);
+  }
+
+  if (!gst_gl_context_check_gl_version (self->context, GST_GL_API_GLES2, 3,
+          0)) {
+    GST_ELEMENT_ERROR (self, RESOURCE, NOT_FOUND, ("Needs GLES 3.0"), (NULL));
+    return FALSE;
+  }
+
+  /* the dequant passes render to GL_R16F, that GLES 3.0 alone can't */
+  if (!gst_gl_context_check_feature (self->context,
+          "GL_EXT_color_buffer_half_float") &&
+      !gst_gl_context_check_feature (self->context,
+          "GL_EXT_color_buffer_float")) {
+    GST_ELEMENT_ERROR (self, RESOURCE, NOT_FOUND,
+        ("Needs EXT_color_buffer_half_float or EXT_color_buffer_float"),
+        ("R16F is not color-renderable in this context"));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_gl_shader_jpeg_dec_src_query (GstVideoDecoder * decoder, GstQuery * query)
+{
+  GstGLShaderJpegDec *self = GST_GL_SHADER_JPEG_DEC (decoder);
+
+  if (GST_QUERY_TYPE (query) == GST_QUERY_CONTEXT &&
+      gst_gl_handle_context_query (GST_ELEMENT (decoder), query,
+          self->display, self->context, self->other_context))
+    return TRUE;
+
+  return GST_VIDEO_DECODER_CLASS (parent_class)->src_query (decoder, query);
+}
+
+static gboolean
+gst_gl_shader_jpeg_dec_start (GstVideoDecoder * decoder)
+{
+  GstGLShaderJpegDec *self = GST_GL_SHADER_JPEG_DEC (decoder);
+
+  self->pool = rf_plane_pool_new ();
+  self->plane_width = self->plane_height = 0;
+
+  return TRUE;
+}
+
+static void
+gst_gl_shader_jpeg_dec_gl_clear (GstGLContext * context, gpointer data)
+{
+  GstGLShaderJpegDec *self = data;
+
+  rf_gl_decoder_clear (&self->gl);
+  self->gl_ready = FALSE;
+}
+
+static gboolean
+gst_gl_shader_jpeg_dec_stop (GstVideoDecoder * decoder)
+{
+  GstGLShaderJpegDec *self = GST_GL_SHADER_JPEG_DEC (decoder);
+
+  if (self->context && self->gl_ready)
+    gst_gl_context_thread_add (self->context, gst_gl_shader_jpeg_dec_gl_clear,
+        self);
+
+  g_clear_pointer (&self->input_state, gst_video_codec_state_unref);
+  g_clear_pointer (&self->pool, rf_plane_pool_free);
+  gst_clear_object (&self->context);
+  gst_clear_object (&self->other_context);
+  gst_clear_object (&self->display);
+
+  return TRUE;
+}
+
+static gboolean
+gst_gl_shader_jpeg_dec_set_format (GstVideoDecoder * decoder,
+    GstVideoCodecState * state)
+{
+  GstGLShaderJpegDec *self = GST_GL_SHADER_JPEG_DEC (decoder);
+
+  g_clear_pointer (&self->input_state, gst_video_codec_state_unref);
+  self->input_state = gst_video_codec_state_ref (state);
+
+  return TRUE;
+}
+
+static gboolean
+gst_gl_shader_jpeg_dec_decide_allocation (GstVideoDecoder * decoder,
+    GstQuery * query)
+{
+  GstGLShaderJpegDec *self = GST_GL_SHADER_JPEG_DEC (decoder);
+  GstBufferPool *pool = NULL;
+  GstStructure *config;
+  GstVideoInfo vinfo;
+  GstCaps *caps;
+  guint size, min, max;
+  gboolean update_pool;
+
+  if (!gst_gl_shader_jpeg_dec_ensure_gl_context (self))
+    return FALSE;
+
+  gst_query_parse_allocation (query, &caps, NULL);
+  if (!caps || !gst_video_info_from_caps (&vinfo, caps))
+    return FALSE;
+
+  if (gst_query_get_n_allocation_pools (query) > 0) {
+    gst_query_parse_nth_allocation_pool (query, 0, &pool, &size, &min, &max);
+    update_pool = TRUE;
+  } else {
+    size = vinfo.size;
+    min = max = 0;
+    update_pool = FALSE;
+  }
+
+  /* the textures of the pool are what the passes render to, so they have to
+   * be of our context */
+  if (pool && (!GST_IS_GL_BUFFER_POOL (pool) ||
+          GST_GL_BUFFER_POOL (pool)->context != self->context))
+    gst_clear_object (&pool);
+  if (!pool)
+    pool = gst_gl_buffer_pool_new (self->context);
+
+  config = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (config, caps, size, min, max);
+  gst_buffer_pool_config_add_option (config, GST_BUFFER_POOL_OPTION_VIDEO_META);
+  if (gst_query_find_allocation_meta (query, GST_GL_SYNC_META_API_TYPE, NULL))
+    gst_buffer_pool_config_add_option (config,
+        GST_BUFFER_POOL_OPTION_GL_SYNC_META);
+  gst_buffer_pool_set_config (pool, config);
+
+  if (update_pool)
+    gst_query_set_nth_allocation_pool (query, 0, pool, size, min, max);
+  else
+    gst_query_add_allocation_pool (query, pool, size, min, max);
+
+  gst_object_unref (pool);
+
+  return GST_VIDEO_DECODER_CLASS (parent_class)->decide_allocation (decoder,
+      query);
+}
+
+static gboolean
+gst_gl_shader_jpeg_dec_negotiate_frame (GstGLShaderJpegDec * self,
+    const RFJpegFrame * frame)
+{
+  GstVideoDecoder *decoder = GST_VIDEO_DECODER (self);
+  GstVideoCodecState *state = gst_video_decoder_get_output_state (decoder);
+  GstVideoFormat format = GST_VIDEO_FORMAT_RGBA;
+  GstCaps *allowed;
+
+  if (state && state->info.width == frame->width &&
+      state->info.height == frame->height) {
+    gst_video_codec_state_unref (state);
+    return TRUE;
+  }
+  g_clear_pointer (&state, gst_video_codec_state_unref);
+
+  /* the first format downstream takes, RGBA if it doesn't care */
+  allowed = gst_pad_get_allowed_caps (GST_VIDEO_DECODER_SRC_PAD (decoder));
+  if (allowed && !gst_caps_is_empty (allowed)) {
+    const gchar *name;
+
+    allowed = gst_caps_fixate (allowed);
+    name = gst_structure_get_string (gst_caps_get_structure (allowed, 0),
+        "format");
+    if (name)
+      format = gst_video_format_from_string (name);
+  }
+  gst_clear_caps (&allowed);
+
+  if (format == GST_VIDEO_FORMAT_NV12) {
+    self->output = RF_GL_OUTPUT_NV12;
+  } else if (format == GST_VIDEO_FORMAT_I420) {
+    self->output = RF_GL_OUTPUT_I420;
+  } else {
+    format = GST_VIDEO_FORMAT_RGBA;
+    self->output = RF_GL_OUTPUT_RGB;
+  }
+
+  state = gst_video_decoder_set_output_state (decoder, format,
+      frame->width, frame->height, self->input_state);
+  if (self->output != RF_GL_OUTPUT_RGB) {
+    /* what JFIF has, and the chroma pass averages 2x2, so it's centered */
+    state->info.colorimetry.range = GST_VIDEO_COLOR_RANGE_0_255;
+    state->info.colorimetry.matrix = GST_VIDEO_COLOR_MATRIX_BT601;
+    state->info.chroma_site = GST_VIDEO_CHROMA_SITE_JPEG;
+  }
+  state->caps = gst_video_info_to_caps (&state->info);
+  gst_caps_set_features (state->caps, 0,
+      gst_caps_features_new_single (GST_CAPS_FEATURE_MEMORY_GL_MEMORY));
+  gst_caps_set_simple (state->caps, "texture-target", G_TYPE_STRING,
+      GST_GL_TEXTURE_TARGET_2D_STR, NULL);
+  gst_video_codec_state_unref (state);
+
+  return gst_video_decoder_negotiate (decoder);
+}
+
+/* Planes of the picture size, kept as long as the size doesn't change.
+ * FALSE if they can't be had, then there are none. */
+static gboolean
+gst_gl_shader_jpeg_dec_get_planes (GstGLShaderJpegDec * self,
+    RFJpegDecoder * jpeg, const RFJpegFrame * frame)
+{
+  if (self->plane_width != frame->plane_width ||
+      self->plane_height != frame->plane_height) {
+    for (int c = 0; c < 3 && self->plane_width; c++)
+      rf_plane_pool_release (self->pool, self->planes[c]);
+    self->plane_width = self->plane_height = 0;
+
+    for (int c = 0; c < 3; c++) {
+      self->planes[c] = rf_plane_pool_acquire (self->pool, frame->plane_width,
+          frame->plane_height);
+      if (!self->planes[c]) {
+        while (c--)
+          rf_plane_pool_release (self->pool, self->planes[c]);
+        return FALSE;
+      }
+    }
+    self->plane_width = frame->plane_width;
+    self->plane_height = frame->plane_height;
+  }
+
+  for (int c = 0; c < 3; c++) {
+    rf_jpeg_decoder_get_plane (jpeg, c, self->planes[c]);
+    rf_jpeg_decoder_get_table (jpeg, c, self->tables[c]);
+  }
+
+  return TRUE;
+}
+
+static void
+gst_gl_shader_jpeg_dec_gl_decode (GstGLContext * context, gpointer data)
+{
+  GstGLShaderJpegDec *self = data;
+  const float *tables[3] = { self->tables[0], self->tables[1],
+    self->tables[2]
+  };
+
+  if (self->gl_ready && (self->gl.width != self->plane_width ||
+          self->gl.height != self->plane_height)) {
+    rf_gl_decoder_clear (&self->gl);
+    self->gl_ready = FALSE;
+  }
+
+  if (!self->gl_ready) {
+    /* the reason is on stderr, handle_frame () posts the error */
+    self->gl_failed = rf_gl_decoder_init (&self->gl, self->plane_width,
+        self->plane_height, GL_R16F, NULL) != 0;
+    if (self->gl_failed)
+      return;
+    self->gl_ready = TRUE;
+  }
+
+  rf_gl_decoder_set_tables (&self->gl, tables);
+  for (int c = 0; c < 3; c++)
+    rf_gl_decoder_upload (&self->gl, c, self->planes[c]);
+
+  if (self->output == RF_GL_OUTPUT_RGB)
+    rf_gl_decoder_run_to_texture (&self->gl, self->out_tex[0]);
+  else
+    rf_gl_decoder_run_yuv (&self->gl, self->output, self->out_tex);
+}
+
+/* J:a:b of the chroma against the luma, the factors if it's none of those */
+static gchar *
+gst_gl_shader_jpeg_dec_sampling_name (const RFJpegFrame * frame)
+{
+  static const struct
+  {
+    int h, v;
+    const gchar *name;
+  } names[] = {
+    {2, 2, "4:2:0"}, {2, 1, "4:2:2"}, {1, 2, "4:4:0"}, {4, 1, "4:1:1"},
+  };
+
+  if (frame->h[1] == frame->h[2] && frame->v[1] == frame->v[2] &&
+      frame->h[0] % frame->h[1] == 0 && frame->v[0] % frame->v[1] == 0) {
+    for (guint i = 0; i < G_N_ELEMENTS (names); i++) {
+      if (frame->h[0] / frame->h[1] == names[i].h &&
+          frame->v[0] / frame->v[1] == names[i].v)
+        return g_strdup_printf ("%s subsampled", names[i].name);
+    }
+  }
+
+  return g_strdup_printf ("%dx%d,%dx%d,%dx%d sampled", frame->h[0],
+      frame->v[0], frame->h[1], frame->v[1], frame->h[2], frame->v[2]);
+}
+
+static GstFlowReturn
+gst_gl_shader_jpeg_dec_handle_frame (GstVideoDecoder * decoder,
+    GstVideoCodecFrame * frame)
+{
+  GstGLShaderJpegDec *self = GST_GL_SHADER_JPEG_DEC (decoder);
+  const RFJpegFrame *info;
+  RFJpegDecoder *jpeg;
+  RFJpegStatus status;
+  GstMapInfo map;
+  GstGLSyncMeta *sync_meta;
+  GstVideoCodecState *state;
+  GstVideoFrame out_frame;
+  gboolean mapped;
+  GstFlowReturn ret;
+  int updated;
+
+  if (!gst_buffer_map (frame->input_buffer, &map, GST_MAP_READ)) {
+    gst_video_decoder_drop_frame (decoder, frame);
+    return GST_FLOW_ERROR;
+  }
+
+  /* every buffer is a whole picture, all the scans go at once */
+  jpeg = rf_jpeg_decoder_new ();
+  if (!jpeg || rf_jpeg_decoder_push (jpeg, map.data, map.size)) {
+    gst_buffer_unmap (frame->input_buffer, &map);
+    if (jpeg)
+      rf_jpeg_decoder_free (jpeg);
+    GST_ELEMENT_ERROR (self, RESOURCE, NO_SPACE_LEFT,
+        ("Can't take a JPEG of %" G_GSIZE_FORMAT " bytes", map.size), (NULL));
+    gst_video_decoder_drop_frame (decoder, frame);
+    return GST_FLOW_ERROR;
+  }
+  while ((status = rf_jpeg_decoder_decode (jpeg, &updated)) ==
+      RF_JPEG_HEADER || status == RF_JPEG_SCAN);
+  gst_buffer_unmap (frame->input_buffer, &map);
+
+  /* missing EOI is fine, as long as there's something to show */
+  info = rf_jpeg_decoder_frame (jpeg);
+  if (status == RF_JPEG_UNSUPPORTED) {
+    gchar *sampling = gst_gl_shader_jpeg_dec_sampling_name (info);
+
+    GST_ELEMENT_ERROR (self, STREAM, NOT_IMPLEMENTED,
+        ("%s JPEG is not supported, only 4:4:4 and grayscale", sampling),
+        (NULL));
+    g_free (sampling);
+    rf_jpeg_decoder_free (jpeg);
+    gst_video_decoder_drop_frame (decoder, frame);
+    return GST_FLOW_ERROR;
+  }
+  if (status == RF_JPEG_ERROR || !info) {
+    rf_jpeg_decoder_free (jpeg);
+    ret = GST_FLOW_OK;
+    GST_VIDEO_DECODER_ERROR (decoder, 1, STREAM, DECODE, (NULL),
+        ("Broken JPEG"), ret);
+    gst_video_decoder_drop_frame (decoder, frame);
+    return ret;
+  }
+
+  if (!gst_gl_shader_jpeg_dec_negotiate_frame (self, info)) {
+    rf_jpeg_decoder_free (jpeg);
+    gst_video_decoder_drop_frame (decoder, frame);
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+
+  if (!gst_gl_shader_jpeg_dec_get_planes (self, jpeg, info)) {
+    GST_ELEMENT_ERROR (self, RESOURCE, NO_SPACE_LEFT,
+        ("Can't allocate the planes of %dx%d", info->plane_width,
+            info->plane_height), (NULL));
+    rf_jpeg_decoder_free (jpeg);
+    gst_video_decoder_drop_frame (decoder, frame);
+    return GST_FLOW_ERROR;
+  }
+  rf_jpeg_decoder_free (jpeg);
+
+  ret = gst_video_decoder_allocate_output_frame (decoder, frame);
+  if (ret != GST_FLOW_OK) {
+    gst_video_decoder_drop_frame (decoder, frame);
+    return ret;
+  }
+
+  /* a GL map gives the texture ids, and marks the memory as written on the
+   * GPU side, so a later download doesn't take stale system memory */
+  state = gst_video_decoder_get_output_state (decoder);
+  mapped = gst_video_frame_map (&out_frame, &state->info, frame->output_buffer,
+      GST_MAP_WRITE | GST_MAP_GL);
+  gst_video_codec_state_unref (state);
+  if (!mapped) {
+    GST_ELEMENT_ERROR (self, RESOURCE, WRITE,
+        ("Can't map the output buffer for GL"), (NULL));
+    gst_video_decoder_drop_frame (decoder, frame);
+    return GST_FLOW_ERROR;
+  }
+
+  for (guint i = 0; i < GST_VIDEO_FRAME_N_PLANES (&out_frame) && i < 3; i++)
+    self->out_tex[i] = *(guint *) out_frame.data[i];
+  gst_gl_context_thread_add (self->context, gst_gl_shader_jpeg_dec_gl_decode,
+      self);
+  gst_video_frame_unmap (&out_frame);
+  if (self->gl_failed) {
+    GST_ELEMENT_ERROR (self, RESOURCE, FAILED,
+        ("Can't set up the GL passes for %dx%d", self->plane_width,
+            self->plane_height), (NULL));
+    gst_video_decoder_drop_frame (decoder, frame);
+    return GST_FLOW_ERROR;
+  }
+
+  /* downstream waits for the passes on its side, not us */
+  sync_meta = gst_buffer_get_gl_sync_meta (frame->output_buffer);
+  if (sync_meta)
+    gst_gl_sync_meta_set_sync_point (sync_meta, self->context);
+
+  return gst_video_decoder_finish_frame (decoder, frame);
+}
+
+static void
+gst_gl_shader_jpeg_dec_class_init (GstGLShaderJpegDecClass * klass)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstVideoDecoderClass *decoder_class = GST_VIDEO_DECODER_CLASS (klass);
+
+  element_class->set_context =
+      GST_DEBUG_FUNCPTR (gst_gl_shader_jpeg_dec_set_context);
+
+  decoder_class->start = GST_DEBUG_FUNCPTR (gst_gl_shader_jpeg_dec_start);
+  decoder_class->stop = GST_DEBUG_FUNCPTR (gst_gl_shader_jpeg_dec_stop);
+  decoder_class->set_format =
+      GST_DEBUG_FUNCPTR (gst_gl_shader_jpeg_dec_set_format);
+  decoder_class->src_query =
+      GST_DEBUG_FUNCPTR (gst_gl_shader_jpeg_dec_src_query);
+  decoder_class->decide_allocation =
+      GST_DEBUG_FUNCPTR (gst_gl_shader_jpeg_dec_decide_allocation);
+  decoder_class->handle_frame =
+      GST_DEBUG_FUNCPTR (gst_gl_shader_jpeg_dec_handle_frame);
+
+  gst_element_class_add_static_pad_template (element_class, &sink_template);
+  gst_element_class_add_static_pad_template (element_class, &src_template);
+
+  gst_element_class_set_static_metadata (element_class,
+      "GL shader JPEG decoder", "Codec/Decoder/Video/Hardware",
+      "Decodes JPEG to GL memory with the IDCT in fragment shaders",
+      "Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>");
+
+  GST_DEBUG_CATEGORY_INIT (gst_gl_shader_jpeg_dec_debug, "glshaderjpegdec", 0,
+      "GL shader JPEG decoder");
+}
+
+static void
+gst_gl_shader_jpeg_dec_init (GstGLShaderJpegDec * self)
+{
+  GstVideoDecoder *decoder = GST_VIDEO_DECODER (self);
+
+  gst_video_decoder_set_packetized (decoder, TRUE);
+  gst_video_decoder_set_needs_format (decoder, TRUE);
+}
+
+static gboolean
+plugin_init (GstPlugin * plugin)
+{
+  return gst_element_register (plugin, "glshaderjpegdec", GST_RANK_NONE,
+      GST_TYPE_GL_SHADER_JPEG_DEC);
+}
+
+GST_PLUGIN_DEFINE (GST_VERSION_MAJOR, GST_VERSION_MINOR, glshaderjpegdec,
+    "JPEG decoder in GL shaders", plugin_init, VERSION, "LGPL", PACKAGE,
+    GST_PACKAGE_ORIGIN)
@@ -0,0 +1,19 @@
+/*
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ */
+
+#ifndef __GST_GL_SHADER_JPEG_DEC_H__
+#define __GST_GL_SHADER_JPEG_DEC_H__
+
+#include <gst/gst.h>
+#include <gst/video/video.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_GL_SHADER_JPEG_DEC (gst_gl_shader_jpeg_dec_get_type ())
+G_DECLARE_FINAL_TYPE (GstGLShaderJpegDec, gst_gl_shader_jpeg_dec,
+    GST, GL_SHADER_JPEG_DEC, GstVideoDecoder)
+
+G_END_DECLS
+
+#endif
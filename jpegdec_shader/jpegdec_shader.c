@@ -0,0 +1,1477 @@
+/*
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ */
+
+// Compile with: gcc jpegdec_shader.c rf_gl.c rf_entropy.c rf_validate.c rf_jpeg_decoder.c rf_plane_pool.c -lglfw -lGL -lGLEW -lm -lpthread -o jpegdec_shader
+// Check the GPU against the CPU, e.g. on CI with no GPU (that's meson test):
+//   LIBGL_ALWAYS_SOFTWARE=1 xvfb-run ./jpegdec_shader --validate [--dequant-format r32f]
+//     [--output nv12|i420]
+// Watch a progressive file come in over a slow link:
+//   ./jpegdec_shader --jpeg-in progressive.jpg --trickle 4096
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "rf_entropy.h"
+#include "rf_gl.h"
+#include "rf_jpeg_decoder.h"
+#include "rf_plane_pool.h"
+#include "rf_validate.h"
+
+/* The encoder mirrors the decoder: first pass converts RGB to YUV and does the
+ * forward DCT of the 3 planes at once, so the 64 fetches of a block are shared
+ * between Y, U and V. Output goes to 3 render targets, laid out the same way
+ * dct_image () does it: [8x8] blocks as 64 consecutive texels. */
+static const char * fragmentRGBtoDCT =
+    "#version 300 es\n"
+    "precision highp float;\n"
+    "precision highp int;\n"
+    "layout (location = 0) out vec4 dctOutY;\n"
+    "layout (location = 1) out vec4 dctOutU;\n"
+    "layout (location = 2) out vec4 dctOutV;\n"
+    "uniform sampler2D rgbInp;\n"
+    "const float M_PI = 3.14159265358979323846;\n"
+    // inverse of yuv_to_rgb () of the decoder
+    "vec3 rgb_to_yuv (vec3 c)\n"
+    "{\n"
+    "  float y = 0.299 * c.r + 0.587 * c.g + 0.114 * c.b;\n"
+    "  return vec3(y, (c.b - y) / 1.772 + 0.5, (c.r - y) / 1.402 + 0.5);\n"
+    "}\n"
+    "void main() {\n"
+    "  ivec2 outPixel = ivec2(gl_FragCoord.xy);\n"
+    "  int width = textureSize (rgbInp, 0).x;\n"
+    // blocks per line of the picture and of the output
+    "  int ibpl = width / 8;\n"
+    "  int obpl = width / 64;\n"
+    // k is the coefficient within the block, gbi is the global block index
+    "  int k = outPixel.x % 64;\n"
+    "  int gbi = (outPixel.x / 64) + outPixel.y * obpl;\n"
+    "  ivec2 blk = ivec2(gbi % ibpl, gbi / ibpl) * 8;\n"
+    "  int u = k % 8;\n"
+    "  int v = k / 8;\n"
+    "  vec3 sum = vec3(0.0);\n"
+    "  for (int y = 0; y < 8; y++) {\n"
+    "    float cy = cos((M_PI * (2.0 * float(y) + 1.0) * float(v)) / 16.0);\n"
+    "    for (int x = 0; x < 8; x++) {\n"
+    "      vec3 rgb = texelFetch(rgbInp, blk + ivec2(x, y), 0).rgb;\n"
+    "      sum += rgb_to_yuv (rgb) * cy *\n"
+    "          cos((M_PI * (2.0 * float(x) + 1.0) * float(u)) / 16.0);\n"
+    "    }\n"
+    "  }\n"
+    "  float cu = (u == 0) ? (1.0 / sqrt(2.0)) : 1.0;\n"
+    "  float cv = (v == 0) ? (1.0 / sqrt(2.0)) : 1.0;\n"
+    "  sum *= 0.25 * cu * cv;\n"
+    "  dctOutY = vec4(sum.x, 0.0, 0.0, 1.0);\n"
+    "  dctOutU = vec4(sum.y, 0.0, 0.0, 1.0);\n"
+    "  dctOutV = vec4(sum.z, 0.0, 0.0, 1.0);\n"
+    "}\n";
+
+/* Second pass of the encoder: quant_block () + zigzag_block () in one go,
+ * the opposite of zigzagToDCT. */
+static const char * DCTtoZigzag =
+    "#version 300 es\n"
+    "precision highp float;\n"
+    "precision highp int;\n"
+    "out vec4 fragColor;\n"
+    "uniform sampler2D dctInpP;\n"
+    "uniform float qTable[64];\n"
+    // same table as the CPU one
+    "const int zigzag8x8[64] = int[64](\n"
+    "0,  1,  8, 16,  9,  2,  3, 10,\n"
+    "17, 24, 32, 25, 18, 11,  4,  5,\n"
+    "12, 19, 26, 33, 40, 48, 41, 34,\n"
+    "27, 20, 13,  6,  7, 14, 21, 28,\n"
+    "35, 42, 49, 56, 57, 50, 43, 36,\n"
+    "29, 22, 15, 23, 30, 37, 44, 51,\n"
+    "58, 59, 52, 45, 38, 31, 39, 46,\n"
+    "53, 60, 61, 54, 47, 55, 62, 63\n"
+    ");\n"
+    "void main() {\n"
+    "  ivec2 outPixel = ivec2(gl_FragCoord.xy);\n"
+    "  int zzj = outPixel.x % 64;\n"
+    "  int nat = zigzag8x8[zzj];\n"
+    "  float pixel = texelFetch(dctInpP,\n"
+    "      ivec2(outPixel.x - zzj + nat, outPixel.y), 0).r;\n"
+    // to the JPEG range, the same as quant_block ()
+    "  pixel = pixel * 255.0;\n"
+    "  if (nat == 0)\n"
+    "    pixel -= 1024.0;\n"
+    "  pixel /= qTable[nat];\n"
+    // roundf (): halfway cases away from zero
+    "  pixel = sign(pixel) * floor(abs(pixel) + 0.5);\n"
+    "  fragColor = vec4(pixel, 0.0, 0.0, 1.0);\n"
+    "}\n";
+
+/* Shows the YUV outputs, 4:2:0 and full range. NV12 has U and V both in
+ * uvTex and takes V from .g, I420 has them in the .r of their own planes. */
+#define YUV420_TO_SCREEN(v_channel)                                     \
+    "#version 300 es\n"                                                 \
+    "precision highp float;\n"                                          \
+    "in vec2 texCoord;\n"                                               \
+    "out vec4 fragColor;\n"                                             \
+    "uniform sampler2D yTex;\n"                                         \
+    "uniform sampler2D uTex;\n"                                         \
+    "uniform sampler2D vTex;\n"                                         \
+    "void main() {\n"                                                   \
+    "  float y = texture(yTex, texCoord).r;\n"                          \
+    "  float u = texture(uTex, texCoord).r - 0.5;\n"                    \
+    "  float v = texture(vTex, texCoord)." v_channel " - 0.5;\n"        \
+    "  fragColor = vec4(y + 1.402 * v, y - 0.344136 * u - 0.714136 * v,\n" \
+    "      y + 1.772 * u, 1.0);\n"                                      \
+    "}\n"
+
+static const char * fragmentNV12toScreen = YUV420_TO_SCREEN ("g");
+static const char * fragmentI420toScreen = YUV420_TO_SCREEN ("r");
+
+typedef struct
+{
+  void *Y;
+  void *U;
+  void *V;
+  int width;
+  int height;
+} RFYUVData;
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define BLOCK_SIZE 8
+
+const float losslessQuant[64] = {
+  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,
+  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,
+  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,
+  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,
+  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,
+  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,
+  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,
+  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0
+};
+
+/* Annex K.1, luminance, quality 50 */
+const float stdQuant[64] = {
+  16,  11,  10,  16,  24,  40,  51,  61,
+  12,  12,  14,  19,  26,  58,  60,  55,
+  14,  13,  16,  24,  40,  57,  69,  56,
+  14,  17,  22,  29,  51,  87,  80,  62,
+  18,  22,  37,  56,  68, 109, 103,  77,
+  24,  35,  55,  64,  81, 104, 113,  92,
+  49,  64,  78,  87, 103, 121, 120, 101,
+  72,  92,  95,  98, 112, 100, 103,  99
+};
+
+/* The one of the JPEG: natural position of each coefficient in the zigzag
+ * order */
+const int zigzag8x8[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63
+};
+
+void unzigzag_block(const float in[64], float out[64]) {
+    for (int i = 0; i < 64; i++) {
+        out[zigzag8x8[i]] = in[i];
+    }
+}
+
+void zigzag_block(const float in[64], float out[64]) {
+    for (int i = 0; i < 64; i++) {
+        out[i] = in[zigzag8x8[i]];
+    }
+}
+
+void unzigzag_image(const float *input, float *output, int width, int height) {
+  int numBlocks = width * height / (8*8);
+  for (int block = 0; block < numBlocks; block++) {
+    unzigzag_block(&input[block * 64], &output[block * 64]);
+  }
+}
+
+void zigzag_image(const float *input, float *output, int width, int height) {
+  int numBlocks = width * height / (8*8);
+  for (int block = 0; block < numBlocks; block++) {
+    zigzag_block(&input[block * 64], &output[block * 64]);
+  }
+}
+
+/* Scales to what JPEG would have for the 0..255 samples shifted by -128,
+ * the shift only touches DC: 128 * 8 */
+void quant_block(const float table[64], const float in[64], float out[64]) {
+    out[0] = roundf((in[0] * 255.0f - 1024.0f) / table[0]);
+    for (int i = 1; i < 64; i++) {
+      out[i] = roundf(in[i] * 255.0f / table[i]);
+    }
+}
+
+/* quant_block () backwards, what zigzagToDCT does */
+void dequant_block(const float table[64], const float in[64], float out[64]) {
+    out[0] = (in[0] * table[0] + 1024.0f) / 255.0f;
+    for (int i = 1; i < 64; i++) {
+      out[i] = in[i] * table[i] / 255.0f;
+    }
+}
+
+void dequant_image(const float table[64],
+    const float *input, float *output, int width, int height) {
+  int numBlocks = width * height / (8*8);
+  for (int block = 0; block < numBlocks; block++) {
+    dequant_block(table, &input[block * 64], &output[block * 64]);
+  }
+}
+
+void quant_image(const float table[64],
+    const float *input, float *output, int width, int height) {
+  int numBlocks = width * height / (8*8);
+  for (int block = 0; block < numBlocks; block++) {
+    quant_block(table, &input[block * 64], &output[block * 64]);
+  }
+}
+
+void dct8x8_block(const float *input, float *output, int stride) {
+    for (int u = 0; u < BLOCK_SIZE; u++) {
+        for (int v = 0; v < BLOCK_SIZE; v++) {
+            float sum = 0.0f;
+            for (int x = 0; x < BLOCK_SIZE; x++) {
+                for (int y = 0; y < BLOCK_SIZE; y++) {
+                    float pixel = input[y * stride + x];
+                    sum += pixel *
+                        cosf(((2 * x + 1) * u * M_PI) / 16.0f) *
+                        cosf(((2 * y + 1) * v * M_PI) / 16.0f);
+                }
+            }
+
+            // Scaling factors for the DC component
+            float cu = (u == 0) ? 1.0f / sqrtf(2.0f) : 1.0f;
+            float cv = (v == 0) ? 1.0f / sqrtf(2.0f) : 1.0f;
+
+            // Apply normalization factor
+            output[v * 8 + u] = 0.25f * cu * cv * sum;
+        }
+    }
+}
+
+void dct_image(const float *input, float *output, int width, int height) {
+  int p = 0;
+  for (int by = 0; by < height; by += 8) {
+    for (int bx = 0; bx < width; bx += 8) {
+      const float *block_in = &input[by * width + bx];
+      float *block_out = &output[p];
+      /* so we read the input respecting the strides, but write an output as
+       * a sequence of [8x8] chunks. */
+      dct8x8_block(block_in, block_out, width);
+
+      p += 64;
+    }
+  }
+}
+
+
+/* Same as apply_idct_for_* () of the fragmentIDCTtoRGB */
+float apply_idct_for_pixel(const float input[8][8], int x, int y) {
+  float result = 0.0f;
+
+  for (int yk = 0; yk < BLOCK_SIZE; yk++) {
+    for (int xk = 0; xk < BLOCK_SIZE; xk++) {
+      float ck = (xk == 0) ? 1.0f / sqrtf(2.0f) : 1.0f;
+      float cl = (yk == 0) ? 1.0f / sqrtf(2.0f) : 1.0f;
+
+      result += ck * cl * input[yk][xk] *
+          cosf(((2 * x + 1) * xk * M_PI) / 16.0f) *
+          cosf(((2 * y + 1) * yk * M_PI) / 16.0f);
+    }
+  }
+
+  return result * 0.25f;
+}
+
+void idct8x8_block(const float *input, float *output, int stride) {
+    for (int y = 0; y < BLOCK_SIZE; y++) {
+        for (int x = 0; x < BLOCK_SIZE; x++) {
+            output[y * stride + x] = apply_idct_for_pixel((const float (*)[8])input, x, y);
+        }
+    }
+}
+
+void idct_image(const float *input, float *output, int width, int height) {
+  // Actuall input is the plane [8x8][8x8][8x8] sequence (and that's ok)
+
+  int p = 0;
+  for (int by = 0; by < height; by += 8) {
+    for (int bx = 0; bx < width; bx += 8) {
+      const float *block_in = &input[p];
+      float *block_out = &output[by * width + bx];
+    
+      idct8x8_block (block_in, block_out, width);
+      p += 64;
+    }
+  }
+}
+
+void rf_yuv_data_release (RFPlanePool *pool, RFYUVData *data)
+{
+  rf_plane_pool_release (pool, data->Y);
+  rf_plane_pool_release (pool, data->U);
+  rf_plane_pool_release (pool, data->V);
+}
+
+/* Planes of the size for the CPU stages below, from the pool */
+int rf_yuv_data_acquire (RFPlanePool *pool, int width, int height,
+    RFYUVData *out)
+{
+  out->Y = rf_plane_pool_acquire (pool, width, height);
+  out->U = rf_plane_pool_acquire (pool, width, height);
+  out->V = rf_plane_pool_acquire (pool, width, height);
+  out->width = width;
+  out->height = height;
+
+  if (!out->Y || !out->U || !out->V) {
+    /* or the ones we got would stay in use */
+    rf_yuv_data_release (pool, out);
+    out->Y = out->U = out->V = NULL;
+    fprintf (stderr, "Can't allocate %dx%d planes\n", width, height);
+    return -1;
+  }
+
+  return 0;
+}
+
+/* The CPU stages write to @out, that has to be of the @in size and not @in
+ * itself. They keep no state, so many can go at once. */
+void rf_dct_that_thing (const RFYUVData * float_pixels, RFYUVData * out)
+{
+  int w = float_pixels->width, h = float_pixels->height;
+
+  dct_image ((float*)float_pixels->Y, (float*)out->Y, w, h);
+  dct_image ((float*)float_pixels->U, (float*)out->U, w, h);
+  dct_image ((float*)float_pixels->V, (float*)out->V, w, h);
+}
+
+void rf_quant_that_thing (const float table[64],
+    const RFYUVData * float_pixels, RFYUVData * out)
+{
+  int w = float_pixels->width, h = float_pixels->height;
+
+  quant_image (table, (float*)float_pixels->Y, (float*)out->Y, w, h);
+  quant_image (table, (float*)float_pixels->U, (float*)out->U, w, h);
+  quant_image (table, (float*)float_pixels->V, (float*)out->V, w, h);
+}
+
+void rf_zigzag_that_thing (const RFYUVData * float_pixels, RFYUVData * out)
+{
+  int w = float_pixels->width, h = float_pixels->height;
+
+  zigzag_image ((float*)float_pixels->Y, (float*)out->Y, w, h);
+  zigzag_image ((float*)float_pixels->U, (float*)out->U, w, h);
+  zigzag_image ((float*)float_pixels->V, (float*)out->V, w, h);
+}
+
+void rf_unzigzag_that_thing (const RFYUVData * float_pixels, RFYUVData * out)
+{
+  int w = float_pixels->width, h = float_pixels->height;
+
+  unzigzag_image ((float*)float_pixels->Y, (float*)out->Y, w, h);
+  unzigzag_image ((float*)float_pixels->U, (float*)out->U, w, h);
+  unzigzag_image ((float*)float_pixels->V, (float*)out->V, w, h);
+}
+
+void rf_dequant_that_thing (const float table[64],
+    const RFYUVData * float_pixels, RFYUVData * out)
+{
+  int w = float_pixels->width, h = float_pixels->height;
+
+  dequant_image (table, (float*)float_pixels->Y, (float*)out->Y, w, h);
+  dequant_image (table, (float*)float_pixels->U, (float*)out->U, w, h);
+  dequant_image (table, (float*)float_pixels->V, (float*)out->V, w, h);
+}
+
+void rf_idct_that_thing (const RFYUVData * float_dcts, RFYUVData * out)
+{
+  int w = float_dcts->width, h = float_dcts->height;
+
+  idct_image ((float*)float_dcts->Y, (float*)out->Y, w, h);
+  idct_image ((float*)float_dcts->U, (float*)out->U, w, h);
+  idct_image ((float*)float_dcts->V, (float*)out->V, w, h);
+}
+
+/* The CPU encoder for pictures that don't fit the memory: the rows come
+ * in 8 at a time and leave as coefficients right away, so only a few strips
+ * of the width are ever kept. */
+typedef void (*RFStripSink) (const RFYUVData *coeffs, void *user_data);
+
+typedef struct {
+  RFYUVData dct, quant, coeffs;
+  const float *table;
+  RFStripSink sink;
+  void *user_data;
+} RFStripEncoder;
+
+int rf_strip_encoder_init (RFStripEncoder *se, RFPlanePool *pool, int width,
+    const float table[64], RFStripSink sink, void *user_data)
+{
+  se->table = table;
+  se->sink = sink;
+  se->user_data = user_data;
+
+  if (rf_yuv_data_acquire (pool, width, 8, &se->dct))
+    return -1;
+  if (rf_yuv_data_acquire (pool, width, 8, &se->quant)) {
+    rf_yuv_data_release (pool, &se->dct);
+    return -1;
+  }
+  if (rf_yuv_data_acquire (pool, width, 8, &se->coeffs)) {
+    rf_yuv_data_release (pool, &se->dct);
+    rf_yuv_data_release (pool, &se->quant);
+    return -1;
+  }
+
+  return 0;
+}
+
+/* @strip is 8 rows of the picture, a row of [8x8] blocks is a picture of
+ * its own for the stages */
+void rf_strip_encoder_push (RFStripEncoder *se, const RFYUVData *strip)
+{
+  rf_dct_that_thing (strip, &se->dct);
+  rf_quant_that_thing (se->table, &se->dct, &se->quant);
+  rf_zigzag_that_thing (&se->quant, &se->coeffs);
+  se->sink (&se->coeffs, se->user_data);
+}
+
+void rf_strip_encoder_clear (RFStripEncoder *se, RFPlanePool *pool)
+{
+  rf_yuv_data_release (pool, &se->dct);
+  rf_yuv_data_release (pool, &se->quant);
+  rf_yuv_data_release (pool, &se->coeffs);
+}
+
+RFYUVData * generateYUVGradient() {
+
+#define WIDTH 512
+#define HEIGHT 512
+  
+  static float Y_DATA[WIDTH * HEIGHT];
+  static float U_DATA[WIDTH * HEIGHT];
+  static float V_DATA[WIDTH * HEIGHT];
+
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            int i = y * WIDTH + x;
+            Y_DATA[i] = (float)x*y / (WIDTH*HEIGHT);
+            U_DATA[i] = 200.0/255.0;
+            V_DATA[i] = 200.0/255.0;
+        }          
+    }
+
+    /* our funny malloc */
+    static RFYUVData ret;
+
+    ret.Y = Y_DATA;
+    ret.U = U_DATA;
+    ret.V = V_DATA;
+    ret.width = WIDTH;
+    ret.height = HEIGHT;
+    return &ret;
+}
+
+/* Rows [row, row + 8) of the generateYUVGradient () picture, stretched to
+ * @height rows, the way a line-scan camera would hand them out */
+void rf_yuv_gradient_strip (RFYUVData *strip, int row, int height)
+{
+  float *Y = strip->Y, *U = strip->U, *V = strip->V;
+  int width = strip->width;
+
+  for (int y = 0; y < 8; y++) {
+    for (int x = 0; x < width; x++) {
+      int i = y * width + x;
+      Y[i] = (float)x * (row + y) / ((float)width * height);
+      U[i] = 200.0/255.0;
+      V[i] = 200.0/255.0;
+    }
+  }
+}
+
+/* Interleaved RGB of the picture, that's what the GPU encoder takes */
+float * rf_yuv_to_rgb_image (RFYUVData * yuv)
+{
+  int n = yuv->width * yuv->height;
+  const float *Y = yuv->Y, *U = yuv->U, *V = yuv->V;
+  float *rgb = malloc (n * 3 * sizeof (float));
+
+  for (int i = 0; i < n; i++) {
+    float u = U[i] - 0.5f;
+    float v = V[i] - 0.5f;
+
+    rgb[i * 3 + 0] = Y[i] + 1.402f * v;
+    rgb[i * 3 + 1] = Y[i] - 0.344136f * u - 0.714136f * v;
+    rgb[i * 3 + 2] = Y[i] + 1.772f * u;
+  }
+
+  return rgb;
+}
+
+GLFWwindow* rf_create_window (int visible)
+{
+  if (!glfwInit())
+    return NULL;
+
+  /* for the runs without a screen, e.g. on a software rasterizer */
+  if (!visible)
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow* window = glfwCreateWindow(1024, 1024, "JPEG Decoder Shader", NULL, NULL);
+  if (!window) {
+    glfwTerminate();
+    return NULL;
+  }
+  glfwMakeContextCurrent(window);
+  glewInit();
+
+  printf ("GL: %s\n", glGetString(GL_VERSION));
+  return window;
+}
+
+/* Asynchronous readback of the 3 planes: glReadPixels goes to the PBOs and
+ * returns at once, rf_readback_map () only blocks if asked to. */
+typedef struct {
+  GLuint pbo[3];
+  GLsync fence;
+  int width, height;
+} RFReadback;
+
+void rf_readback_init (RFReadback *rb, int width, int height)
+{
+  int psize = width * height * sizeof (float);
+
+  glGenBuffers(3, rb->pbo);
+  for (int i = 0; i < 3; i++) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, rb->pbo[i]);
+    glBufferData(GL_PIXEL_PACK_BUFFER, psize, NULL, GL_STREAM_READ);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  rb->fence = 0;
+  rb->width = width;
+  rb->height = height;
+}
+
+void rf_readback_start (RFReadback *rb, RFFb planes[3])
+{
+  for (int i = 0; i < 3; i++) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, planes[i].framebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, rb->pbo[i]);
+    glReadPixels(0, 0, rb->width, rb->height, GL_RED, GL_FLOAT, 0);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+  if (rb->fence)
+    glDeleteSync(rb->fence);
+  rb->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+/* Returns 0 if there is nothing to map yet. On success the planes stay
+ * mapped to @out until rf_readback_unmap (). */
+int rf_readback_map (RFReadback *rb, RFYUVData *out, int wait)
+{
+  void **planes[3] = { &out->Y, &out->U, &out->V };
+  int psize = rb->width * rb->height * sizeof (float);
+  GLenum status;
+
+  if (!rb->fence)
+    return 0;
+
+  status = glClientWaitSync(rb->fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+      wait ? 1000000000 : 0);
+  if (status == GL_TIMEOUT_EXPIRED || status == GL_WAIT_FAILED)
+    return 0;
+
+  glDeleteSync(rb->fence);
+  rb->fence = 0;
+
+  for (int i = 0; i < 3; i++) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, rb->pbo[i]);
+    *planes[i] = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, psize,
+        GL_MAP_READ_BIT);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  out->width = rb->width;
+  out->height = rb->height;
+  return 1;
+}
+
+void rf_readback_unmap (RFReadback *rb)
+{
+  for (int i = 0; i < 3; i++) {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, rb->pbo[i]);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+/* GPU version of rf_zigzag_that_thing (rf_quant_that_thing (rf_dct_that_thing ())),
+ * but from RGB. Output planes are ready to be used as zigzagInpP. */
+typedef struct {
+  GLuint rgb_to_dct;
+  GLuint quant[3];
+  RFUniform rgb_to_dct_unis[2];
+  RFUniform quant_unis[3][3];
+  GLuint dct[3];
+  RFFb dct_output;
+  RFFb zigzag_output[3];
+  int width, height;
+} RFEncoder;
+
+int rf_encoder_init (RFEncoder *enc, GLuint rgb, const float table[64],
+    int width, int height)
+{
+  enc->width = width;
+  enc->height = height;
+
+  enc->dct_output = rf_make_framebuffer_mrt (GL_R32F, width, height, enc->dct, 3);
+
+  enc->rgb_to_dct_unis[0] = (RFUniform) { "rgbInp", rgb, 1 };
+  enc->rgb_to_dct_unis[1] = (RFUniform) { NULL };
+  enc->rgb_to_dct = rf_create_shader_program (vertexPassThrough,
+      fragmentRGBtoDCT, enc->rgb_to_dct_unis);
+
+  for (int i = 0; i < 3; i++) {
+    enc->quant_unis[i][0] = (RFUniform) { "dctInpP", enc->dct[i], 1 };
+    enc->quant_unis[i][1] = (RFUniform) { "qTable", (uint64_t)table, 64 };
+    enc->quant_unis[i][2] = (RFUniform) { NULL };
+    enc->quant[i] = rf_create_shader_program (vertexPassThrough,
+        DCTtoZigzag, enc->quant_unis[i]);
+    enc->zigzag_output[i] = rf_make_framebuffer (GL_R32F, width, height);
+    if (!enc->quant[i] || !enc->zigzag_output[i].framebuffer)
+      return -1;
+  }
+
+  return enc->dct_output.framebuffer && enc->rgb_to_dct ? 0 : -1;
+}
+
+void rf_encode (RFEncoder *enc, GLuint vao)
+{
+  glViewport(0, 0, enc->width, enc->height);
+
+  /* rgb --> dct Y, U, V */
+  glBindFramebuffer(GL_FRAMEBUFFER, enc->dct_output.framebuffer);
+  rf_use_shader_program (GL_TEXTURE_2D, enc->rgb_to_dct, enc->rgb_to_dct_unis);
+  rf_draw_to_target_buffer (vao);
+
+  /* dct --> zigzag, for each plane */
+  for (int i = 0; i < 3; i++) {
+    glBindFramebuffer(GL_FRAMEBUFFER, enc->zigzag_output[i].framebuffer);
+    rf_use_shader_program (GL_TEXTURE_2D, enc->quant[i], enc->quant_unis[i]);
+    rf_draw_to_target_buffer (vao);
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+float rf_planes_max_diff (RFYUVData *a, RFYUVData *b)
+{
+  const float *pa[3] = { a->Y, a->U, a->V };
+  const float *pb[3] = { b->Y, b->U, b->V };
+  float ret = 0;
+
+  for (int p = 0; p < 3; p++) {
+    for (int i = 0; i < a->width * a->height; i++) {
+      float d = fabsf (pa[p][i] - pb[p][i]);
+      if (d > ret)
+        ret = d;
+    }
+  }
+
+  return ret;
+}
+
+/* Whole plane at once. R16F comes back as half floats and is converted in
+ * bulk, nothing is converted on the GPU side. */
+float * rf_read_plane (GLuint framebuffer, GLenum format, int width, int height)
+{
+  size_t n = (size_t) width * height;
+  float *ret = malloc (n * sizeof (float));
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+  if (format == GL_R16F) {
+    uint16_t *half = malloc (n * sizeof (uint16_t));
+
+    glReadPixels(0, 0, width, height, GL_RED, GL_HALF_FLOAT, half);
+    rf_half_to_float_n (half, ret, n);
+    free (half);
+  } else {
+    glReadPixels(0, 0, width, height, GL_RED, GL_FLOAT, ret);
+  }
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+  return ret;
+}
+
+/* 8 bit targets (GL_RGB, GL_RG or GL_RED), as 0..255 floats */
+float * rf_read_u8 (GLuint framebuffer, GLenum format, int channels,
+    int width, int height)
+{
+  size_t n = (size_t) width * height * channels;
+  uint8_t *pixels = malloc (n);
+  float *ret = malloc (n * sizeof (float));
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, width, height, format, GL_UNSIGNED_BYTE, pixels);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+  for (size_t i = 0; i < n; i++)
+    ret[i] = pixels[i];
+
+  free (pixels);
+  return ret;
+}
+
+/* What the chroma pass of the 4:2:0 outputs should give: the mean of 2x2,
+ * clamped like the UNORM target does. @stride apart, so NV12 can have U and
+ * V interleaved. */
+static void rf_downsample_420 (const float *in, int width, int height,
+    float *out, int stride)
+{
+  for (int y = 0; y < height / 2; y++) {
+    for (int x = 0; x < width / 2; x++) {
+      const float *p = in + (2 * y) * width + 2 * x;
+      float mean = (p[0] + p[1] + p[width] + p[width + 1]) * 0.25f;
+
+      out[(y * (width / 2) + x) * stride] =
+          fminf (fmaxf (mean, 0.0f), 1.0f) * 255.0f;
+    }
+  }
+}
+
+#define RF_VALIDATE_FRAMES 10
+
+typedef struct {
+  const char *name;
+  const float *ref;
+  float *test;
+  size_t n;
+  double min_psnr;
+} RFStage;
+
+/* Checks every stage that stays on the GPU against the CPU pipeline doing
+ * the same thing. Returns the number of stages below their PSNR.
+ * @out is the RGB target, or the planes of the YUV @output. */
+int rf_validate (RFPlanePool *pool, RFYUVData *cpu_data,
+    const float table[64], RFEncoder *enc, RFFb dequant[3],
+    GLenum dequant_format, RFGLOutput output, const RFFb out[3])
+{
+  static const char *enc_names[3] = { "encoder Y", "encoder U", "encoder V" };
+  static const char *deq_names[3] = { "dequant Y", "dequant U", "dequant V" };
+  int w = cpu_data->width, h = cpu_data->height;
+  size_t n = (size_t) w * h;
+  RFStage stages[9];
+  int nstages = 0, failed = 0;
+
+  RFYUVData unzigzagged, ref_dequant, ref_yuv;
+
+  if (rf_yuv_data_acquire (pool, w, h, &unzigzagged))
+    return 1;
+  if (rf_yuv_data_acquire (pool, w, h, &ref_dequant)) {
+    rf_yuv_data_release (pool, &unzigzagged);
+    return 1;
+  }
+  rf_unzigzag_that_thing (cpu_data, &unzigzagged);
+  rf_dequant_that_thing (table, &unzigzagged, &ref_dequant);
+  rf_yuv_data_release (pool, &unzigzagged);
+
+  const float *ref_coeffs[3] = { cpu_data->Y, cpu_data->U, cpu_data->V };
+  const float *ref_planes[3] = { ref_dequant.Y, ref_dequant.U, ref_dequant.V };
+
+  /* what the 8 bit targets would store */
+  if (rf_yuv_data_acquire (pool, w, h, &ref_yuv)) {
+    rf_yuv_data_release (pool, &ref_dequant);
+    return 1;
+  }
+  rf_idct_that_thing (&ref_dequant, &ref_yuv);
+
+  float *ref_out;
+  size_t nout;
+
+  if (output == RF_GL_OUTPUT_RGB) {
+    nout = n * 3;
+    ref_out = rf_yuv_to_rgb_image (&ref_yuv);
+    for (size_t i = 0; i < nout; i++)
+      ref_out[i] = fminf (fmaxf (ref_out[i], 0.0f), 1.0f) * 255.0f;
+  } else {
+    /* Y, then U and V either interleaved or one after another */
+    const float *py = ref_yuv.Y;
+
+    nout = n + n / 2;
+    ref_out = malloc (nout * sizeof (float));
+    for (size_t i = 0; i < n; i++)
+      ref_out[i] = fminf (fmaxf (py[i], 0.0f), 1.0f) * 255.0f;
+    if (output == RF_GL_OUTPUT_NV12) {
+      rf_downsample_420 (ref_yuv.U, w, h, ref_out + n, 2);
+      rf_downsample_420 (ref_yuv.V, w, h, ref_out + n + 1, 2);
+    } else {
+      rf_downsample_420 (ref_yuv.U, w, h, ref_out + n, 1);
+      rf_downsample_420 (ref_yuv.V, w, h, ref_out + n + n / 4, 1);
+    }
+  }
+  rf_yuv_data_release (pool, &ref_yuv);
+
+  /* off by one at the rounding edges is fine for the coefficients */
+  for (int i = 0; enc && i < 3; i++) {
+    stages[nstages++] = (RFStage) { enc_names[i], ref_coeffs[i],
+      rf_read_plane (enc->zigzag_output[i].framebuffer, GL_R32F, w, h), n,
+      60.0 };
+  }
+
+  for (int i = 0; i < 3; i++) {
+    stages[nstages++] = (RFStage) { deq_names[i], ref_planes[i],
+      rf_read_plane (dequant[i].framebuffer, dequant_format, w, h), n,
+      60.0 };
+  }
+
+  if (output == RF_GL_OUTPUT_RGB) {
+    stages[nstages++] = (RFStage) { "rgb", ref_out,
+      rf_read_u8 (out[0].framebuffer, GL_RGB, 3, w, h), nout, 40.0 };
+  } else {
+    stages[nstages++] = (RFStage) { "y", ref_out,
+      rf_read_u8 (out[0].framebuffer, GL_RED, 1, w, h), n, 40.0 };
+    if (output == RF_GL_OUTPUT_NV12) {
+      stages[nstages++] = (RFStage) { "uv", ref_out + n,
+        rf_read_u8 (out[1].framebuffer, GL_RG, 2, w / 2, h / 2), n / 2,
+        40.0 };
+    } else {
+      stages[nstages++] = (RFStage) { "u", ref_out + n,
+        rf_read_u8 (out[1].framebuffer, GL_RED, 1, w / 2, h / 2), n / 4,
+        40.0 };
+      stages[nstages++] = (RFStage) { "v", ref_out + n + n / 4,
+        rf_read_u8 (out[2].framebuffer, GL_RED, 1, w / 2, h / 2), n / 4,
+        40.0 };
+    }
+  }
+
+  printf ("%-12s %10s %12s\n", "stage", "PSNR, dB", "max error");
+  for (int i = 0; i < nstages; i++) {
+    RFStageStats st;
+    float lo = stages[i].ref[0], hi = stages[i].ref[0];
+
+    for (size_t k = 0; k < stages[i].n; k++) {
+      lo = fminf (lo, stages[i].ref[k]);
+      hi = fmaxf (hi, stages[i].ref[k]);
+    }
+
+    rf_compare_plane (stages[i].ref, stages[i].test, stages[i].n,
+        hi > lo ? hi - lo : 1.0f, &st);
+
+    /* written this way NaN fails too */
+    int ok = st.psnr >= stages[i].min_psnr;
+    failed += !ok;
+
+    printf ("%-12s %10.2f %12f %s\n", stages[i].name, st.psnr, st.max_error,
+        ok ? "" : "FAILED");
+    free (stages[i].test);
+  }
+
+  free (ref_out);
+  rf_yuv_data_release (pool, &ref_dequant);
+  return failed;
+}
+
+double rf_now (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+void rf_write_jpeg (const char *fname, RFYUVData *coeffs,
+    const float table[64], const RFJpegParams *params)
+{
+  const float *planes[3] = { coeffs->Y, coeffs->U, coeffs->V };
+  RFBuffer jpeg;
+  FILE *f;
+
+  if (rf_jpeg_encode (planes, coeffs->width, coeffs->height, table, params,
+          &jpeg)) {
+    printf ("Can't encode %dx%d\n", coeffs->width, coeffs->height);
+    return;
+  }
+
+  f = fopen (fname, "wb");
+  if (!f) {
+    printf ("Can't open %s\n", fname);
+  } else {
+    fwrite (jpeg.data, 1, jpeg.size, f);
+    fclose (f);
+    printf ("%s: %zu bytes\n", fname, jpeg.size);
+  }
+
+  free (jpeg.data);
+}
+
+/* MB/s are counted for the 8 bit RGB picture, so they compare to other
+ * encoders. Restart interval is one MCU row unless told otherwise. */
+void rf_bench_entropy (RFYUVData *coeffs, const float table[64], int restart)
+{
+  const float *planes[3] = { coeffs->Y, coeffs->U, coeffs->V };
+  double mb = coeffs->width * coeffs->height * 3 / 1e6;
+  int maxthreads = sysconf (_SC_NPROCESSORS_ONLN);
+
+  for (int optimize = 0; optimize < 2; optimize++) {
+    for (int threads = 1;; threads *= 2) {
+      RFJpegParams params = {
+        optimize, restart ? restart : coeffs->width / 8, threads
+      };
+      RFBuffer jpeg;
+      double start = rf_now (), elapsed;
+      size_t size = 0;
+      int runs;
+
+      if (threads > maxthreads)
+        params.threads = threads = maxthreads;
+
+      for (runs = 0; (elapsed = rf_now () - start) < 0.5; runs++) {
+        if (rf_jpeg_encode (planes, coeffs->width, coeffs->height, table,
+                &params, &jpeg)) {
+          printf ("Can't encode %dx%d\n", coeffs->width, coeffs->height);
+          return;
+        }
+        size = jpeg.size;
+        free (jpeg.data);
+      }
+
+      printf ("%s tables, %2d threads: %8zu bytes, %8.1f MB/s\n",
+          optimize ? "optimized" : "standard ", threads, size,
+          mb * runs / elapsed);
+
+      if (threads == maxthreads)
+        break;
+    }
+  }
+}
+
+static void rf_file_sink (const uint8_t *data, size_t size, void *user_data)
+{
+  fwrite (data, 1, size, user_data);
+}
+
+typedef struct {
+  RFJpegStream *jpeg;
+  double start, first_output;
+  int failed;
+} RFStreamState;
+
+static void rf_strip_to_jpeg (const RFYUVData *coeffs, void *user_data)
+{
+  RFStreamState *st = user_data;
+  const float *rows[3] = { coeffs->Y, coeffs->U, coeffs->V };
+
+  if (rf_jpeg_stream_push (st->jpeg, rows)) {
+    st->failed = 1;
+    return;
+  }
+  if (!st->first_output)
+    st->first_output = rf_now () - st->start;
+}
+
+/* Encodes a @height rows tall gradient strip by strip, the memory it takes
+ * doesn't depend on @height */
+int rf_stream_jpeg (const char *fname, RFPlanePool *pool, int width,
+    int height, const float table[64], int restart)
+{
+  RFStreamState st = { NULL, rf_now (), 0, 0 };
+  RFStripEncoder se;
+  RFYUVData strip;
+  FILE *f = fopen (fname, "wb");
+  int ret;
+
+  if (!f) {
+    printf ("Can't write %s\n", fname);
+    return -1;
+  }
+
+  st.jpeg = rf_jpeg_stream_new (width, height, table, restart, rf_file_sink,
+      f);
+  if (!st.jpeg || rf_yuv_data_acquire (pool, width, 8, &strip) ||
+      rf_strip_encoder_init (&se, pool, width, table, rf_strip_to_jpeg, &st)) {
+    printf ("Can't encode %dx%d\n", width, height);
+    fclose (f);
+    return -1;
+  }
+
+  for (int row = 0; row < height && !st.failed; row += 8) {
+    rf_yuv_gradient_strip (&strip, row, height);
+    rf_strip_encoder_push (&se, &strip);
+  }
+
+  /* frees the stream either way */
+  ret = rf_jpeg_stream_finish (st.jpeg);
+  if (st.failed || ret) {
+    printf ("Can't encode %dx%d\n", width, height);
+    ret = -1;
+  } else {
+    printf ("%s: %dx%d streamed in %.3f s, first row out after %.3f ms, "
+        "%ld bytes\n", fname, width, height, rf_now () - st.start,
+        st.first_output * 1000, ftell (f));
+  }
+
+  rf_strip_encoder_clear (&se, pool);
+  rf_yuv_data_release (pool, &strip);
+  fclose (f);
+
+  /* not a truncated file */
+  if (ret)
+    remove (fname);
+  return ret;
+}
+
+/* A JPEG file that comes to the decoder a piece per frame, as if it was
+ * downloaded. */
+typedef struct {
+  RFJpegDecoder *dec;
+  uint8_t *file;
+  size_t size, fed, trickle;
+  int scans, done;
+  RFYUVData planes;
+  float tables[3][64];
+} RFJpegInput;
+
+static int rf_jpeg_input_feed (RFJpegInput *in, int *updated)
+{
+  size_t n = in->trickle ? in->trickle : in->size;
+  RFJpegStatus status;
+  int scan_updated;
+
+  if (n > in->size - in->fed)
+    n = in->size - in->fed;
+  if (rf_jpeg_decoder_push (in->dec, in->file + in->fed, n)) {
+    printf ("Can't take %zu more bytes of JPEG\n", n);
+    in->done = 1;
+    return -1;
+  }
+  in->fed += n;
+
+  while ((status = rf_jpeg_decoder_decode (in->dec, &scan_updated)) > 0) {
+    if (status == RF_JPEG_HEADER)
+      continue;
+    if (status == RF_JPEG_DONE) {
+      in->done = 1;
+      break;
+    }
+
+    *updated |= scan_updated;
+    in->scans++;
+    printf ("scan %d: %zu of %zu bytes (%.1f%%)\n", in->scans,
+        rf_jpeg_decoder_position (in->dec), in->size,
+        rf_jpeg_decoder_position (in->dec) * 100.0 / in->size);
+  }
+
+  if (status == RF_JPEG_UNSUPPORTED) {
+    printf ("subsampled JPEG, only 4:4:4 and grayscale are supported\n");
+    in->done = 1;
+    return -1;
+  }
+  if (status == RF_JPEG_ERROR) {
+    printf ("broken or unsupported JPEG at byte %zu\n",
+        rf_jpeg_decoder_position (in->dec));
+    in->done = 1;
+    return -1;
+  }
+
+  if (in->fed == in->size && status == RF_JPEG_NEED_DATA)
+    in->done = 1;
+
+  return 0;
+}
+
+static void rf_jpeg_input_close (RFJpegInput *in, RFPlanePool *pool)
+{
+  if (in->planes.Y)
+    rf_yuv_data_release (pool, &in->planes);
+  if (in->dec)
+    rf_jpeg_decoder_free (in->dec);
+  free (in->file);
+  memset (in, 0, sizeof (*in));
+}
+
+/* Reads the file and feeds it until the frame header. On failure there's
+ * nothing to close. */
+static int rf_jpeg_input_open (RFJpegInput *in, RFPlanePool *pool,
+    const char *fname, size_t trickle)
+{
+  FILE *f = fopen (fname, "rb");
+  const RFJpegFrame *frame;
+  int updated = 0;
+  long size;
+
+  memset (in, 0, sizeof (*in));
+  if (!f) {
+    printf ("Can't open %s\n", fname);
+    return -1;
+  }
+
+  if (fseek (f, 0, SEEK_END) || (size = ftell (f)) < 0 ||
+      fseek (f, 0, SEEK_SET)) {
+    printf ("Can't tell the size of %s\n", fname);
+    fclose (f);
+    return -1;
+  }
+  in->file = malloc (size ? size : 1);
+  if (!in->file) {
+    printf ("Can't read %ld bytes of %s\n", size, fname);
+    fclose (f);
+    return -1;
+  }
+  in->size = fread (in->file, 1, size, f);
+  fclose (f);
+
+  in->dec = rf_jpeg_decoder_new ();
+  in->trickle = trickle;
+  if (!in->dec)
+    goto failed;
+
+  while (!(frame = rf_jpeg_decoder_frame (in->dec)) && !in->done) {
+    if (rf_jpeg_input_feed (in, &updated))
+      goto failed;
+  }
+
+  if (!frame) {
+    printf ("%s: no frame header\n", fname);
+    goto failed;
+  }
+
+  printf ("%s: %dx%d, %d components, %s\n", fname, frame->width,
+      frame->height, frame->components,
+      frame->progressive ? "progressive" : "baseline");
+
+  if (rf_yuv_data_acquire (pool, frame->plane_width, frame->plane_height,
+          &in->planes))
+    goto failed;
+
+  /* The tables come before the frame header */
+  for (int c = 0; c < 3; c++)
+    rf_jpeg_decoder_get_table (in->dec, c, in->tables[c]);
+
+  /* Whatever scans came with the header */
+  rf_jpeg_decoder_get_plane (in->dec, 0, in->planes.Y);
+  rf_jpeg_decoder_get_plane (in->dec, 1, in->planes.U);
+  rf_jpeg_decoder_get_plane (in->dec, 2, in->planes.V);
+
+  return 0;
+
+failed:
+  rf_jpeg_input_close (in, pool);
+  return -1;
+}
+
+int main(int argc, char **argv) {
+  int gpu_encode = 0, bench_entropy = 0, validate = 0, ret = 0;
+  GLenum dequant_format = GL_R16F;
+  RFGLOutput output = RF_GL_OUTPUT_RGB;
+  double decode_time = 0;
+  const char *jpeg_out = NULL, *jpeg_in = NULL;
+  size_t trickle = 0;
+  int stream_height = 0;
+  const float *qtable = losslessQuant;
+  const float *qtables[3];
+  RFJpegParams jpeg_params = { 0, 0, 1 };
+  RFJpegInput input;
+  RFPlanePool *pool = rf_plane_pool_new ();
+  RFYUVData cpu_coeffs;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp (argv[i], "--gpu-encode")) {
+      gpu_encode = 1;
+    } else if (!strcmp (argv[i], "--std-quant")) {
+      qtable = stdQuant;
+    } else if (!strcmp (argv[i], "--jpeg") && i + 1 < argc) {
+      jpeg_out = argv[++i];
+    } else if (!strcmp (argv[i], "--jpeg-in") && i + 1 < argc) {
+      jpeg_in = argv[++i];
+    } else if (!strcmp (argv[i], "--trickle") && i + 1 < argc) {
+      trickle = atoi (argv[++i]);
+    } else if (!strcmp (argv[i], "--stream") && i + 1 < argc) {
+      stream_height = atoi (argv[++i]);
+    } else if (!strcmp (argv[i], "--optimize-huffman")) {
+      jpeg_params.optimize = 1;
+    } else if (!strcmp (argv[i], "--restart") && i + 1 < argc) {
+      jpeg_params.restart_interval = atoi (argv[++i]);
+    } else if (!strcmp (argv[i], "--threads") && i + 1 < argc) {
+      jpeg_params.threads = atoi (argv[++i]);
+    } else if (!strcmp (argv[i], "--bench-entropy")) {
+      bench_entropy = 1;
+    } else if (!strcmp (argv[i], "--validate")) {
+      validate = 1;
+    } else if (!strcmp (argv[i], "--dequant-format") && i + 1 < argc) {
+      i++;
+      dequant_format = !strcmp (argv[i], "r32f") ? GL_R32F : GL_R16F;
+    } else if (!strcmp (argv[i], "--output") && i + 1 < argc) {
+      i++;
+      if (!strcmp (argv[i], "nv12"))
+        output = RF_GL_OUTPUT_NV12;
+      else if (!strcmp (argv[i], "i420"))
+        output = RF_GL_OUTPUT_I420;
+      else
+        output = RF_GL_OUTPUT_RGB;
+    } else {
+      printf ("usage: %s [--gpu-encode] [--std-quant] [--jpeg <file>]\n"
+          "    [--optimize-huffman] [--restart <MCUs>] [--threads <n>]\n"
+          "    [--bench-entropy] [--validate] [--dequant-format r16f|r32f]\n"
+          "    [--output rgb|nv12|i420]\n"
+          "    [--jpeg-in <file> [--trickle <bytes per frame>]]\n"
+          "    [--stream <height> --jpeg <file>]\n",
+          argv[0]);
+      return 1;
+    }
+  }
+
+  if (jpeg_in && (gpu_encode || validate || bench_entropy || jpeg_out)) {
+    printf ("--jpeg-in only goes with --trickle, --dequant-format and "
+        "--output\n");
+    return 1;
+  }
+
+  /* No GPU and no whole frames, just the CPU encoder on the strips */
+  if (stream_height) {
+    if (!jpeg_out || stream_height % 8) {
+      printf ("--stream takes a multiple of 8 and --jpeg\n");
+      return 1;
+    }
+    ret = rf_stream_jpeg (jpeg_out, pool, WIDTH, stream_height, qtable,
+        jpeg_params.restart_interval) ? 1 : 0;
+    rf_plane_pool_free (pool);
+    return ret;
+  }
+
+  RFYUVData* yuv = NULL;
+  RFYUVData* cpu_data;
+
+  if (jpeg_in) {
+    if (rf_jpeg_input_open (&input, pool, jpeg_in, trickle))
+      return 1;
+    cpu_data = &input.planes;
+    for (int c = 0; c < 3; c++)
+      qtables[c] = input.tables[c];
+  } else {
+    RFYUVData dct, quant;
+
+    yuv = generateYUVGradient();
+    if (rf_yuv_data_acquire (pool, yuv->width, yuv->height, &dct) ||
+        rf_yuv_data_acquire (pool, yuv->width, yuv->height, &quant))
+      return 1;
+    rf_dct_that_thing (yuv, &dct);
+    rf_quant_that_thing (qtable, &dct, &quant);
+    rf_yuv_data_release (pool, &dct);
+
+    /* gets the planes of the DCT back */
+    if (rf_yuv_data_acquire (pool, yuv->width, yuv->height, &cpu_coeffs))
+      return 1;
+    rf_zigzag_that_thing (&quant, &cpu_coeffs);
+    rf_yuv_data_release (pool, &quant);
+    cpu_data = &cpu_coeffs;
+    qtables[0] = qtables[1] = qtables[2] = qtable;
+  }
+
+  /* Parallel encoding needs restart intervals, take one per MCU row */
+  if (jpeg_params.threads > 1 && !jpeg_params.restart_interval)
+    jpeg_params.restart_interval = cpu_data->width / 8;
+
+  if (bench_entropy) {
+    rf_bench_entropy (cpu_data, qtable, jpeg_params.restart_interval);
+    return 0;
+  }
+
+  if (jpeg_out && !gpu_encode)
+    rf_write_jpeg (jpeg_out, cpu_data, qtable, &jpeg_params);
+
+
+  GLFWwindow* window = rf_create_window (!validate);
+  if (!window) {
+    fprintf (stderr, "No window, is there a display?\n");
+    /* 77 is a skipped test for meson */
+    return validate ? 77 : 1;
+  }
+  glViewport(0, 0, 1024, 1024);
+
+  RFGLDecoder dec;
+  RFEncoder enc;
+  RFReadback readback[2];
+
+  if (gpu_encode) {
+    /* Only RGB goes to the GPU, the encoder output is the decoder input */
+    float *rgb = rf_yuv_to_rgb_image (yuv);
+    GLuint rgbInp = rf_create_texture_format (GL_RGB32F, GL_RGB, rgb,
+        yuv->width, yuv->height);
+    GLuint zigzag[3];
+    free (rgb);
+
+    /* the app has nothing to fall back to, what failed is on stderr */
+    if (!rgbInp || rf_encoder_init (&enc, rgbInp, qtable, yuv->width,
+            yuv->height))
+      return 1;
+    rf_readback_init (&readback[0], yuv->width, yuv->height);
+    rf_readback_init (&readback[1], yuv->width, yuv->height);
+
+    for (int c = 0; c < 3; c++)
+      zigzag[c] = enc.zigzag_output[c].texture;
+    if (rf_gl_decoder_init (&dec, cpu_data->width, cpu_data->height,
+            dequant_format, zigzag))
+      return 1;
+  } else {
+    /* Upload CPU data to textures */
+    if (rf_gl_decoder_init (&dec, cpu_data->width, cpu_data->height,
+            dequant_format, NULL))
+      return 1;
+    rf_gl_decoder_upload (&dec, 0, cpu_data->Y);
+    rf_gl_decoder_upload (&dec, 1, cpu_data->U);
+    rf_gl_decoder_upload (&dec, 2, cpu_data->V);
+  }
+  rf_gl_decoder_set_tables (&dec, qtables);
+  GLuint vao = dec.vao;
+
+    /* RGB, or the planes of YUV: no color conversion on the way, and
+     * half the bytes to write with 4:2:0 */
+    RFFb out[3] = { { 0 } };
+    GLuint out_tex[3];
+    int cw = cpu_data->width / 2, ch = cpu_data->height / 2;
+
+    if (output == RF_GL_OUTPUT_RGB) {
+      out[0] = rf_make_framebuffer (GL_RGB, cpu_data->width, cpu_data->height);
+    } else {
+      out[0] = rf_make_framebuffer (GL_R8, cpu_data->width, cpu_data->height);
+      if (output == RF_GL_OUTPUT_NV12) {
+        out[1] = rf_make_framebuffer (GL_RG8, cw, ch);
+      } else {
+        out[1] = rf_make_framebuffer (GL_R8, cw, ch);
+        out[2] = rf_make_framebuffer (GL_R8, cw, ch);
+      }
+    }
+    if (!out[0].framebuffer || (output != RF_GL_OUTPUT_RGB &&
+            !out[1].framebuffer) || (output == RF_GL_OUTPUT_I420 &&
+            !out[2].framebuffer))
+      return 1;
+    for (int c = 0; c < 3; c++)
+      out_tex[c] = out[c].texture;
+
+    RFUniform screen_unis[] = {
+      { "rgbTex", out[0].texture, 1 },
+      { NULL }
+    };
+    RFUniform yuv_screen_unis[] = {
+      { "yTex", out[0].texture, 1 },
+      { "uTex", out[1].texture, 1 },
+      { "vTex", output == RF_GL_OUTPUT_NV12 ? out[1].texture : out[2].texture, 1 },
+      { NULL }
+    };
+    RFUniform *unis = screen_unis;
+    const char *screen_fragment = fragmentPassThrough;
+
+    if (output != RF_GL_OUTPUT_RGB) {
+      unis = yuv_screen_unis;
+      screen_fragment = output == RF_GL_OUTPUT_NV12 ?
+          fragmentNV12toScreen : fragmentI420toScreen;
+    }
+
+    GLuint screen_shader = rf_create_shader_program (vertexPassThrough,
+        screen_fragment, unis);
+    if (!screen_shader)
+      return 1;
+
+    // rendering into the window.
+    for (int frame = 0; !glfwWindowShouldClose(window); frame++) {
+
+      if (gpu_encode) {
+        RFReadback *rb = &readback[frame % 2];
+        RFYUVData coeffs;
+
+        rf_encode (&enc, vao);
+
+        /* Coefficients of 2 frames ago are there by now, this is where
+         * the entropy coder will take them. Don't stall if they're not. */
+        if (rf_readback_map (rb, &coeffs, 0)) {
+          if (frame == 2) {
+            printf ("GPU encoder vs CPU: max coefficient diff %f\n",
+                rf_planes_max_diff (cpu_data, &coeffs));
+            if (jpeg_out)
+              rf_write_jpeg (jpeg_out, &coeffs, qtable, &jpeg_params);
+          }
+          rf_readback_unmap (rb);
+        }
+        rf_readback_start (rb, enc.zigzag_output);
+
+        glViewport(0, 0, 1024, 1024);
+      }
+
+      if (jpeg_in && !input.done) {
+        int updated = 0;
+
+        rf_jpeg_input_feed (&input, &updated);
+
+        /* Only the planes the new scans touched go to the GPU again */
+        if (updated & 1) {
+          rf_jpeg_decoder_get_plane (input.dec, 0, input.planes.Y);
+          rf_gl_decoder_upload (&dec, 0, input.planes.Y);
+        }
+        if (updated & 2) {
+          rf_jpeg_decoder_get_plane (input.dec, 1, input.planes.U);
+          rf_gl_decoder_upload (&dec, 1, input.planes.U);
+        }
+        if (updated & 4) {
+          rf_jpeg_decoder_get_plane (input.dec, 2, input.planes.V);
+          rf_gl_decoder_upload (&dec, 2, input.planes.V);
+        }
+      }
+
+      double start = rf_now ();
+
+      if (output == RF_GL_OUTPUT_RGB)
+        rf_gl_decoder_run (&dec, out[0].framebuffer);
+      else
+        rf_gl_decoder_run_yuv (&dec, output, out_tex);
+
+      if (validate) {
+        glFinish();
+        decode_time += rf_now () - start;
+
+        if (frame == RF_VALIDATE_FRAMES - 1) {
+          printf ("decode passes: %.3f ms/frame, dequant to %s\n",
+              decode_time * 1000 / RF_VALIDATE_FRAMES,
+              dequant_format == GL_R32F ? "R32F" : "R16F");
+          ret = rf_validate (pool, cpu_data, qtable, gpu_encode ? &enc : NULL,
+              dec.dequant, dequant_format, output, out) ? 1 : 0;
+          break;
+        }
+      }
+
+      // unbind framebuffer
+      glBindFramebuffer(GL_FRAMEBUFFER, 0);
+      // ----------------------------------
+      glViewport(0, 0, 1024, 1024);
+      glClear(GL_COLOR_BUFFER_BIT);
+
+      rf_use_shader_program(GL_TEXTURE_2D, screen_shader, unis);
+      rf_draw_to_target_buffer (vao);
+
+      /* Show image on the screen */
+      glfwSwapBuffers(window);
+
+      glBindTexture(GL_TEXTURE_2D, 0);
+      glfwPollEvents();
+    }
+
+    glfwTerminate();
+    if (jpeg_in)
+      rf_jpeg_input_close (&input, pool);
+    rf_plane_pool_free (pool);
+    return ret;
+}
@@ -0,0 +1,747 @@
+/*
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ */
+
+#include "rf_entropy.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Worst case of one block: 64 codes of 16 + 11 bits, doubled by the
+ * 0xFF stuffing. */
+#define RF_MAX_BLOCK_BYTES 512
+
+/* Longest code the Huffman tree of 257 symbols can give, before the
+ * lengths are limited to 16 bits */
+#define RF_MAX_CLEN 256
+
+/* Tables of the Annex K.3, as they go to the DHT segment */
+static const uint8_t dc_luma_bits[16] = {
+  0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0
+};
+
+static const uint8_t dc_chroma_bits[16] = {
+  0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0
+};
+
+static const uint8_t dc_vals[12] = {
+  0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11
+};
+
+static const uint8_t ac_luma_bits[16] = {
+  0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d
+};
+
+static const uint8_t ac_luma_vals[162] = {
+  0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12,
+  0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+  0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08,
+  0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+  0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16,
+  0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+  0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+  0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+  0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+  0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+  0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79,
+  0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+  0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98,
+  0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+  0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6,
+  0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+  0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4,
+  0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+  0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea,
+  0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+  0xf9, 0xfa
+};
+
+static const uint8_t ac_chroma_bits[16] = {
+  0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77
+};
+
+static const uint8_t ac_chroma_vals[162] = {
+  0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21,
+  0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+  0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91,
+  0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+  0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34,
+  0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+  0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38,
+  0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+  0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+  0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+  0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
+  0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+  0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96,
+  0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+  0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4,
+  0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+  0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2,
+  0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+  0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9,
+  0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+  0xf9, 0xfa
+};
+
+static const int zigzag_order[64] = {
+   0,  1,  8, 16,  9,  2,  3, 10,
+  17, 24, 32, 25, 18, 11,  4,  5,
+  12, 19, 26, 33, 40, 48, 41, 34,
+  27, 20, 13,  6,  7, 14, 21, 28,
+  35, 42, 49, 56, 57, 50, 43, 36,
+  29, 22, 15, 23, 30, 37, 44, 51,
+  58, 59, 52, 45, 38, 31, 39, 46,
+  53, 60, 61, 54, 47, 55, 62, 63
+};
+
+typedef struct {
+  /* DHT form */
+  uint8_t bits[16];
+  uint8_t vals[256];
+  int nvals;
+  /* encoder form, indexed by the symbol */
+  uint16_t code[256];
+  uint8_t size[256];
+} RFHuffTable;
+
+typedef struct {
+  long dc[256];
+  long ac[256];
+} RFHuffStats;
+
+/* 0 is Y, 1 is shared by Cb and Cr */
+typedef struct {
+  RFHuffTable dc[2];
+  RFHuffTable ac[2];
+} RFHuffTables;
+
+typedef struct {
+  uint64_t acc;
+  int bits;
+  RFBuffer *buf;
+} RFBitWriter;
+
+/* Once it fails the buffer stays failed, and nothing more goes in */
+static int
+rf_buffer_reserve (RFBuffer * buf, size_t more)
+{
+  uint8_t *data;
+
+  if (buf->failed)
+    return -1;
+  if (buf->size + more <= buf->alloc)
+    return 0;
+
+  data = realloc (buf->data, (buf->size + more) * 2);
+  if (!data) {
+    buf->failed = 1;
+    return -1;
+  }
+
+  buf->data = data;
+  buf->alloc = (buf->size + more) * 2;
+  return 0;
+}
+
+static void
+rf_buffer_append (RFBuffer * buf, const void *data, size_t size)
+{
+  if (rf_buffer_reserve (buf, size))
+    return;
+  memcpy (buf->data + buf->size, data, size);
+  buf->size += size;
+}
+
+static void
+rf_buffer_put16 (RFBuffer * buf, int v)
+{
+  uint8_t b[2] = { v >> 8, v & 0xff };
+  rf_buffer_append (buf, b, 2);
+}
+
+/* Annex C: codes from the DHT form */
+static void
+rf_huff_table_build (RFHuffTable * t)
+{
+  int code = 0, k = 0;
+
+  memset (t->code, 0, sizeof (t->code));
+  memset (t->size, 0, sizeof (t->size));
+
+  for (int len = 1; len <= 16; len++) {
+    for (int i = 0; i < t->bits[len - 1]; i++, k++) {
+      t->code[t->vals[k]] = code++;
+      t->size[t->vals[k]] = len;
+    }
+    code <<= 1;
+  }
+}
+
+static void
+rf_huff_table_std (RFHuffTable * t, const uint8_t bits[16],
+    const uint8_t * vals)
+{
+  t->nvals = 0;
+  for (int i = 0; i < 16; i++)
+    t->nvals += bits[i];
+
+  memcpy (t->bits, bits, 16);
+  memcpy (t->vals, vals, t->nvals);
+  rf_huff_table_build (t);
+}
+
+/* Annex K.2: code lengths from the frequencies, limited to 16 bits. The
+ * reserved symbol 256 makes sure no code is all ones. */
+static void
+rf_huff_table_optimal (RFHuffTable * t, const long stats[256])
+{
+  long freq[257];
+  int codesize[257], others[257], bits[RF_MAX_CLEN + 1];
+
+  memcpy (freq, stats, sizeof (long) * 256);
+  freq[256] = 1;
+  memset (codesize, 0, sizeof (codesize));
+  memset (bits, 0, sizeof (bits));
+  for (int i = 0; i < 257; i++)
+    others[i] = -1;
+
+  for (;;) {
+    int c1 = -1, c2 = -1;
+    long v = 1000000000L;
+
+    /* c1 is the least frequent, c2 the next one. On ties the bigger
+     * symbol wins, so the reserved one goes deepest. */
+    for (int i = 0; i <= 256; i++) {
+      if (freq[i] && freq[i] <= v) {
+        v = freq[i];
+        c1 = i;
+      }
+    }
+    v = 1000000000L;
+    for (int i = 0; i <= 256; i++) {
+      if (freq[i] && freq[i] <= v && i != c1) {
+        v = freq[i];
+        c2 = i;
+      }
+    }
+
+    if (c2 < 0)
+      break;
+
+    freq[c1] += freq[c2];
+    freq[c2] = 0;
+
+    codesize[c1]++;
+    while (others[c1] >= 0) {
+      c1 = others[c1];
+      codesize[c1]++;
+    }
+    others[c1] = c2;
+
+    codesize[c2]++;
+    while (others[c2] >= 0) {
+      c2 = others[c2];
+      codesize[c2]++;
+    }
+  }
+
+  for (int i = 0; i <= 256; i++) {
+    if (codesize[i])
+      bits[codesize[i]]++;
+  }
+
+  for (int i = RF_MAX_CLEN; i > 16; i--) {
+    while (bits[i] > 0) {
+      int j = i - 2;
+      while (bits[j] == 0)
+        j--;
+
+      bits[i] -= 2;
+      bits[i - 1]++;
+      bits[j + 1] += 2;
+      bits[j]--;
+    }
+  }
+
+  /* drop the reserved symbol, it has the longest code */
+  for (int i = 16; i > 0; i--) {
+    if (bits[i]) {
+      bits[i]--;
+      break;
+    }
+  }
+
+  t->nvals = 0;
+  for (int len = 1; len <= RF_MAX_CLEN; len++) {
+    for (int s = 0; s < 256; s++) {
+      if (codesize[s] == len)
+        t->vals[t->nvals++] = s;
+    }
+  }
+
+  for (int i = 0; i < 16; i++)
+    t->bits[i] = bits[i + 1];
+
+  rf_huff_table_build (t);
+}
+
+static inline int
+rf_nbits (int v)
+{
+  unsigned a = v < 0 ? -v : v;
+  return a ? 32 - __builtin_clz (a) : 0;
+}
+
+static inline int
+rf_clamp (int v, int min, int max)
+{
+  v = v > max ? max : v;
+  return v < min ? min : v;
+}
+
+static inline void
+rf_put_bits (RFBitWriter * bw, uint32_t code, int len)
+{
+  bw->acc = (bw->acc << len) | code;
+  bw->bits += len;
+
+  if (bw->bits >= 32) {
+    uint32_t w = (uint32_t) (bw->acc >> (bw->bits - 32));
+    uint8_t *p = bw->buf->data + bw->buf->size;
+
+    bw->bits -= 32;
+
+    /* Common case: no 0xFF byte in the word, so no stuffing */
+    if (!((~w - 0x01010101u) & w & 0x80808080u)) {
+      p[0] = w >> 24;
+      p[1] = w >> 16;
+      p[2] = w >> 8;
+      p[3] = w;
+      bw->buf->size += 4;
+    } else {
+      for (int i = 24; i >= 0; i -= 8) {
+        uint8_t b = w >> i;
+        *p++ = b;
+        if (b == 0xff)
+          *p++ = 0;
+      }
+      bw->buf->size = p - bw->buf->data;
+    }
+  }
+}
+
+/* pads with ones up to the byte boundary */
+static void
+rf_flush_bits (RFBitWriter * bw)
+{
+  int pad = (8 - (bw->bits & 7)) & 7;
+
+  if (rf_buffer_reserve (bw->buf, 16))
+    return;
+  rf_put_bits (bw, (1 << pad) - 1, pad);
+
+  while (bw->bits > 0) {
+    uint8_t b = bw->acc >> (bw->bits - 8);
+    bw->buf->data[bw->buf->size++] = b;
+    if (b == 0xff)
+      bw->buf->data[bw->buf->size++] = 0;
+    bw->bits -= 8;
+  }
+}
+
+/* Symbol + magnitude go out as one code, at most 16 + 11 bits */
+static inline void
+rf_put_value (RFBitWriter * bw, const RFHuffTable * t, int run, int v)
+{
+  int s = rf_nbits (v);
+  int sym = (run << 4) | s;
+  /* negative values go as v - 1 in s bits */
+  uint32_t mag = (v + (v >> 31)) & ((1u << s) - 1);
+
+  rf_put_bits (bw, ((uint32_t) t->code[sym] << s) | mag, t->size[sym] + s);
+}
+
+static void
+rf_encode_block (RFBitWriter * bw, const float *zz, int *pred,
+    const RFHuffTable * dc, const RFHuffTable * ac)
+{
+  /* keeps the difference within 11 bits */
+  int dcv = rf_clamp ((int) zz[0], -1024, 1023);
+  int run = 0;
+
+  if (rf_buffer_reserve (bw->buf, RF_MAX_BLOCK_BYTES))
+    return;
+
+  rf_put_value (bw, dc, 0, dcv - *pred);
+  *pred = dcv;
+
+  for (int k = 1; k < 64; k++) {
+    int v = (int) zz[k];
+
+    if (v == 0) {
+      run++;
+      continue;
+    }
+
+    while (run > 15) {
+      rf_put_bits (bw, ac->code[0xf0], ac->size[0xf0]);
+      run -= 16;
+    }
+
+    rf_put_value (bw, ac, run, rf_clamp (v, -1023, 1023));
+    run = 0;
+  }
+
+  if (run)
+    rf_put_bits (bw, ac->code[0x00], ac->size[0x00]);
+}
+
+static void
+rf_count_block (RFHuffStats * st, const float *zz, int *pred)
+{
+  int dcv = rf_clamp ((int) zz[0], -1024, 1023);
+  int run = 0;
+
+  st->dc[rf_nbits (dcv - *pred)]++;
+  *pred = dcv;
+
+  for (int k = 1; k < 64; k++) {
+    int v = (int) zz[k];
+
+    if (v == 0) {
+      run++;
+      continue;
+    }
+
+    for (; run > 15; run -= 16)
+      st->ac[0xf0]++;
+
+    st->ac[(run << 4) | rf_nbits (rf_clamp (v, -1023, 1023))]++;
+    run = 0;
+  }
+
+  if (run)
+    st->ac[0x00]++;
+}
+
+typedef struct {
+  const float **planes;
+  int mcus, interval, nintervals;
+  const RFHuffTables *tables;
+  RFHuffStats *stats;           /* [3] per thread, if counting */
+  RFBuffer *out;                /* per interval, if encoding */
+  atomic_int next;
+} RFEntropyJob;
+
+typedef struct {
+  RFEntropyJob *job;
+  RFHuffStats stats[2];
+} RFEntropyWorker;
+
+/* Takes restart intervals one by one until there are no more. Each one
+ * starts with fresh DC predictors, that's what makes them independent. */
+static void *
+rf_entropy_worker (void *data)
+{
+  RFEntropyWorker *w = data;
+  RFEntropyJob *job = w->job;
+  int i;
+
+  while ((i = atomic_fetch_add (&job->next, 1)) < job->nintervals) {
+    int first = i * job->interval;
+    int last = first + job->interval;
+    int pred[3] = { 0, 0, 0 };
+    RFBitWriter bw = { 0, 0, job->out ? &job->out[i] : NULL };
+
+    if (last > job->mcus)
+      last = job->mcus;
+
+    for (int m = first; m < last; m++) {
+      for (int c = 0; c < 3; c++) {
+        const float *zz = &job->planes[c][m * 64];
+
+        if (job->tables) {
+          rf_encode_block (&bw, zz, &pred[c], &job->tables->dc[c != 0],
+              &job->tables->ac[c != 0]);
+        } else {
+          rf_count_block (&w->stats[c != 0], zz, &pred[c]);
+        }
+      }
+    }
+
+    if (job->tables)
+      rf_flush_bits (&bw);
+  }
+
+  return NULL;
+}
+
+static int
+rf_entropy_run (RFEntropyJob * job, int threads, RFHuffStats stats[2])
+{
+  RFEntropyWorker *workers = calloc (threads, sizeof (RFEntropyWorker));
+  pthread_t *tids = calloc (threads, sizeof (pthread_t));
+
+  if (!workers || !tids) {
+    free (workers);
+    free (tids);
+    return -1;
+  }
+
+  atomic_init (&job->next, 0);
+
+  for (int t = 0; t < threads; t++) {
+    workers[t].job = job;
+    if (t > 0)
+      pthread_create (&tids[t], NULL, rf_entropy_worker, &workers[t]);
+  }
+  /* the caller is the first worker */
+  rf_entropy_worker (&workers[0]);
+
+  for (int t = 0; t < threads; t++) {
+    if (t > 0)
+      pthread_join (tids[t], NULL);
+
+    if (stats) {
+      for (int c = 0; c < 2; c++) {
+        for (int s = 0; s < 256; s++) {
+          stats[c].dc[s] += workers[t].stats[c].dc[s];
+          stats[c].ac[s] += workers[t].stats[c].ac[s];
+        }
+      }
+    }
+  }
+
+  free (tids);
+  free (workers);
+  return 0;
+}
+
+static void
+rf_write_headers (RFBuffer * out, int width, int height,
+    const float table[64], const RFHuffTables * tables, int restart_interval)
+{
+  static const uint8_t soi_app0[] = {
+    0xff, 0xd8,
+    0xff, 0xe0, 0, 16, 'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0
+  };
+  uint8_t dqt[65];
+  uint8_t sof[15] = {
+    8, height >> 8, height & 0xff, width >> 8, width & 0xff, 3,
+    1, 0x11, 0, 2, 0x11, 0, 3, 0x11, 0
+  };
+  static const uint8_t sos[10] = {
+    3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0
+  };
+
+  rf_buffer_append (out, soi_app0, sizeof (soi_app0));
+
+  /* DQT goes in zigzag order, baseline wants 8 bit values */
+  dqt[0] = 0;
+  for (int k = 0; k < 64; k++) {
+    int q = (int) (table[zigzag_order[k]] + 0.5f);
+    dqt[1 + k] = q < 1 ? 1 : q > 255 ? 255 : q;
+  }
+  rf_buffer_put16 (out, 0xffdb);
+  rf_buffer_put16 (out, 2 + sizeof (dqt));
+  rf_buffer_append (out, dqt, sizeof (dqt));
+
+  rf_buffer_put16 (out, 0xffc0);
+  rf_buffer_put16 (out, 2 + sizeof (sof));
+  rf_buffer_append (out, sof, sizeof (sof));
+
+  for (int i = 0; i < 4; i++) {
+    /* DC0, AC0, DC1, AC1 */
+    const RFHuffTable *t = (i & 1) ? &tables->ac[i >> 1] : &tables->dc[i >> 1];
+    uint8_t tc_th = ((i & 1) << 4) | (i >> 1);
+
+    rf_buffer_put16 (out, 0xffc4);
+    rf_buffer_put16 (out, 2 + 1 + 16 + t->nvals);
+    rf_buffer_append (out, &tc_th, 1);
+    rf_buffer_append (out, t->bits, 16);
+    rf_buffer_append (out, t->vals, t->nvals);
+  }
+
+  if (restart_interval) {
+    rf_buffer_put16 (out, 0xffdd);
+    rf_buffer_put16 (out, 4);
+    rf_buffer_put16 (out, restart_interval);
+  }
+
+  rf_buffer_put16 (out, 0xffda);
+  rf_buffer_put16 (out, 2 + sizeof (sos));
+  rf_buffer_append (out, sos, sizeof (sos));
+}
+
+int
+rf_jpeg_encode (const float *planes[3], int width, int height,
+    const float table[64], const RFJpegParams * params, RFBuffer * out)
+{
+  RFHuffTables tables;
+  RFEntropyJob job;
+  int threads = params->threads > 0 ? params->threads : 1;
+
+  if (width % 8 || height % 8 || width > 65535 || height > 65535)
+    return -1;
+
+  job.planes = planes;
+  job.mcus = (width / 8) * (height / 8);
+  job.interval = params->restart_interval ? params->restart_interval : job.mcus;
+  job.nintervals = (job.mcus + job.interval - 1) / job.interval;
+  job.out = NULL;
+
+  if (params->optimize) {
+    RFHuffStats stats[2];
+
+    memset (stats, 0, sizeof (stats));
+    job.tables = NULL;
+    if (rf_entropy_run (&job, threads, stats))
+      return -1;
+
+    for (int c = 0; c < 2; c++) {
+      rf_huff_table_optimal (&tables.dc[c], stats[c].dc);
+      rf_huff_table_optimal (&tables.ac[c], stats[c].ac);
+    }
+  } else {
+    rf_huff_table_std (&tables.dc[0], dc_luma_bits, dc_vals);
+    rf_huff_table_std (&tables.dc[1], dc_chroma_bits, dc_vals);
+    rf_huff_table_std (&tables.ac[0], ac_luma_bits, ac_luma_vals);
+    rf_huff_table_std (&tables.ac[1], ac_chroma_bits, ac_chroma_vals);
+  }
+
+  job.tables = &tables;
+  job.out = calloc (job.nintervals, sizeof (RFBuffer));
+  if (!job.out)
+    return -1;
+  if (rf_entropy_run (&job, threads, NULL))
+    goto failed;
+
+  memset (out, 0, sizeof (RFBuffer));
+  rf_write_headers (out, width, height, table, &tables,
+      params->restart_interval);
+
+  for (int i = 0; i < job.nintervals; i++) {
+    if (job.out[i].failed)
+      out->failed = 1;
+    rf_buffer_append (out, job.out[i].data, job.out[i].size);
+    free (job.out[i].data);
+    job.out[i].data = NULL;
+
+    if (i + 1 < job.nintervals)
+      rf_buffer_put16 (out, 0xffd0 + (i & 7));
+  }
+  rf_buffer_put16 (out, 0xffd9);
+
+  free (job.out);
+  if (out->failed) {
+    free (out->data);
+    memset (out, 0, sizeof (RFBuffer));
+    return -1;
+  }
+  return 0;
+
+failed:
+  for (int i = 0; i < job.nintervals; i++)
+    free (job.out[i].data);
+  free (job.out);
+  return -1;
+}
+
+struct _RFJpegStream {
+  RFHuffTables tables;
+  RFBuffer buf;
+  RFBitWriter bw;
+  int width, height, restart_interval;
+  int mcu, pred[3];
+  RFJpegSink sink;
+  void *user_data;
+};
+
+RFJpegStream *
+rf_jpeg_stream_new (int width, int height, const float table[64],
+    int restart_interval, RFJpegSink sink, void *user_data)
+{
+  RFJpegStream *s;
+
+  if (width % 8 || height % 8 || width > 65535 || height > 65535)
+    return NULL;
+
+  s = calloc (1, sizeof (RFJpegStream));
+  if (!s)
+    return NULL;
+  s->width = width;
+  s->height = height;
+  s->restart_interval = restart_interval;
+  s->sink = sink;
+  s->user_data = user_data;
+
+  rf_huff_table_std (&s->tables.dc[0], dc_luma_bits, dc_vals);
+  rf_huff_table_std (&s->tables.dc[1], dc_chroma_bits, dc_vals);
+  rf_huff_table_std (&s->tables.ac[0], ac_luma_bits, ac_luma_vals);
+  rf_huff_table_std (&s->tables.ac[1], ac_chroma_bits, ac_chroma_vals);
+
+  rf_write_headers (&s->buf, width, height, table, &s->tables,
+      restart_interval);
+  if (s->buf.failed) {
+    free (s->buf.data);
+    free (s);
+    return NULL;
+  }
+  sink (s->buf.data, s->buf.size, user_data);
+  s->buf.size = 0;
+  s->bw.buf = &s->buf;
+
+  return s;
+}
+
+int
+rf_jpeg_stream_push (RFJpegStream * s, const float *rows[3])
+{
+  int mcus = s->width / 8;
+
+  if (s->mcu + mcus > (s->width / 8) * (s->height / 8))
+    return -1;
+
+  for (int m = 0; m < mcus; m++, s->mcu++) {
+    if (s->restart_interval && s->mcu && s->mcu % s->restart_interval == 0) {
+      int n = s->mcu / s->restart_interval - 1;
+
+      rf_flush_bits (&s->bw);
+      rf_buffer_put16 (&s->buf, 0xffd0 + (n & 7));
+      s->pred[0] = s->pred[1] = s->pred[2] = 0;
+    }
+
+    for (int c = 0; c < 3; c++) {
+      rf_encode_block (&s->bw, &rows[c][m * 64], &s->pred[c],
+          &s->tables.dc[c != 0], &s->tables.ac[c != 0]);
+    }
+  }
+
+  if (s->buf.failed)
+    return -1;
+
+  /* the buffer only ever holds one row */
+  s->sink (s->buf.data, s->buf.size, s->user_data);
+  s->buf.size = 0;
+
+  return 0;
+}
+
+int
+rf_jpeg_stream_finish (RFJpegStream * s)
+{
+  int ret = s->mcu == (s->width / 8) * (s->height / 8) ? 0 : -1;
+
+  rf_flush_bits (&s->bw);
+  rf_buffer_put16 (&s->buf, 0xffd9);
+  if (s->buf.failed)
+    ret = -1;
+  else
+    s->sink (s->buf.data, s->buf.size, s->user_data);
+
+  free (s->buf.data);
+  free (s);
+  return ret;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ */
+
+/* Baseline JPEG entropy coder and JFIF writer.
+ *
+ * Takes the coefficient planes the way rf_zigzag_that_thing () leaves them:
+ * quantized, in zigzag order, [8x8] blocks as 64 consecutive floats in the
+ * raster order of the blocks. The 3 planes are Y, Cb and Cr at full
+ * resolution, so each MCU is one block of each. */
+
+#ifndef RF_ENTROPY_H
+#define RF_ENTROPY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+  /* build Huffman tables from the coefficient statistics instead of using
+   * the ones of the Annex K. Costs one more pass over the coefficients. */
+  int optimize;
+  /* in MCUs, 0 means no restart markers. Restart intervals are what is
+   * encoded in parallel, so with threads > 1 it should not be 0. */
+  int restart_interval;
+  int threads;
+} RFJpegParams;
+
+typedef struct {
+  uint8_t *data;
+  size_t size, alloc;
+  /* an allocation failed, what's in it is not the whole thing */
+  int failed;
+} RFBuffer;
+
+/* @table is the quantization table the coefficients were quantized with,
+ * natural order. On success returns 0 and the whole JFIF file in @out,
+ * that must be released with free (out->data). */
+int rf_jpeg_encode (const float *planes[3], int width, int height,
+    const float table[64], const RFJpegParams *params, RFBuffer *out);
+
+/* The same file, written as the coefficients come in, one MCU row at a time.
+ * Takes the Annex K tables, optimizing them needs all the rows first. Each
+ * row goes to @sink as soon as it's encoded, at most a few bits stay
+ * behind. */
+typedef void (*RFJpegSink) (const uint8_t *data, size_t size,
+    void *user_data);
+
+typedef struct _RFJpegStream RFJpegStream;
+
+/* The headers go to @sink right away */
+RFJpegStream *rf_jpeg_stream_new (int width, int height,
+    const float table[64], int restart_interval, RFJpegSink sink,
+    void *user_data);
+
+/* 8 * width coefficients of each plane, in the rf_jpeg_encode () layout */
+int rf_jpeg_stream_push (RFJpegStream *stream, const float *rows[3]);
+
+/* Writes EOI and frees @stream. Fails if some rows were not pushed. */
+int rf_jpeg_stream_finish (RFJpegStream *stream);
+
+#endif
@@ -0,0 +1,692 @@
+/*
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ */
+
+#include "rf_gl.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char* vertexPassThrough = "#version 300 es\n"
+"layout (location = 0) in vec2 pos;\n"
+"layout (location = 1) in vec2 tex;\n"
+"out vec2 texCoord;\n"
+"void main() {\n"
+"    gl_Position = vec4(pos, 0.0, 1.0);\n"
+"    texCoord = tex;\n"
+"}";
+
+const char * fragmentPassThrough =
+    "#version 300 es\n"
+    "precision highp float;\n"
+    "precision highp int;\n"
+    "in vec2 texCoord;\n"
+    "out vec4 fragColor;\n"
+    "uniform sampler2D rgbTex;\n"
+    "void main() {\n"
+    "  fragColor = texture(rgbTex, texCoord);\n"
+    "}\n";
+
+const char * zigzagToDCT =
+    "#version 300 es\n"
+    "precision highp float;\n"
+    "precision highp int;\n"
+    "in vec2 texCoord;\n"
+    "out vec4 fragColor;\n"
+    "uniform sampler2D zigzagInpP;\n"
+    "uniform float qTable[64];\n"
+    // position of each coefficient in the zigzag order, the inverse of
+    // zigzag8x8 of the CPU side
+    "const int zigzag8x8[64] = int[64](\n"
+    " 0,  1,  5,  6, 14, 15, 27, 28,\n"
+    " 2,  4,  7, 13, 16, 26, 29, 42,\n"
+    " 3,  8, 12, 17, 25, 30, 41, 43,\n"
+    " 9, 11, 18, 24, 31, 40, 44, 53,\n"
+    "10, 19, 23, 32, 39, 45, 52, 54,\n"
+    "20, 22, 33, 38, 46, 51, 55, 60,\n"
+    "21, 34, 37, 47, 50, 56, 59, 61,\n"
+    "35, 36, 48, 49, 57, 58, 62, 63\n"
+    ");\n"
+    
+    "void main() {\n"
+    "  ivec2 outPixel = ivec2(gl_FragCoord.xy);"
+    // oook, so we need to fetch now a pixel of the same block,
+    // but a different one inside of the block.
+    // We only play on offset over texCoord.x
+    // texCoord.y will be the same.
+    // zzj represents position inside the block
+    "  int zzj = outPixel.x % 64;\n"
+    "  ivec2 pos = ivec2("
+    "    outPixel.x - zzj + zigzag8x8[zzj],"
+    "    outPixel.y"
+    "  );\n"
+    // coefficients are JPEG ones: DCT of the 0..255 samples, minus 128
+    "  float pixel = texelFetch(zigzagInpP, pos, 0).r * qTable[zzj];\n"
+    "  if (zzj == 0)\n"
+    "    pixel += 1024.0;\n"
+    "  pixel /= 255.0;\n"
+    "  fragColor = vec4(pixel, 0.0, 0.0, 1.0);\n"    
+    "}\n"; // validated
+
+// IDCT funcs, shared by all the passes that end in pixels
+#define IDCT_SUM                                                        \
+    "const float M_PI = 3.14159265358979323846;\n"                       \
+    "float idct_sum (float coeff, int x, int y, int xk, int yk)\n"       \
+    "{\n"                                                               \
+    "  float ck = (xk == 0) ? (1.0f / sqrt(2.0f)) : 1.0f;\n"             \
+    "  float cl = (yk == 0) ? (1.0f / sqrt(2.0f)) : 1.0f;\n"             \
+    "  return ck * cl * coeff *  \n"                                     \
+    "      cos((M_PI * (2.0f * float(x) + 1.0f) * float(xk)) / (2.0f * 8.0f)) *  \n" \
+    "      cos((M_PI * (2.0f * float (y) + 1.0f) * float(yk)) / (2.0f * 8.0f));\n" \
+    "}\n"
+
+const char* fragmentIDCTtoRGB = "#version 300 es\n"
+    "precision highp float;\n"
+    "precision highp int;\n"
+    "out vec4 fragColor;\n"
+    "uniform sampler2D dctInpY;\n"
+    "uniform sampler2D dctInpU;\n"
+    "uniform sampler2D dctInpV;\n"
+    IDCT_SUM
+
+    // so width is now divisible by 64 :(
+    // OOOK, so the
+    // BX - is an X of the OUTPUT block
+    // BY - is an Y of the OUTPUT block
+    // X - is an X (0..8) WITHIN tha block
+    // Y - is an Y (0..8) WITHIN tha bloook
+
+    // bpl means blocks per line.
+    // we say ok, the total index of the pixel / bpl is the fetch y
+#define DEF_IDCT_FOR(yuv)                                               \
+    "float apply_idct_for_" yuv "(int input_block_x, int input_y, int x, int y)\n" \
+        "{\n"                                                           \
+        "  float result = 0.0f\n;"                                      \
+        "  for (int yk = 0; yk < 8; yk++) {\n"                             \
+        "    for (int xk = 0; xk < 8; xk++) {\n"                           \
+        "      int xxx = input_block_x + yk*8 + xk;\n"                    \
+        "      float coeff = texelFetch(dctInp" yuv ", ivec2(xxx, input_y), 0).r;\n" \
+        "      result += idct_sum (coeff, x, y, xk, yk);\n"               \
+        "    }\n"                                                       \
+        "  }\n"                                                         \
+        "  return result * 0.25f;\n"                                    \
+        "}\n"
+    
+    DEF_IDCT_FOR ("Y")
+    DEF_IDCT_FOR ("U")
+    DEF_IDCT_FOR ("V")
+    
+    // YUV to RGB
+    "    vec4 yuv_to_rgb (float y, float u, float v)\n"
+    "    {\n"
+    "      float r = y + 1.402 * v;\n"
+    "      float g = y - 0.344136 * u - 0.714136 * v;\n"
+    "      float b = y + 1.772 * u;\n"
+    "      return vec4(r, g, b, 1.0);\n"  
+    "    }\n"
+    
+    "void main() {\n"
+    // output position
+    "    ivec2 outPixel = ivec2(gl_FragCoord.xy);"
+    "    int width = textureSize (dctInpY, 0).x;\n"
+    // block per line __of the input texture__
+    "    int ibpl = width / 64;\n"    
+    // global block index.
+    // ok, so to remap from the output to input we need
+    // to multiply this global index by proper numbers
+    // Let's think.
+    "    int obpl = width / 8;\n"
+    // This is the index!!
+    "    int gbi = (outPixel.x / 8) + (outPixel.y / 8) * obpl;"
+    // so gbi / bpl is the input block y, that is constant
+    "    int input_y = gbi / ibpl;\n"
+    "    int input_block_x = (gbi - (input_y * ibpl)) * 64;"
+    
+    // Position within the 8x8 block
+    "    int x = outPixel.x % 8;\n"
+    "    int y = outPixel.y % 8;\n"
+    // do idct
+    "    float py = apply_idct_for_Y(input_block_x, input_y, x, y);\n"
+    "    float pu = apply_idct_for_U(input_block_x, input_y, x, y) - 0.5;\n"
+    "    float pv = apply_idct_for_V(input_block_x, input_y, x, y) - 0.5;\n"
+    "    fragColor = yuv_to_rgb (py, pu, pv);\n"
+    "}\n";
+
+/* Where the IDCT of the output pixel takes its coefficients from, the same
+ * for all the passes but the size of the planes comes from @tex */
+#define BLOCK_POS(tex)                                                  \
+    "    int width = textureSize (" tex ", 0).x;\n"                      \
+    "    int ibpl = width / 64;\n"                                       \
+    "    int obpl = width / 8;\n"                                        \
+    "    int gbi = (outPixel.x / 8) + (outPixel.y / 8) * obpl;\n"        \
+    "    int input_y = gbi / ibpl;\n"                                    \
+    "    int input_block_x = (gbi - (input_y * ibpl)) * 64;\n"           \
+    "    int x = outPixel.x % 8;\n"                                      \
+    "    int y = outPixel.y % 8;\n"
+
+/* Y as it is, full range, for the Y plane of NV12 and I420 */
+const char* fragmentIDCTtoLuma = "#version 300 es\n"
+    "precision highp float;\n"
+    "precision highp int;\n"
+    "out vec4 fragColor;\n"
+    "uniform sampler2D dctInpY;\n"
+    IDCT_SUM
+    DEF_IDCT_FOR ("Y")
+    "void main() {\n"
+    "    ivec2 outPixel = ivec2(gl_FragCoord.xy);\n"
+    BLOCK_POS ("dctInpY")
+    "    fragColor = vec4(apply_idct_for_Y(input_block_x, input_y, x, y),"
+    "        0.0, 0.0, 1.0);\n"
+    "}\n";
+
+/* 4:2:0 chroma: each output pixel is the mean of 2x2 of the picture. The
+ * mean of the IDCT is the IDCT with the basis averaged over the pixel pairs,
+ * so it's still 64 fetches per plane, and 2x2 never crosses a block.
+ * Output 0 is UV for NV12 or U for I420, output 1 is V for I420. */
+#define DEF_IDCT420_FOR(yuv)                                            \
+    "float apply_idct420_for_" yuv "(int input_block_x, int input_y, int x, int y)\n" \
+        "{\n"                                                           \
+        "  float result = 0.0f;\n"                                      \
+        "  for (int yk = 0; yk < 8; yk++) {\n"                             \
+        "    float by = basis2 (y, yk);\n"                               \
+        "    for (int xk = 0; xk < 8; xk++) {\n"                           \
+        "      int xxx = input_block_x + yk*8 + xk;\n"                    \
+        "      float coeff = texelFetch(dctInp" yuv ", ivec2(xxx, input_y), 0).r;\n" \
+        "      float ck = (xk == 0) ? (1.0f / sqrt(2.0f)) : 1.0f;\n"     \
+        "      float cl = (yk == 0) ? (1.0f / sqrt(2.0f)) : 1.0f;\n"     \
+        "      result += ck * cl * coeff * basis2 (x, xk) * by;\n"       \
+        "    }\n"                                                       \
+        "  }\n"                                                         \
+        "  return result * 0.25f;\n"                                    \
+        "}\n"
+
+const char* fragmentIDCTtoChroma420 = "#version 300 es\n"
+    "precision highp float;\n"
+    "precision highp int;\n"
+    "layout (location = 0) out vec4 chromaOut0;\n"
+    "layout (location = 1) out vec4 chromaOut1;\n"
+    "uniform sampler2D dctInpU;\n"
+    "uniform sampler2D dctInpV;\n"
+    "const float M_PI = 3.14159265358979323846;\n"
+    // the basis of pixels p and p + 1, averaged
+    "float basis2 (int p, int k)\n"
+    "{\n"
+    "  return 0.5 * (cos((M_PI * (2.0 * float(p) + 1.0) * float(k)) / 16.0) +\n"
+    "      cos((M_PI * (2.0 * float(p) + 3.0) * float(k)) / 16.0));\n"
+    "}\n"
+    DEF_IDCT420_FOR ("U")
+    DEF_IDCT420_FOR ("V")
+    "void main() {\n"
+    // top left of the 2x2 in the picture
+    "    ivec2 outPixel = ivec2(gl_FragCoord.xy) * 2;\n"
+    BLOCK_POS ("dctInpU")
+    "    float pu = apply_idct420_for_U(input_block_x, input_y, x, y);\n"
+    "    float pv = apply_idct420_for_V(input_block_x, input_y, x, y);\n"
+    "    chromaOut0 = vec4(pu, pv, 0.0, 1.0);\n"
+    "    chromaOut1 = vec4(pv, 0.0, 0.0, 1.0);\n"
+    "}\n";
+
+GLuint rf_create_texture_format(GLenum internal, GLenum format,
+    const float* data, int width, int height) {
+    GLuint tex;
+    glGenTextures(1, &tex);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, tex);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    /* errors somebody else left in the context are not ours */
+    while (glGetError() != GL_NO_ERROR);
+
+    // upload
+    glTexImage2D(GL_TEXTURE_2D, 0, internal, width, height, 0, format, GL_FLOAT, data);
+    GLenum err = glGetError();
+
+    // unbind
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (err != GL_NO_ERROR) {
+      fprintf(stderr, "Can't make a %dx%d texture: GL error %x\n", width,
+          height, err);
+      glDeleteTextures(1, &tex);
+      return 0;
+    }
+    return tex;
+}
+
+GLuint rf_create_texture(const float* data, int width, int height) {
+  return rf_create_texture_format (GL_R32F, GL_RED, data, width, height);
+}
+
+/* Replaces the contents of an R32F texture, the size stays */
+void rf_update_texture(GLuint tex, const float* data, int width, int height) {
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, tex);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RED, GL_FLOAT,
+      data);
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void rf_shader_error (GLuint shader)
+{
+  GLint logLength = 0;
+  int program = glIsProgram(shader);
+
+  // Get the length of the info log, shaders and programs have one each
+  if (program)
+    glGetProgramiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+  else
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+
+  // Allocate space for the log and retrieve it
+  char *log = (char *)calloc(1, logLength + 1);
+  if (!log)
+    return;
+
+  if (program)
+    glGetProgramInfoLog(shader, logLength, NULL, log);
+  else
+    glGetShaderInfoLog(shader, logLength, NULL, log);
+
+  fprintf(stderr, "%s:\n%s\n", program ? "Program failed" :
+      "Shader compile error", log);
+  free(log);
+}
+
+GLuint rf_compile_shader(GLenum type, const char* src) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &src, NULL);
+    glCompileShader(shader);
+
+    GLint compiled = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+      rf_shader_error (shader);
+      glDeleteShader(shader);
+      return 0;
+    }
+    
+    return shader;
+}
+
+GLuint rf_gen_target_buffer (void)
+{
+  static const float quad[] = {
+    // pos      // tex
+    -1, -1,     0, 0,
+    1, -1,     1, 0,
+    1,  1,     1, 1,
+    -1,  1,     0, 1
+  };
+  static const unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+  GLuint vao, vbo, ebo;
+  glGenVertexArrays(1, &vao);
+  glGenBuffers(1, &vbo);
+  glGenBuffers(1, &ebo);
+  glBindVertexArray(vao);
+
+  glBindBuffer(GL_ARRAY_BUFFER, vbo);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+  glEnableVertexAttribArray(1);
+
+  return vao;
+}
+
+GLuint rf_create_shader_program (const char *vertex, const char *fragment, RFUniform *unis)
+{
+  GLuint vs = rf_compile_shader(GL_VERTEX_SHADER, vertex);
+  GLuint fs = rf_compile_shader(GL_FRAGMENT_SHADER, fragment);
+
+  if (!vs || !fs) {
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    return 0;
+  }
+
+  GLuint shader = glCreateProgram();
+  glAttachShader(shader, vs);
+  glAttachShader(shader, fs);
+  glLinkProgram(shader);
+  /* the program keeps them as long as it needs them */
+  glDeleteShader(vs);
+  glDeleteShader(fs);
+
+  GLint linkStatus;
+  glGetProgramiv(shader, GL_LINK_STATUS, &linkStatus);
+  if (!linkStatus) {
+    rf_shader_error (shader);
+    glDeleteProgram(shader);
+    return 0;
+  }
+
+  glUseProgram(shader);
+  int t = 0;
+  for (int i = 0; unis[i].name != NULL; i++) {
+    GLint location = glGetUniformLocation(shader, unis[i].name);
+    if (unis[i].amount == 1) {
+      /* If amount is 1 we assume it's texture if not - array of floats */
+      glUniform1i(location, t++);
+    } else {
+      glUniform1fv(location, unis[i].amount, (float*)unis[i].thing);
+    }
+  }
+
+  return shader;
+}
+
+void rf_use_shader_program (GLenum tt, GLuint shader, RFUniform *unis)
+{
+  glUseProgram(shader);
+  int t = 0;
+  for (int i = 0; unis[i].name != NULL; i++) {
+    /* if amount != 1 it's not a texture but an array */
+    if (unis[i].amount != 1)
+      continue;
+    
+    glActiveTexture(GL_TEXTURE0 + t);
+    glBindTexture(tt, unis[i].thing);
+    t++;
+  }  
+}
+
+void rf_draw_to_target_buffer (GLuint vao)
+{
+  glBindVertexArray(vao);
+  glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+}
+
+/* R32F needs GL_FLOAT as the type, GL_HALF_FLOAT is only valid for R16F.
+ * The 8 bit ones are for the output planes. */
+void rf_framebuffer_texture (GLenum format, int width, int height)
+{
+  GLenum type;
+
+  GLenum components = GL_RED;
+
+  if (format == GL_RGB || format == GL_R8 || format == GL_RG8)
+    type = GL_UNSIGNED_BYTE;
+  else if (format == GL_R32F)
+    type = GL_FLOAT;
+  else
+    type = GL_HALF_FLOAT;
+
+  if (format == GL_RGB)
+    components = GL_RGB;
+  else if (format == GL_RG8)
+    components = GL_RG;
+
+  glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0,
+      components, type, NULL);
+
+  /* only texelFetch () reads the float planes, and R32F is not filterable
+   * everywhere */
+  GLint filter = format == GL_R32F ? GL_NEAREST : GL_LINEAR;
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+}
+
+RFFb rf_make_framebuffer (GLenum format, int width, int height)
+{
+  RFFb ret;
+
+  glGenFramebuffers(1, &ret.framebuffer);
+  glGenTextures(1, &ret.texture);
+  glBindFramebuffer(GL_FRAMEBUFFER, ret.framebuffer);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, ret.texture);
+  
+  rf_framebuffer_texture (format, width, height);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+      ret.texture, 0);
+
+  /* an offscreen context may have no default framebuffer at all, so this is
+   * the one to check */
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    fprintf (stderr, "Framebuffer of %dx%d %x incomplete: %x\n", width,
+        height, format, status);
+    glDeleteFramebuffers(1, &ret.framebuffer);
+    glDeleteTextures(1, &ret.texture);
+    return (RFFb) { 0 };
+  }
+
+  return ret;
+}
+
+/* One framebuffer with @n render targets of the same format, the textures go
+ * to @textures, the first one is also returned in the RFFb. */
+RFFb rf_make_framebuffer_mrt (GLenum format, int width, int height,
+    GLuint *textures, int n)
+{
+  static const GLenum attachments[] = {
+    GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1,
+    GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3
+  };
+  RFFb ret;
+
+  glGenFramebuffers(1, &ret.framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, ret.framebuffer);
+  glGenTextures(n, textures);
+  glActiveTexture(GL_TEXTURE0);
+  for (int i = 0; i < n; i++) {
+    glBindTexture(GL_TEXTURE_2D, textures[i]);
+    rf_framebuffer_texture (format, width, height);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, attachments[i], GL_TEXTURE_2D,
+        textures[i], 0);
+  }
+  glDrawBuffers(n, attachments);
+
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    fprintf (stderr, "Framebuffer of %d %dx%d %x incomplete: %x\n", n, width,
+        height, format, status);
+    glDeleteFramebuffers(1, &ret.framebuffer);
+    glDeleteTextures(n, textures);
+    memset (textures, 0, n * sizeof (GLuint));
+    return (RFFb) { 0 };
+  }
+
+  ret.texture = textures[0];
+  return ret;
+}
+
+
+int rf_gl_decoder_init (RFGLDecoder *dec, int width, int height,
+    GLenum dequant_format, const GLuint input[3])
+{
+  static const char *idct_names[3] = { "dctInpY", "dctInpU", "dctInpV" };
+
+  memset (dec, 0, sizeof (*dec));
+  dec->width = width;
+  dec->height = height;
+  dec->dequant_format = dequant_format;
+
+  for (int c = 0; c < 3; c++) {
+    for (int k = 0; k < 64; k++)
+      dec->tables[c][k] = 1.0f;
+  }
+
+  if (input) {
+    memcpy (dec->input, input, sizeof (dec->input));
+  } else {
+    dec->own_input = 1;
+    for (int c = 0; c < 3; c++) {
+      dec->input[c] = rf_create_texture (NULL, width, height);
+      if (!dec->input[c])
+        goto failed;
+    }
+  }
+
+  /* We create 3 programs of the same source, but the benefit is that we
+   * don't have to reset the uniforms for each plane. */
+  for (int c = 0; c < 3; c++) {
+    dec->dequant_unis[c][0] = (RFUniform) { "zigzagInpP", dec->input[c], 1 };
+    dec->dequant_unis[c][1] =
+        (RFUniform) { "qTable", (uint64_t) dec->tables[c], 64 };
+    dec->dequant_unis[c][2] = (RFUniform) { NULL };
+
+    dec->dequant_program[c] = rf_create_shader_program (vertexPassThrough,
+        zigzagToDCT, dec->dequant_unis[c]);
+    dec->dequant[c] = rf_make_framebuffer (dequant_format, width, height);
+    if (!dec->dequant_program[c] || !dec->dequant[c].framebuffer)
+      goto failed;
+
+    dec->idct_unis[c] = (RFUniform) { idct_names[c], dec->dequant[c].texture,
+      1 };
+  }
+  dec->idct_unis[3] = (RFUniform) { NULL };
+
+  dec->idct_program = rf_create_shader_program (vertexPassThrough,
+      fragmentIDCTtoRGB, dec->idct_unis);
+  dec->luma_program = rf_create_shader_program (vertexPassThrough,
+      fragmentIDCTtoLuma, dec->idct_unis);
+  dec->chroma_program = rf_create_shader_program (vertexPassThrough,
+      fragmentIDCTtoChroma420, &dec->idct_unis[1]);
+  dec->vao = rf_gen_target_buffer ();
+  if (!dec->idct_program || !dec->luma_program || !dec->chroma_program)
+    goto failed;
+
+  return 0;
+
+failed:
+  rf_gl_decoder_clear (dec);
+  return -1;
+}
+
+void rf_gl_decoder_clear (RFGLDecoder *dec)
+{
+  for (int c = 0; c < 3; c++) {
+    glDeleteProgram (dec->dequant_program[c]);
+    glDeleteFramebuffers (1, &dec->dequant[c].framebuffer);
+    glDeleteTextures (1, &dec->dequant[c].texture);
+  }
+  if (dec->own_input)
+    glDeleteTextures (3, dec->input);
+
+  glDeleteProgram (dec->idct_program);
+  glDeleteProgram (dec->luma_program);
+  glDeleteProgram (dec->chroma_program);
+  glDeleteVertexArrays (1, &dec->vao);
+  if (dec->target)
+    glDeleteFramebuffers (1, &dec->target);
+}
+
+void rf_gl_decoder_set_tables (RFGLDecoder *dec, const float *tables[3])
+{
+  for (int c = 0; c < 3; c++) {
+    if (!memcmp (dec->tables[c], tables[c], sizeof (dec->tables[c])))
+      continue;
+
+    memcpy (dec->tables[c], tables[c], sizeof (dec->tables[c]));
+    glUseProgram (dec->dequant_program[c]);
+    glUniform1fv (glGetUniformLocation (dec->dequant_program[c], "qTable"),
+        64, dec->tables[c]);
+  }
+}
+
+void rf_gl_decoder_upload (RFGLDecoder *dec, int component,
+    const float *plane)
+{
+  rf_update_texture (dec->input[component], plane, dec->width, dec->height);
+}
+
+/* zigzag --> dct, plane by plane */
+static void rf_gl_decoder_dequant (RFGLDecoder *dec)
+{
+  /* The passes work per texel, they have to cover the whole planes */
+  glViewport(0, 0, dec->width, dec->height);
+
+  for (int c = 0; c < 3; c++) {
+    glBindFramebuffer(GL_FRAMEBUFFER, dec->dequant[c].framebuffer);
+    glClear(GL_COLOR_BUFFER_BIT);
+    rf_use_shader_program (GL_TEXTURE_2D, dec->dequant_program[c],
+        dec->dequant_unis[c]);
+    rf_draw_to_target_buffer (dec->vao);
+  }
+}
+
+void rf_gl_decoder_run (RFGLDecoder *dec, GLuint output)
+{
+  rf_gl_decoder_dequant (dec);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, output);
+  rf_use_shader_program (GL_TEXTURE_2D, dec->idct_program, dec->idct_unis);
+  rf_draw_to_target_buffer (dec->vao);
+}
+
+void rf_gl_decoder_run_to_texture (RFGLDecoder *dec, GLuint texture)
+{
+  if (!dec->target)
+    glGenFramebuffers (1, &dec->target);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, dec->target);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+      texture, 0);
+
+  rf_gl_decoder_run (dec, dec->target);
+
+  /* the context is shared with the others, leave it as we found it */
+  glBindVertexArray(0);
+  glUseProgram(0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void rf_gl_decoder_run_yuv (RFGLDecoder *dec, RFGLOutput output,
+    const GLuint planes[3])
+{
+  static const GLenum attachments[] = {
+    GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1
+  };
+  int i420 = output == RF_GL_OUTPUT_I420;
+
+  rf_gl_decoder_dequant (dec);
+
+  if (!dec->target)
+    glGenFramebuffers (1, &dec->target);
+  glBindFramebuffer(GL_FRAMEBUFFER, dec->target);
+
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+      planes[0], 0);
+  rf_use_shader_program (GL_TEXTURE_2D, dec->luma_program, dec->idct_unis);
+  rf_draw_to_target_buffer (dec->vao);
+
+  /* a pixel of the chroma pass is 2x2 of the picture */
+  glViewport(0, 0, dec->width / 2, dec->height / 2);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+      planes[1], 0);
+  if (i420) {
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1,
+        GL_TEXTURE_2D, planes[2], 0);
+    glDrawBuffers(2, attachments);
+  }
+  rf_use_shader_program (GL_TEXTURE_2D, dec->chroma_program,
+      &dec->idct_unis[1]);
+  rf_draw_to_target_buffer (dec->vao);
+
+  if (i420) {
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1,
+        GL_TEXTURE_2D, 0, 0);
+    glDrawBuffers(1, attachments);
+  }
+
+  glBindVertexArray(0);
+  glUseProgram(0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ */
+
+/* GL side of the decoder, shared by the jpegdec_shader app and the
+ * glshaderjpegdec GStreamer element.
+ *
+ * Everything here wants a current context, GL 4.3 or GLES 3.0 with
+ * EXT_color_buffer_float for the float render targets. The app gets the
+ * entry points from GLEW, the element defines RF_GL_GLES and links to
+ * libGLESv2.
+ *
+ * Nothing here exits: the element runs in somebody else's process. What
+ * can't be made gives 0, or -1 for the functions returning int, and the
+ * GL logs go to stderr. */
+
+#ifndef RF_GL_H
+#define RF_GL_H
+
+#ifdef RF_GL_GLES
+#include <GLES3/gl3.h>
+#else
+#include <GL/glew.h>
+#endif
+#include <stdint.h>
+
+extern const char *vertexPassThrough;
+extern const char *fragmentPassThrough;
+extern const char *zigzagToDCT;
+extern const char *fragmentIDCTtoRGB;
+extern const char *fragmentIDCTtoLuma;
+extern const char *fragmentIDCTtoChroma420;
+
+typedef enum {
+  RF_GL_OUTPUT_RGB,
+  /* Y and interleaved UV at half the size each way */
+  RF_GL_OUTPUT_NV12,
+  /* Y, U and V, the chroma ones at half the size each way */
+  RF_GL_OUTPUT_I420
+} RFGLOutput;
+
+typedef struct {
+  const char *name;
+  uint64_t thing;
+  int amount;
+} RFUniform;
+
+typedef struct {
+  GLuint framebuffer, texture;
+} RFFb;
+
+GLuint rf_create_texture_format (GLenum internal, GLenum format,
+    const float *data, int width, int height);
+GLuint rf_create_texture (const float *data, int width, int height);
+void rf_update_texture (GLuint tex, const float *data, int width, int height);
+
+/* Prints the info log of a shader or a program */
+void rf_shader_error (GLuint shader);
+GLuint rf_compile_shader (GLenum type, const char *src);
+GLuint rf_create_shader_program (const char *vertex, const char *fragment,
+    RFUniform *unis);
+void rf_use_shader_program (GLenum tt, GLuint shader, RFUniform *unis);
+
+GLuint rf_gen_target_buffer (void);
+void rf_draw_to_target_buffer (GLuint vao);
+
+/* Storage for the texture bound to GL_TEXTURE_2D */
+void rf_framebuffer_texture (GLenum format, int width, int height);
+/* All zeroes if the framebuffer is incomplete */
+RFFb rf_make_framebuffer (GLenum format, int width, int height);
+RFFb rf_make_framebuffer_mrt (GLenum format, int width, int height,
+    GLuint *textures, int n);
+
+/* The passes from the zigzag coefficient planes to the picture: dequant of
+ * each plane to @dequant_format, then IDCT and the color conversion into
+ * whatever framebuffer the caller gives. */
+typedef struct {
+  /* of the planes */
+  int width, height;
+  GLenum dequant_format;
+  /* zigzag coefficients, R32F */
+  GLuint input[3];
+  int own_input;
+  float tables[3][64];
+  RFUniform dequant_unis[3][3];
+  GLuint dequant_program[3];
+  RFFb dequant[3];
+  RFUniform idct_unis[4];
+  GLuint idct_program;
+  /* of the YUV output, full range and with no color conversion at all */
+  GLuint luma_program, chroma_program;
+  GLuint vao;
+  /* for rf_gl_decoder_run_to_texture () */
+  GLuint target;
+} RFGLDecoder;
+
+/* With @input NULL the decoder makes its own input textures, to be filled
+ * with rf_gl_decoder_upload (). Otherwise they are the caller's, e.g. the
+ * output of the GPU encoder. Tables start as all ones. On failure nothing
+ * is left to clear. */
+int rf_gl_decoder_init (RFGLDecoder *dec, int width, int height,
+    GLenum dequant_format, const GLuint input[3]);
+void rf_gl_decoder_clear (RFGLDecoder *dec);
+
+/* Quantization tables, natural order */
+void rf_gl_decoder_set_tables (RFGLDecoder *dec, const float *tables[3]);
+void rf_gl_decoder_upload (RFGLDecoder *dec, int component,
+    const float *plane);
+
+/* Renders into @output with the viewport of the planes, and leaves it
+ * bound. Only the part that fits the @output attachments is written, so it
+ * can be of the picture size rather than of the planes. */
+void rf_gl_decoder_run (RFGLDecoder *dec, GLuint output);
+
+/* Same into an RGBA8 texture of somebody else, leaves the default
+ * framebuffer bound */
+void rf_gl_decoder_run_to_texture (RFGLDecoder *dec, GLuint texture);
+
+/* The YUV output modes into the textures of the planes: R8 for Y, RG8 for
+ * the UV of NV12, R8 for U and V of I420. Leaves the default framebuffer
+ * bound. */
+void rf_gl_decoder_run_yuv (RFGLDecoder *dec, RFGLOutput output,
+    const GLuint planes[3]);
+
+#endif
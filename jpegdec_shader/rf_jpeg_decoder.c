@@ -0,0 +1,723 @@
+/*
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ */
+
+#include "rf_jpeg_decoder.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RF_HUFF_LOOKAHEAD 9
+
+/* What a GL texture can be on most drivers. Bigger frames are refused
+ * before their planes are allocated, a SOF may ask for 8 GB of them. */
+#define RF_JPEG_MAX_DIMENSION 16384
+
+/* Natural position of each zigzag index, for the DQT */
+static const int zigzag_order[64] = {
+   0,  1,  8, 16,  9,  2,  3, 10,
+  17, 24, 32, 25, 18, 11,  4,  5,
+  12, 19, 26, 33, 40, 48, 41, 34,
+  27, 20, 13,  6,  7, 14, 21, 28,
+  35, 42, 49, 56, 57, 50, 43, 36,
+  29, 22, 15, 23, 30, 37, 44, 51,
+  58, 59, 52, 45, 38, 31, 39, 46,
+  53, 60, 61, 54, 47, 55, 62, 63
+};
+
+typedef struct {
+  int present;
+  uint8_t vals[256];
+  int maxcode[18];
+  int valptr[17];
+  int mincode[17];
+  /* (length << 8) | value for the codes that fit the lookahead, 0 if not */
+  uint16_t look[1 << RF_HUFF_LOOKAHEAD];
+} RFHuffDec;
+
+typedef struct {
+  int id, h, v, tq;
+  /* of the current scan */
+  int td, ta;
+  int dc_pred;
+  int16_t *coefs;
+} RFJpegComponent;
+
+typedef struct {
+  const uint8_t *p, *end;
+  uint64_t acc;
+  int bits;
+} RFBitReader;
+
+struct _RFJpegDecoder {
+  uint8_t *data;
+  size_t size, alloc, pos;
+
+  int started, have_frame, subsampled, header_reported;
+  RFJpegFrame frame;
+  RFJpegComponent comps[3];
+  uint16_t qt[4][64];           /* zigzag order, as in the DQT */
+  RFHuffDec huff[2][4];         /* [DC, AC][id] */
+  int restart_interval;
+  int eobrun;
+  /* a DC went out of the range of a coefficient, the scan is corrupt */
+  int dc_overflow;
+};
+
+RFJpegDecoder *
+rf_jpeg_decoder_new (void)
+{
+  return calloc (1, sizeof (RFJpegDecoder));
+}
+
+void
+rf_jpeg_decoder_free (RFJpegDecoder * dec)
+{
+  for (int c = 0; c < 3; c++)
+    free (dec->comps[c].coefs);
+  free (dec->data);
+  free (dec);
+}
+
+int
+rf_jpeg_decoder_push (RFJpegDecoder * dec, const uint8_t * data, size_t size)
+{
+  if (dec->size + size > dec->alloc) {
+    uint8_t *grown = realloc (dec->data, (dec->size + size) * 2);
+
+    if (!grown)
+      return -1;
+    dec->data = grown;
+    dec->alloc = (dec->size + size) * 2;
+  }
+
+  memcpy (dec->data + dec->size, data, size);
+  dec->size += size;
+  return 0;
+}
+
+size_t
+rf_jpeg_decoder_position (RFJpegDecoder * dec)
+{
+  return dec->pos;
+}
+
+const RFJpegFrame *
+rf_jpeg_decoder_frame (RFJpegDecoder * dec)
+{
+  return dec->have_frame || dec->subsampled ? &dec->frame : NULL;
+}
+
+void
+rf_jpeg_decoder_get_plane (RFJpegDecoder * dec, int component, float *out)
+{
+  size_t n = (size_t) dec->frame.plane_width * dec->frame.plane_height;
+  const int16_t *in = dec->comps[component].coefs;
+
+  if (component >= dec->frame.components) {
+    memset (out, 0, n * sizeof (float));
+    return;
+  }
+
+  for (size_t i = 0; i < n; i++)
+    out[i] = in[i];
+}
+
+void
+rf_jpeg_decoder_get_table (RFJpegDecoder * dec, int component, float table[64])
+{
+  if (component >= dec->frame.components)
+    component = 0;
+
+  for (int k = 0; k < 64; k++)
+    table[zigzag_order[k]] = dec->qt[dec->comps[component].tq][k];
+}
+
+/* Annex C and F.2.2.3 */
+static void
+rf_huff_dec_build (RFHuffDec * t, const uint8_t bits[16], const uint8_t * vals)
+{
+  int code = 0, k = 0;
+
+  memset (t->look, 0, sizeof (t->look));
+
+  for (int len = 1; len <= 16; len++) {
+    int n = bits[len - 1];
+
+    t->valptr[len] = k;
+    t->mincode[len] = code;
+    t->maxcode[len] = n ? code + n - 1 : -1;
+
+    for (int i = 0; i < n; i++, k++, code++) {
+      t->vals[k] = vals[k];
+
+      if (len <= RF_HUFF_LOOKAHEAD) {
+        int shift = RF_HUFF_LOOKAHEAD - len;
+
+        for (int l = 0; l < (1 << shift); l++)
+          t->look[(code << shift) | l] = (len << 8) | vals[k];
+      }
+    }
+    code <<= 1;
+  }
+  t->maxcode[17] = 0x7fffffff;
+  t->present = 1;
+}
+
+/* Stuffed zeroes are dropped. On a marker the reader stops, and feeds zeroes
+ * from there on. */
+static inline void
+rf_br_fill (RFBitReader * br)
+{
+  while (br->bits <= 56) {
+    unsigned b = 0;
+
+    if (br->p < br->end) {
+      b = *br->p;
+
+      if (b == 0xff) {
+        if (br->p + 1 < br->end && br->p[1] == 0x00) {
+          br->p += 2;
+        } else {
+          b = 0;
+          br->end = br->p;
+        }
+      } else {
+        br->p++;
+      }
+    }
+
+    br->acc |= (uint64_t) b << (56 - br->bits);
+    br->bits += 8;
+  }
+}
+
+static inline int
+rf_br_get (RFBitReader * br, int n)
+{
+  int v;
+
+  if (n == 0)
+    return 0;
+
+  if (br->bits < n)
+    rf_br_fill (br);
+
+  v = br->acc >> (64 - n);
+  br->acc <<= n;
+  br->bits -= n;
+  return v;
+}
+
+/* F.2.2.1, the sign of the value is in its first bit */
+static inline int
+rf_extend (int v, int s)
+{
+  return v < (1 << (s - 1)) ? v - (1 << s) + 1 : v;
+}
+
+static inline int
+rf_huff_decode (RFBitReader * br, const RFHuffDec * t)
+{
+  int e, len;
+
+  if (br->bits < 16)
+    rf_br_fill (br);
+
+  e = t->look[br->acc >> (64 - RF_HUFF_LOOKAHEAD)];
+  if (e) {
+    br->acc <<= e >> 8;
+    br->bits -= e >> 8;
+    return e & 0xff;
+  }
+
+  for (len = RF_HUFF_LOOKAHEAD + 1; len <= 16; len++) {
+    int code = br->acc >> (64 - len);
+
+    if (code <= t->maxcode[len]) {
+      br->acc <<= len;
+      br->bits -= len;
+      return t->vals[t->valptr[len] + code - t->mincode[len]];
+    }
+  }
+
+  /* corrupt data, keep going with zeroes */
+  return 0;
+}
+
+/* s is at most 11, rf_parse_dht () sees to it. A predictor out of the range
+ * of a coefficient is a corrupt stream, and would overflow further on. */
+static void
+rf_decode_dc_diff (RFBitReader * br, RFJpegDecoder * dec,
+    RFJpegComponent * c)
+{
+  int s = rf_huff_decode (br, &dec->huff[0][c->td]);
+
+  if (!s)
+    return;
+
+  c->dc_pred += rf_extend (rf_br_get (br, s), s);
+  if (c->dc_pred < INT16_MIN || c->dc_pred > INT16_MAX) {
+    c->dc_pred = 0;
+    dec->dc_overflow = 1;
+  }
+}
+
+static void
+rf_decode_block_baseline (RFBitReader * br, RFJpegDecoder * dec,
+    RFJpegComponent * c, int16_t * blk)
+{
+  const RFHuffDec *ac = &dec->huff[1][c->ta];
+  int s;
+
+  rf_decode_dc_diff (br, dec, c);
+  blk[0] = c->dc_pred;
+
+  for (int k = 1; k < 64; k++) {
+    int rs = rf_huff_decode (br, ac);
+    int r = rs >> 4;
+
+    s = rs & 15;
+    if (s) {
+      k += r;
+      if (k > 63)
+        break;
+      blk[k] = rf_extend (rf_br_get (br, s), s);
+    } else {
+      if (r != 15)
+        break;
+      k += 15;
+    }
+  }
+}
+
+/* G.1.2.1 */
+static void
+rf_decode_dc_first (RFBitReader * br, RFJpegDecoder * dec,
+    RFJpegComponent * c, int16_t * blk, int al)
+{
+  rf_decode_dc_diff (br, dec, c);
+  blk[0] = c->dc_pred * (1 << al);
+}
+
+static void
+rf_decode_dc_refine (RFBitReader * br, int16_t * blk, int al)
+{
+  if (rf_br_get (br, 1))
+    blk[0] |= 1 << al;
+}
+
+static void
+rf_decode_ac_first (RFBitReader * br, RFJpegDecoder * dec,
+    RFJpegComponent * c, int16_t * blk, int ss, int se, int al)
+{
+  const RFHuffDec *ac = &dec->huff[1][c->ta];
+
+  if (dec->eobrun > 0) {
+    dec->eobrun--;
+    return;
+  }
+
+  for (int k = ss; k <= se; k++) {
+    int rs = rf_huff_decode (br, ac);
+    int r = rs >> 4, s = rs & 15;
+
+    if (s) {
+      k += r;
+      if (k > 63)
+        break;
+      blk[k] = rf_extend (rf_br_get (br, s), s) * (1 << al);
+    } else {
+      if (r < 15) {
+        /* EOBr: this band and the next 2^r - 1 + bits ones are over */
+        dec->eobrun = (1 << r) - 1;
+        if (r)
+          dec->eobrun += rf_br_get (br, r);
+        break;
+      }
+      k += 15;
+    }
+  }
+}
+
+/* G.1.2.3, the way libjpeg does it: nonzero coefficients on the way get a
+ * correction bit, new ones land on the r-th zero. */
+static void
+rf_decode_ac_refine (RFBitReader * br, RFJpegDecoder * dec,
+    RFJpegComponent * c, int16_t * blk, int ss, int se, int al)
+{
+  const RFHuffDec *ac = &dec->huff[1][c->ta];
+  int p1 = 1 << al, m1 = -1 * (1 << al);
+  int k = ss;
+
+  if (dec->eobrun == 0) {
+    for (; k <= se; k++) {
+      int rs = rf_huff_decode (br, ac);
+      int r = rs >> 4, s = rs & 15;
+
+      if (s) {
+        /* s is always 1 here */
+        s = rf_br_get (br, 1) ? p1 : m1;
+      } else if (r != 15) {
+        dec->eobrun = 1 << r;
+        if (r)
+          dec->eobrun += rf_br_get (br, r);
+        break;
+      }
+
+      do {
+        int16_t *coef = &blk[k];
+
+        if (*coef != 0) {
+          if (rf_br_get (br, 1) && (*coef & p1) == 0)
+            *coef += *coef >= 0 ? p1 : m1;
+        } else if (--r < 0) {
+          break;
+        }
+        k++;
+      } while (k <= se);
+
+      if (s && k <= 63)
+        blk[k] = s;
+    }
+  }
+
+  if (dec->eobrun > 0) {
+    for (; k <= se; k++) {
+      int16_t *coef = &blk[k];
+
+      if (*coef != 0 && rf_br_get (br, 1) && (*coef & p1) == 0)
+        *coef += *coef >= 0 ? p1 : m1;
+    }
+    dec->eobrun--;
+  }
+}
+
+static inline int
+rf_read16 (const uint8_t * p)
+{
+  return (p[0] << 8) | p[1];
+}
+
+/* Where the entropy coded data of the scan ends: the first marker that is
+ * not RSTn. 0 if it's not there yet. */
+static size_t
+rf_find_scan_end (RFJpegDecoder * dec, size_t pos)
+{
+  for (; pos + 1 < dec->size; pos++) {
+    uint8_t m;
+
+    if (dec->data[pos] != 0xff)
+      continue;
+
+    m = dec->data[pos + 1];
+    if (m != 0x00 && m != 0xff && (m < 0xd0 || m > 0xd7))
+      return pos;
+  }
+
+  return 0;
+}
+
+static RFJpegStatus
+rf_parse_sof (RFJpegDecoder * dec, const uint8_t * p, int len, int marker)
+{
+  RFJpegFrame *f = &dec->frame;
+
+  if (dec->have_frame || len < 6 || p[0] != 8)
+    return RF_JPEG_ERROR;
+
+  f->height = rf_read16 (p + 1);
+  f->width = rf_read16 (p + 3);
+  f->components = p[5];
+  f->progressive = marker == 0xc2;
+
+  if (f->width == 0 || f->height == 0 ||
+      f->width > RF_JPEG_MAX_DIMENSION || f->height > RF_JPEG_MAX_DIMENSION ||
+      (f->components != 1 && f->components != 3) ||
+      len < 6 + f->components * 3)
+    return RF_JPEG_ERROR;
+
+  f->plane_width = (f->width + 63) / 64 * 64;
+  f->plane_height = (f->height + 7) / 8 * 8;
+
+  for (int c = 0; c < f->components; c++) {
+    RFJpegComponent *comp = &dec->comps[c];
+    const uint8_t *cp = p + 6 + c * 3;
+
+    comp->id = cp[0];
+    comp->h = cp[1] >> 4;
+    comp->v = cp[1] & 15;
+    comp->tq = cp[2] & 3;
+    f->h[c] = comp->h;
+    f->v[c] = comp->v;
+
+    if (comp->h < 1 || comp->h > 4 || comp->v < 1 || comp->v > 4)
+      return RF_JPEG_ERROR;
+  }
+
+  /* planes of different sizes are not for the shaders */
+  for (int c = 0; c < f->components; c++) {
+    if (f->components > 1 && (f->h[c] != 1 || f->v[c] != 1)) {
+      dec->subsampled = 1;
+      return RF_JPEG_UNSUPPORTED;
+    }
+  }
+
+  for (int c = 0; c < 3; c++) {
+    dec->comps[c].coefs = calloc ((size_t) f->plane_width * f->plane_height,
+        sizeof (int16_t));
+    if (!dec->comps[c].coefs)
+      return RF_JPEG_ERROR;
+  }
+
+  dec->have_frame = 1;
+  return RF_JPEG_HEADER;
+}
+
+static RFJpegStatus
+rf_parse_dqt (RFJpegDecoder * dec, const uint8_t * p, int len)
+{
+  while (len > 0) {
+    int pq = p[0] >> 4, tq = p[0] & 3;
+    int size = 1 + 64 * (pq ? 2 : 1);
+
+    if (len < size)
+      return RF_JPEG_ERROR;
+
+    for (int k = 0; k < 64; k++)
+      dec->qt[tq][k] = pq ? rf_read16 (p + 1 + k * 2) : p[1 + k];
+
+    p += size;
+    len -= size;
+  }
+
+  return RF_JPEG_NEED_DATA;
+}
+
+static RFJpegStatus
+rf_parse_dht (RFJpegDecoder * dec, const uint8_t * p, int len)
+{
+  while (len > 17) {
+    int tc = p[0] >> 4, th = p[0] & 3;
+    int n = 0, code = 0;
+
+    /* the codes of each length have to fit in it, or the lookup table of
+     * rf_huff_dec_build () overflows */
+    for (int i = 0; i < 16; i++) {
+      n += p[1 + i];
+      code += p[1 + i];
+      if (code > 1 << (i + 1))
+        return RF_JPEG_ERROR;
+      code <<= 1;
+    }
+
+    if (tc > 1 || n > 256 || len < 17 + n)
+      return RF_JPEG_ERROR;
+
+    /* F.1.2.1.1 and F.1.2.2.1: of 8 bit samples a DC difference has at most
+     * 11 bits, the size of an AC one is the low nibble */
+    for (int i = 0; i < n && tc == 0; i++) {
+      if (p[17 + i] > 11)
+        return RF_JPEG_ERROR;
+    }
+
+    rf_huff_dec_build (&dec->huff[tc][th], p + 1, p + 17);
+    p += 17 + n;
+    len -= 17 + n;
+  }
+
+  return RF_JPEG_NEED_DATA;
+}
+
+/* Decodes the whole scan, [p, end) is its entropy coded data */
+static RFJpegStatus
+rf_decode_scan (RFJpegDecoder * dec, const uint8_t * hdr, int len,
+    const uint8_t * p, const uint8_t * end, int *updated)
+{
+  RFJpegFrame *f = &dec->frame;
+  RFJpegComponent *scomps[3];
+  int ns, ss, se, ah, al;
+  int bw = (f->width + 7) / 8, bh = (f->height + 7) / 8;
+  int bpl = f->plane_width / 8;
+  int mcus = bw * bh, restarts = 0;
+  RFBitReader br = { p, end, 0, 0 };
+
+  if (len < 1)
+    return RF_JPEG_ERROR;
+
+  ns = hdr[0];
+  if (!dec->have_frame || ns < 1 || ns > f->components || len < 4 + ns * 2)
+    return RF_JPEG_ERROR;
+
+  *updated = 0;
+  for (int i = 0; i < ns; i++) {
+    int id = hdr[1 + i * 2], c;
+
+    for (c = 0; c < f->components; c++) {
+      if (dec->comps[c].id == id)
+        break;
+    }
+    if (c == f->components)
+      return RF_JPEG_ERROR;
+
+    scomps[i] = &dec->comps[c];
+    scomps[i]->td = hdr[2 + i * 2] >> 4 & 3;
+    scomps[i]->ta = hdr[2 + i * 2] & 3;
+    scomps[i]->dc_pred = 0;
+    *updated |= 1 << c;
+  }
+
+  ss = hdr[1 + ns * 2];
+  se = hdr[2 + ns * 2];
+  ah = hdr[3 + ns * 2] >> 4;
+  al = hdr[3 + ns * 2] & 15;
+  dec->eobrun = 0;
+  dec->dc_overflow = 0;
+
+  if (ss > se || se > 63 || (f->progressive && ss > 0 && ns != 1))
+    return RF_JPEG_ERROR;
+
+  for (int i = 0; i < ns; i++) {
+    int need_dc = !f->progressive || (ss == 0 && ah == 0);
+    int need_ac = !f->progressive || ss > 0;
+
+    if ((need_dc && !dec->huff[0][scomps[i]->td].present) ||
+        (need_ac && !dec->huff[1][scomps[i]->ta].present))
+      return RF_JPEG_ERROR;
+  }
+
+  /* With all the sampling factors 1 an MCU is one block of each component
+   * of the scan, whether it's interleaved or not. */
+  for (int m = 0; m < mcus; m++) {
+    int16_t *blk;
+
+    if (dec->restart_interval && m > 0 && m % dec->restart_interval == 0) {
+      /* the reader may or may not have got to the RSTn yet, whatever is
+       * left before it is padding */
+      while (br.p + 1 < end &&
+          !(br.p[0] == 0xff && (br.p[1] & 0xf8) == 0xd0))
+        br.p++;
+      if (br.p + 1 < end)
+        br.p += 2;
+      br.end = end;
+      br.acc = 0;
+      br.bits = 0;
+      dec->eobrun = 0;
+      for (int i = 0; i < ns; i++)
+        scomps[i]->dc_pred = 0;
+      restarts++;
+    }
+
+    for (int i = 0; i < ns; i++) {
+      blk = scomps[i]->coefs + ((m / bw) * bpl + (m % bw)) * 64;
+
+      if (!f->progressive)
+        rf_decode_block_baseline (&br, dec, scomps[i], blk);
+      else if (ss == 0 && ah == 0)
+        rf_decode_dc_first (&br, dec, scomps[i], blk, al);
+      else if (ss == 0)
+        rf_decode_dc_refine (&br, blk, al);
+      else if (ah == 0)
+        rf_decode_ac_first (&br, dec, scomps[i], blk, ss, se, al);
+      else
+        rf_decode_ac_refine (&br, dec, scomps[i], blk, ss, se, al);
+    }
+
+    if (dec->dc_overflow)
+      return RF_JPEG_ERROR;
+  }
+
+  return RF_JPEG_SCAN;
+}
+
+RFJpegStatus
+rf_jpeg_decoder_decode (RFJpegDecoder * dec, int *updated)
+{
+  if (!dec->started) {
+    if (dec->size < 2)
+      return RF_JPEG_NEED_DATA;
+    if (dec->data[0] != 0xff || dec->data[1] != 0xd8)
+      return RF_JPEG_ERROR;
+    dec->pos = 2;
+    dec->started = 1;
+  }
+
+  for (;;) {
+    size_t pos = dec->pos;
+    const uint8_t *seg;
+    int marker, len;
+    RFJpegStatus ret = RF_JPEG_NEED_DATA;
+
+    /* fill bytes before the marker are fine */
+    while (pos < dec->size && dec->data[pos] == 0xff && pos + 1 < dec->size &&
+        dec->data[pos + 1] == 0xff)
+      pos++;
+
+    if (pos + 2 > dec->size)
+      return RF_JPEG_NEED_DATA;
+    if (dec->data[pos] != 0xff)
+      return RF_JPEG_ERROR;
+
+    marker = dec->data[pos + 1];
+    if (marker == 0xd9) {
+      dec->pos = pos + 2;
+      return RF_JPEG_DONE;
+    }
+
+    if (pos + 4 > dec->size)
+      return RF_JPEG_NEED_DATA;
+    len = rf_read16 (dec->data + pos + 2);
+    if (len < 2)
+      return RF_JPEG_ERROR;
+    if (pos + 2 + len > dec->size)
+      return RF_JPEG_NEED_DATA;
+
+    seg = dec->data + pos + 4;
+    len -= 2;
+
+    switch (marker) {
+      case 0xc0:
+      case 0xc1:
+      case 0xc2:
+        ret = rf_parse_sof (dec, seg, len, marker);
+        break;
+      case 0xc4:
+        ret = rf_parse_dht (dec, seg, len);
+        break;
+      case 0xdb:
+        ret = rf_parse_dqt (dec, seg, len);
+        break;
+      case 0xdd:
+        if (len < 2)
+          return RF_JPEG_ERROR;
+        dec->restart_interval = rf_read16 (seg);
+        break;
+      case 0xda:{
+        size_t start = pos + 4 + len;
+        size_t end = rf_find_scan_end (dec, start);
+
+        /* only whole scans are decoded */
+        if (!end)
+          return RF_JPEG_NEED_DATA;
+
+        ret = rf_decode_scan (dec, seg, len, dec->data + start,
+            dec->data + end, updated);
+        if (ret == RF_JPEG_SCAN)
+          dec->pos = end;
+        return ret;
+      }
+      default:
+        /* lossless, arithmetic and hierarchical ones are not for us */
+        if (marker >= 0xc3 && marker <= 0xcf)
+          return RF_JPEG_ERROR;
+        /* APPn, COM and so on */
+        break;
+    }
+
+    if (ret == RF_JPEG_ERROR || ret == RF_JPEG_UNSUPPORTED)
+      return ret;
+
+    dec->pos = pos + 2 + len + 2;
+    if (ret == RF_JPEG_HEADER)
+      return ret;
+  }
+}
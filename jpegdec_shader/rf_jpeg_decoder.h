@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ */
+
+/* Entropy decoder of baseline and progressive (SOF2) JPEG files.
+ *
+ * The file may come in pieces: every rf_jpeg_decoder_decode () goes as far as
+ * the data pushed so far allows, and stops after each complete scan, so the
+ * caller can show the picture refining scan by scan.
+ *
+ * The output is the same coefficient planes rf_zigzag_that_thing () makes:
+ * quantized, zigzag order, [8x8] blocks as 64 consecutive values in the raster
+ * order of the blocks. Plane width is padded to 64, because that's what the
+ * shaders expect, padding blocks stay 0. Only 4:4:4 and grayscale are
+ * supported, as the GPU side has all the planes of the same size. */
+
+#ifndef RF_JPEG_DECODER_H
+#define RF_JPEG_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+  /* a color picture with sampling factors other than 1, usually subsampled
+   * chroma. rf_jpeg_decoder_frame () tells which. */
+  RF_JPEG_UNSUPPORTED = -2,
+  RF_JPEG_ERROR = -1,
+  RF_JPEG_NEED_DATA,
+  /* the frame header is known, planes can be allocated */
+  RF_JPEG_HEADER,
+  /* one more scan went to the planes */
+  RF_JPEG_SCAN,
+  RF_JPEG_DONE
+} RFJpegStatus;
+
+typedef struct {
+  int width, height;
+  /* of the coefficient planes */
+  int plane_width, plane_height;
+  int components;
+  int progressive;
+  /* sampling factors of the components */
+  int h[3], v[3];
+} RFJpegFrame;
+
+typedef struct _RFJpegDecoder RFJpegDecoder;
+
+RFJpegDecoder *rf_jpeg_decoder_new (void);
+void rf_jpeg_decoder_free (RFJpegDecoder *dec);
+
+/* Appends the next bytes of the file. Returns -1 if they don't fit in
+ * memory, the ones pushed before stay. */
+int rf_jpeg_decoder_push (RFJpegDecoder *dec, const uint8_t *data,
+    size_t size);
+
+/* On RF_JPEG_SCAN @updated gets a bit per component the scan touched */
+RFJpegStatus rf_jpeg_decoder_decode (RFJpegDecoder *dec, int *updated);
+
+/* Bytes of the file consumed so far */
+size_t rf_jpeg_decoder_position (RFJpegDecoder *dec);
+
+/* NULL until RF_JPEG_HEADER or RF_JPEG_UNSUPPORTED */
+const RFJpegFrame *rf_jpeg_decoder_frame (RFJpegDecoder *dec);
+
+/* Coefficients of the component as floats, plane_width * plane_height of
+ * them. Grayscale pictures give zeroes for the components 1 and 2. */
+void rf_jpeg_decoder_get_plane (RFJpegDecoder *dec, int component,
+    float *out);
+
+/* Quantization table of the component, natural order */
+void rf_jpeg_decoder_get_table (RFJpegDecoder *dec, int component,
+    float table[64]);
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ */
+
+#include "rf_plane_pool.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#define RF_HUGE_PAGE_SIZE (2 << 20)
+
+typedef struct {
+  float *plane;
+  size_t size;
+  int width, height;
+  int in_use;
+} RFPlane;
+
+struct _RFPlanePool {
+  RFPlane *planes;
+  int n, alloc;
+};
+
+RFPlanePool *
+rf_plane_pool_new (void)
+{
+  return calloc (1, sizeof (RFPlanePool));
+}
+
+void
+rf_plane_pool_free (RFPlanePool * pool)
+{
+  for (int i = 0; i < pool->n; i++)
+    munmap (pool->planes[i].plane, pool->planes[i].size);
+  free (pool->planes);
+  free (pool);
+}
+
+/* mmap gives us pages, so 64 bytes is for free. A huge page has to be aligned
+ * to its size though, so map more and cut the ends. */
+static float *
+rf_plane_map (size_t size)
+{
+  uint8_t *p, *aligned;
+  size_t head;
+
+  if (size < RF_HUGE_PAGE_SIZE) {
+    p = mmap (NULL, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? NULL : (float *) p;
+  }
+
+  p = mmap (NULL, size + RF_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED)
+    return NULL;
+
+  aligned = (uint8_t *) (((uintptr_t) p + RF_HUGE_PAGE_SIZE - 1) &
+      ~(uintptr_t) (RF_HUGE_PAGE_SIZE - 1));
+  head = aligned - p;
+  if (head)
+    munmap (p, head);
+  munmap (aligned + size, RF_HUGE_PAGE_SIZE - head);
+
+#ifdef MADV_HUGEPAGE
+  /* only a hint, with THP off it's plain pages */
+  madvise (aligned, size, MADV_HUGEPAGE);
+#endif
+
+  return (float *) aligned;
+}
+
+float *
+rf_plane_pool_acquire (RFPlanePool * pool, int width, int height)
+{
+  size_t size = (size_t) width * height * sizeof (float);
+  RFPlane *p;
+
+  for (int i = 0; i < pool->n; i++) {
+    p = &pool->planes[i];
+    if (!p->in_use && p->width == width && p->height == height) {
+      p->in_use = 1;
+      return p->plane;
+    }
+  }
+
+  /* nothing of this size is left, so it changed: the planes of the old one
+   * nobody holds would only be kept until the pool is freed */
+  for (int i = 0; i < pool->n;) {
+    p = &pool->planes[i];
+    if (p->in_use) {
+      i++;
+      continue;
+    }
+    munmap (p->plane, p->size);
+    *p = pool->planes[--pool->n];
+  }
+
+  if (size >= RF_HUGE_PAGE_SIZE)
+    size = (size + RF_HUGE_PAGE_SIZE - 1) & ~(size_t) (RF_HUGE_PAGE_SIZE - 1);
+
+  if (pool->n == pool->alloc) {
+    int alloc = pool->alloc ? pool->alloc * 2 : 16;
+    RFPlane *planes = realloc (pool->planes, alloc * sizeof (RFPlane));
+
+    if (!planes)
+      return NULL;
+    pool->planes = planes;
+    pool->alloc = alloc;
+  }
+
+  p = &pool->planes[pool->n];
+  p->plane = rf_plane_map (size);
+  if (!p->plane)
+    return NULL;
+
+  p->size = size;
+  p->width = width;
+  p->height = height;
+  p->in_use = 1;
+  pool->n++;
+
+  return p->plane;
+}
+
+void
+rf_plane_pool_release (RFPlanePool * pool, float *plane)
+{
+  for (int i = 0; i < pool->n; i++) {
+    if (pool->planes[i].plane == plane) {
+      pool->planes[i].in_use = 0;
+      return;
+    }
+  }
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ */
+
+/* Float planes that are reused instead of freed.
+ *
+ * A released plane goes back to the pool and is handed out again to the next
+ * request of the same geometry, so once every stage has got its planes a
+ * stream of frames doesn't allocate anything. A request that none of them
+ * fits unmaps the released ones first, so a stream that changes its size
+ * only keeps the planes of the sizes in use. The planes are 64-byte aligned,
+ * and the big ones are backed by huge pages where the kernel lets us. */
+
+#ifndef RF_PLANE_POOL_H
+#define RF_PLANE_POOL_H
+
+typedef struct _RFPlanePool RFPlanePool;
+
+RFPlanePool *rf_plane_pool_new (void);
+/* Unmaps all the planes, including the ones not released */
+void rf_plane_pool_free (RFPlanePool *pool);
+
+/* width * height floats, NULL if out of memory. The contents are whatever
+ * the previous user left. */
+float *rf_plane_pool_acquire (RFPlanePool *pool, int width, int height);
+void rf_plane_pool_release (RFPlanePool *pool, float *plane);
+
+#endif
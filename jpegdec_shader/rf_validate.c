@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ */
+
+#include "rf_validate.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define RF_HAVE_F16C_PATH 1
+#endif
+
+float half_to_float(uint16_t h) {
+    uint16_t h_exp = (h & 0x7C00) >> 10;  // exponent
+    uint16_t h_sig = h & 0x03FF;         // mantissa
+    uint32_t sign = (h & 0x8000) << 16;  // sign << 16 to match float format
+
+    uint32_t f;
+
+    if (h_exp == 0) {
+        // Subnormal or zero
+        if (h_sig == 0) {
+            f = sign;
+        } else {
+            // Normalize subnormal
+            h_exp = 1;
+            while ((h_sig & 0x0400) == 0) {
+                h_sig <<= 1;
+                h_exp--;
+            }
+            h_sig &= 0x03FF;
+            h_exp += 127 - 15;
+            f = sign | (h_exp << 23) | (h_sig << 13);
+        }
+    } else if (h_exp == 0x1F) {
+        // Inf or NaN
+        f = sign | 0x7F800000 | (h_sig << 13);
+    } else {
+        // Normalized
+        uint32_t exp = h_exp + (127 - 15);
+        f = sign | (exp << 23) | (h_sig << 13);
+    }
+
+    float result;
+    memcpy (&result, &f, sizeof (result));
+    return result;
+}
+
+#ifdef RF_HAVE_F16C_PATH
+__attribute__ ((target ("avx,f16c")))
+static size_t rf_half_to_float_f16c (const uint16_t *in, float *out, size_t n)
+{
+  size_t i;
+
+  for (i = 0; i + 8 <= n; i += 8) {
+    __m128i h = _mm_loadu_si128 ((const __m128i *) (in + i));
+    _mm256_storeu_ps (out + i, _mm256_cvtph_ps (h));
+  }
+
+  return i;
+}
+#endif
+
+void rf_half_to_float_n (const uint16_t *in, float *out, size_t n)
+{
+  size_t i = 0;
+
+#ifdef RF_HAVE_F16C_PATH
+  /* the 256 bit stores want AVX too, and libgcc only says "avx" if the
+   * OS saves the YMM registers */
+  if (__builtin_cpu_supports ("avx") && __builtin_cpu_supports ("f16c"))
+    i = rf_half_to_float_f16c (in, out, n);
+#endif
+
+  /* the tail, or everything if there's no F16C */
+  for (; i < n; i++)
+    out[i] = half_to_float (in[i]);
+}
+
+void rf_compare_plane (const float *ref, const float *test, size_t n,
+    float peak, RFStageStats *stats)
+{
+  double se = 0;
+
+  stats->max_error = 0;
+  for (size_t i = 0; i < n; i++) {
+    float d = fabsf (ref[i] - test[i]);
+
+    se += (double) d * d;
+    if (d > stats->max_error)
+      stats->max_error = d;
+  }
+
+  /* identical planes give inf, and that's fine to print */
+  stats->psnr = 10.0 * log10 ((double) peak * peak / (se / n));
+}
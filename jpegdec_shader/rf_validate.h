@@ -0,0 +1,27 @@
+/*
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ */
+
+/* Helpers to check what comes back from the GPU against the CPU reference */
+
+#ifndef RF_VALIDATE_H
+#define RF_VALIDATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+  double psnr;
+  float max_error;
+} RFStageStats;
+
+float half_to_float (uint16_t h);
+
+/* Whole plane at once, with F16C if the CPU has it */
+void rf_half_to_float_n (const uint16_t *in, float *out, size_t n);
+
+/* PSNR is relative to @peak, that is the range of the reference */
+void rf_compare_plane (const float *ref, const float *test, size_t n,
+    float peak, RFStageStats *stats);
+
+#endif
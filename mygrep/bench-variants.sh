@@ -0,0 +1,38 @@
+#!/bin/sh
+# Every variant of the tools meson built, over the same synthetic log, and
+# how they compare: run from the build directory by
+#
+#   ninja -C build bench-variants
+#
+# or by hand, with the tools given:
+#
+#   mygrep/bench-variants.sh <mygrep-synth> <mygrep-compare> <tool>...
+#
+# The first variant of a tool is the baseline of the others. The samples
+# go to variants.json, next to the log, written again every time: keep a
+# copy to compare with after a compiler upgrade. RUNS, SIZE (MiB) and
+# STRING change what's run, CPU pins it.
+
+# meson runs it from anywhere
+cd "${MESON_BUILD_ROOT:-.}" || exit 1
+
+SYNTH=$1
+COMPARE=$2
+shift 2
+
+RUNS=${RUNS:-20}
+SIZE=${SIZE:-64}
+STRING=${STRING:-caps}
+LOG=synthetic-$SIZE.log
+JSON=variants.json
+
+[ -f "$LOG" ] || "$SYNTH" --size "$SIZE" "$LOG" || exit 1
+rm -f "$JSON"
+
+for tool in "$@"; do
+  echo "$(basename "$tool")"
+  "$tool" --runs "$RUNS" ${CPU:+--cpu "$CPU"} --json "$JSON" "$LOG" \
+      "$STRING" > /dev/null 2>&1 || exit 1
+done
+
+"$COMPARE" "$JSON"
@@ -0,0 +1,479 @@
+/* Search algorithms of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "mygrep-algo.h"
+#include "mygrep-search.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Where AUTO goes from the vector filter to Horspool, see mygrep-bench: the
+ * filter is the faster one over text with most of the bytes in use, Horspool
+ * only once its shifts are long, for long patterns of a few distinct bytes,
+ * the way the text they come from probably is */
+#define MYGREP_HORSPOOL_MIN 16
+#define MYGREP_HORSPOOL_ALPHABET 4
+
+/* One byte patterns are counted a block at a time: with memchr () while the
+ * byte is rare, with the vector search once it's found more often than once
+ * every MYGREP_MEMCHR_DENSE bytes, and a call per match costs too much */
+#define MYGREP_MEMCHR_BLOCK (64 << 10)
+#define MYGREP_MEMCHR_DENSE 64
+
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+struct _MygrepPattern
+{
+  MygrepAlgo algo;
+  const char *what;
+  size_t what_len;
+
+  const MygrepSearch *search;
+
+  /* Two-Way: 1 + the last index of the byte in the pattern, 0 if none */
+  size_t shift[256];
+
+  /* Horspool: how far to go on by the last two bytes of the window */
+  uint16_t *shift2;
+
+  /* Two-Way: the critical factorization and the period */
+  size_t split, period;
+  int periodic;
+
+  /* MYGREP_PATTERN_IGNORE_CASE */
+  int fold_case;
+  MygrepFold fold;
+};
+
+static const char *algo_names[] = {
+  "auto", "memchr", "simd", "horspool", "two-way"
+};
+
+const char *
+mygrep_algo_name (MygrepAlgo algo)
+{
+  return algo < MYGREP_ALGO_LAST ? algo_names[algo] : NULL;
+}
+
+MygrepAlgo
+mygrep_algo_from_name (const char *name)
+{
+  MygrepAlgo algo;
+
+  for (algo = 0; algo < MYGREP_ALGO_LAST; algo++) {
+    if (!strcmp (name, algo_names[algo]))
+      break;
+  }
+
+  return algo;
+}
+
+/* Start of the maximal suffix of @n for the order @sign, and its period */
+static size_t
+mygrep_max_suffix (const unsigned char *n, size_t l, int sign, size_t *period)
+{
+  size_t ip = -1, jp = 0, k = 1, p = 1;
+
+  while (jp + k < l) {
+    int a = n[ip + k], b = n[jp + k];
+
+    if (a == b) {
+      if (k == p) {
+        jp += p;
+        k = 1;
+      } else {
+        k++;
+      }
+    } else if ((a > b) == (sign > 0)) {
+      jp += k;
+      k = 1;
+      p = jp - ip;
+    } else {
+      ip = jp++;
+      k = p = 1;
+    }
+  }
+
+  *period = p;
+  return ip;
+}
+
+static void
+mygrep_two_way_prepare (MygrepPattern * pattern)
+{
+  const unsigned char *n = (const unsigned char *) pattern->what;
+  size_t l = pattern->what_len, ms, p, ms2, p2, i;
+
+  for (i = 0; i < l; i++)
+    pattern->shift[n[i]] = i + 1;
+
+  ms = mygrep_max_suffix (n, l, 1, &p);
+  ms2 = mygrep_max_suffix (n, l, -1, &p2);
+  if (ms2 + 1 > ms + 1) {
+    ms = ms2;
+    p = p2;
+  }
+
+  pattern->split = ms + 1;
+  pattern->periodic = !memcmp (n, n + p, ms + 1);
+  if (pattern->periodic)
+    pattern->period = p;
+  else
+    pattern->period = MAX (ms, l - ms - 1) + 1;
+}
+
+/* Next match at or after @h, NULL if none before @z */
+static const char *
+mygrep_two_way_find (const MygrepPattern * pattern, const char *h,
+    const char *z)
+{
+  const char *n = pattern->what;
+  size_t l = pattern->what_len, split = pattern->split, k, mem = 0;
+  size_t mem0 = pattern->periodic ? l - pattern->period : 0;
+
+  while ((size_t) (z - h) >= l) {
+    size_t last = pattern->shift[(uint8_t) h[l - 1]];
+
+    /* the last byte of the window decides how far to go, if it's not the
+     * last one of the pattern */
+    if (last != l) {
+      k = last ? l - last : l;
+      h += k < mem ? mem : k;
+      mem = 0;
+      continue;
+    }
+
+    /* right half, the mismatch tells how far */
+    for (k = split > mem ? split : mem; k < l && n[k] == h[k]; k++);
+    if (k < l) {
+      h += k - split + 1;
+      mem = 0;
+      continue;
+    }
+
+    /* left half */
+    for (k = split; k > mem && n[k - 1] == h[k - 1]; k--);
+    if (k <= mem)
+      return h;
+
+    h += pattern->period;
+    mem = mem0;
+  }
+
+  return NULL;
+}
+
+#define MYGREP_BIGRAM(p) ((uint8_t) (p)[0] << 8 | (uint8_t) (p)[1])
+
+/* The shifts go by pairs of bytes rather than single ones: in text most of
+ * the bytes are somewhere in a long pattern, most of the pairs aren't. */
+static void
+mygrep_horspool_prepare (MygrepPattern * pattern)
+{
+  size_t l = pattern->what_len, i;
+  uint16_t far = l - 1 < UINT16_MAX ? l - 1 : UINT16_MAX;
+
+  pattern->shift2 = malloc (65536 * sizeof (uint16_t));
+  for (i = 0; i < 65536; i++)
+    pattern->shift2[i] = far;
+
+  /* a shift of 0 would be the pair at the end, that one is checked */
+  for (i = 0; i + 2 < l; i++) {
+    if (l - 2 - i < far)
+      pattern->shift2[MYGREP_BIGRAM (pattern->what + i)] = l - 2 - i;
+  }
+}
+
+static const char *
+mygrep_horspool_find (const MygrepPattern * pattern, const char *h,
+    const char *z)
+{
+  const char *n = pattern->what;
+  size_t l = pattern->what_len;
+  const int last = MYGREP_BIGRAM (n + l - 2);
+
+  while ((size_t) (z - h) >= l) {
+    int pair = MYGREP_BIGRAM (h + l - 2);
+
+    if (pair == last && !memcmp (h, n, l - 2))
+      return h;
+
+    h += pattern->shift2[pair];
+  }
+
+  return NULL;
+}
+
+static const char *
+mygrep_memchr_find (const MygrepPattern * pattern, const char *h,
+    const char *z)
+{
+  size_t l = pattern->what_len;
+
+  while ((size_t) (z - h) >= l) {
+    h = memchr (h, pattern->what[0], z - h - l + 1);
+    if (!h || !memcmp (h, pattern->what, l))
+      return h;
+    h++;
+  }
+
+  return NULL;
+}
+
+static int
+mygrep_distinct_bytes (const char *what, size_t what_len)
+{
+  uint8_t seen[256] = { 0 };
+  size_t i;
+  int distinct = 0;
+
+  for (i = 0; i < what_len; i++) {
+    distinct += !seen[(uint8_t) what[i]];
+    seen[(uint8_t) what[i]] = 1;
+  }
+
+  return distinct;
+}
+
+/* The smallest period, from the longest border of KMP */
+static size_t
+mygrep_smallest_period (const char *what, size_t what_len)
+{
+  size_t *border, i, k, period;
+
+  border = calloc (what_len + 1, sizeof (size_t));
+  for (i = 1, k = 0; i < what_len; i++) {
+    while (k && what[i] != what[k])
+      k = border[k];
+    if (what[i] == what[k])
+      k++;
+    border[i + 1] = k;
+  }
+  period = what_len - border[what_len];
+  free (border);
+
+  return period;
+}
+
+static size_t
+mygrep_memchr_count_byte (const MygrepPattern * pattern, const char *where,
+    size_t size)
+{
+  size_t ans = 0, i, block, found;
+  int dense = 0;
+
+  for (i = 0; i < size; i += block) {
+    const char *h = where + i, *z;
+
+    block = size - i < MYGREP_MEMCHR_BLOCK ? size - i : MYGREP_MEMCHR_BLOCK;
+    z = h + block;
+
+    if (dense) {
+      found = pattern->search->mygrep_count_byte (h, block, pattern->what[0]);
+    } else {
+      for (found = 0; (h = memchr (h, pattern->what[0], z - h)); h++)
+        found++;
+    }
+
+    dense = found * MYGREP_MEMCHR_DENSE > block;
+    ans += found;
+  }
+
+  return ans;
+}
+
+MygrepPattern *
+mygrep_pattern_new_full (const char *what, size_t what_len, MygrepAlgo algo,
+    MygrepPatternFlags flags)
+{
+  MygrepPattern *pattern = calloc (1, sizeof (MygrepPattern));
+
+  if ((flags & MYGREP_PATTERN_IGNORE_CASE) && what_len) {
+    mygrep_fold_init (&pattern->fold, what, what_len);
+    if (pattern->fold.caseless) {
+      mygrep_fold_clear (&pattern->fold);
+    } else {
+      pattern->fold_case = 1;
+      algo = MYGREP_ALGO_SIMD;
+    }
+  }
+
+  if (algo == MYGREP_ALGO_AUTO && what_len <= 1) {
+    algo = MYGREP_ALGO_MEMCHR;
+  } else if (algo == MYGREP_ALGO_AUTO) {
+    int distinct = mygrep_distinct_bytes (what, what_len);
+
+    /* Few distinct bytes, or a short piece over and over: on text like that
+     * every position is a candidate and gets compared all along, but for
+     * Two-Way */
+    if (what_len >= 8 && (distinct <= 2 ||
+            mygrep_smallest_period (what, what_len) * 4 <= what_len))
+      algo = MYGREP_ALGO_TWO_WAY;
+    else if (what_len >= MYGREP_HORSPOOL_MIN &&
+        distinct <= MYGREP_HORSPOOL_ALPHABET)
+      algo = MYGREP_ALGO_HORSPOOL;
+    else
+      algo = MYGREP_ALGO_SIMD;
+  }
+
+  pattern->algo = algo;
+  pattern->what = what;
+  pattern->what_len = what_len;
+
+  if (what_len == 0)
+    return pattern;
+
+  /* the dense bytes of every algorithm go to it too */
+  pattern->search = mygrep_search_get ();
+
+  switch (algo) {
+    case MYGREP_ALGO_HORSPOOL:
+      if (what_len >= 2)
+        mygrep_horspool_prepare (pattern);
+      break;
+    case MYGREP_ALGO_TWO_WAY:
+      mygrep_two_way_prepare (pattern);
+      break;
+    default:
+      break;
+  }
+
+  return pattern;
+}
+
+MygrepPattern *
+mygrep_pattern_new (const char *what, size_t what_len, MygrepAlgo algo)
+{
+  return mygrep_pattern_new_full (what, what_len, algo, 0);
+}
+
+void
+mygrep_pattern_free (MygrepPattern * pattern)
+{
+  mygrep_fold_clear (&pattern->fold);
+  free (pattern->shift2);
+  free (pattern);
+}
+
+MygrepAlgo
+mygrep_pattern_algo (const MygrepPattern * pattern)
+{
+  return pattern->algo;
+}
+
+size_t
+mygrep_pattern_length (const MygrepPattern * pattern)
+{
+  return pattern->what_len;
+}
+
+const char *
+mygrep_pattern_what (const MygrepPattern * pattern)
+{
+  return pattern->what;
+}
+
+int
+mygrep_pattern_ignores_case (const MygrepPattern * pattern)
+{
+  return pattern->fold_case;
+}
+
+size_t
+mygrep_pattern_count (const MygrepPattern * pattern, const char *where,
+    size_t size, size_t *resume)
+{
+  const char *(*find) (const MygrepPattern *, const char *, const char *);
+  const char *h = where, *z = where + size, *next = where;
+  size_t l = pattern->what_len, ans = 0;
+
+  if (pattern->fold_case)
+    return pattern->search->mygrep_count_fold (where, size, &pattern->fold,
+        resume);
+
+  if (pattern->algo == MYGREP_ALGO_SIMD && l)
+    return pattern->search->mygrep_count (where, size, pattern->what, l,
+        resume);
+
+  if (l == 0 || l > size) {
+    if (resume)
+      *resume = l ? 0 : size;
+    return 0;
+  }
+
+  if (l == 1 && pattern->algo != MYGREP_ALGO_TWO_WAY) {
+    if (resume)
+      *resume = size;
+    return mygrep_memchr_count_byte (pattern, where, size);
+  }
+
+  switch (pattern->algo) {
+    case MYGREP_ALGO_HORSPOOL:
+      find = mygrep_horspool_find;
+      break;
+    case MYGREP_ALGO_TWO_WAY:
+      find = mygrep_two_way_find;
+      break;
+    default:
+      find = mygrep_memchr_find;
+      break;
+  }
+
+  while ((h = find (pattern, h, z))) {
+    ans++;
+    h += l;
+    next = h;
+  }
+
+  /* after the last match, or where a match could still be cut short */
+  if (resume)
+    *resume = MAX ((size_t) (next - where), size - l + 1);
+
+  return ans;
+}
+
+const char *
+mygrep_pattern_find (const MygrepPattern * pattern, const char *where,
+    size_t size)
+{
+  size_t l = pattern->what_len;
+
+  if (l == 0 || l > size)
+    return NULL;
+
+  if (pattern->fold_case)
+    return pattern->search->mygrep_find_fold (where, size, &pattern->fold);
+
+  if (l == 1 && pattern->algo != MYGREP_ALGO_TWO_WAY)
+    return memchr (where, pattern->what[0], size);
+
+  switch (pattern->algo) {
+    case MYGREP_ALGO_SIMD:
+      return pattern->search->mygrep_find (where, size, pattern->what, l);
+    case MYGREP_ALGO_HORSPOOL:
+      return mygrep_horspool_find (pattern, where, where + size);
+    case MYGREP_ALGO_TWO_WAY:
+      return mygrep_two_way_find (pattern, where, where + size);
+    default:
+      return mygrep_memchr_find (pattern, where, where + size);
+  }
+}
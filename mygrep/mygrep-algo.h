@@ -0,0 +1,91 @@
+/* Search algorithms of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* A pattern is prepared once for the algorithm that suits it, and then
+ * counted with the same semantics as MygrepSearch: non-overlapping, left to
+ * right, with the resume offset for the bytes coming after.
+ *
+ *  - memchr: libc finds the first byte, memcmp () the rest. One byte
+ *    patterns need nothing else, unless the byte is frequent, then the
+ *    vector search counts them.
+ *  - simd: the first and last byte filter of mygrep-search.c, through the
+ *    IFTR. The fastest over most of the text at any length.
+ *  - horspool: Boyer-Moore-Horspool on pairs of bytes, skips up to the
+ *    pattern length per step. Gets ahead of the filter for long patterns
+ *    over few distinct bytes, where the filter finds candidates everywhere.
+ *  - two-way: Crochemore-Perrin, linear whatever the text and the pattern
+ *    are, for the patterns that make the others quadratic: a few distinct
+ *    bytes, repeating themselves.
+ *
+ * AUTO goes by the pattern alone, mygrep-bench shows the whole picture.
+ *
+ * MYGREP_PATTERN_IGNORE_CASE goes to the vector filter whatever the
+ * algorithm, the only one that folds (see mygrep-fold.h), unless nothing in
+ * the pattern has a case. */
+
+#ifndef MYGREP_ALGO_H
+#define MYGREP_ALGO_H
+
+#include <stddef.h>
+
+typedef enum
+{
+  MYGREP_ALGO_AUTO,
+  MYGREP_ALGO_MEMCHR,
+  MYGREP_ALGO_SIMD,
+  MYGREP_ALGO_HORSPOOL,
+  MYGREP_ALGO_TWO_WAY,
+  MYGREP_ALGO_LAST
+} MygrepAlgo;
+
+typedef enum
+{
+  MYGREP_PATTERN_IGNORE_CASE = 1 << 0
+} MygrepPatternFlags;
+
+typedef struct _MygrepPattern MygrepPattern;
+
+/* @what has to stay around as long as the pattern */
+MygrepPattern *mygrep_pattern_new (const char *what, size_t what_len,
+    MygrepAlgo algo);
+MygrepPattern *mygrep_pattern_new_full (const char *what, size_t what_len,
+    MygrepAlgo algo, MygrepPatternFlags flags);
+void mygrep_pattern_free (MygrepPattern * pattern);
+
+/* What AUTO turned into */
+MygrepAlgo mygrep_pattern_algo (const MygrepPattern * pattern);
+size_t mygrep_pattern_length (const MygrepPattern * pattern);
+const char *mygrep_pattern_what (const MygrepPattern * pattern);
+/* Whether it's searched without the case, in the end */
+int mygrep_pattern_ignores_case (const MygrepPattern * pattern);
+
+/* Like MygrepSearch.mygrep_count () */
+size_t mygrep_pattern_count (const MygrepPattern * pattern,
+    const char *where, size_t size, size_t *resume);
+
+/* The first match, NULL if none */
+const char *mygrep_pattern_find (const MygrepPattern * pattern,
+    const char *where, size_t size);
+
+const char *mygrep_algo_name (MygrepAlgo algo);
+/* MYGREP_ALGO_LAST if there's no such */
+MygrepAlgo mygrep_algo_from_name (const char *name);
+
+#endif
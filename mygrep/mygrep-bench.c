@@ -0,0 +1,273 @@
+/* Benchmark matrix of the mygrep search algorithms
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Throughput of every algorithm of mygrep-algo.h, for patterns of 1 to 256
+ * bytes, over texts from a skewed alphabet to a flat one:
+ *
+ *   binary    'a' and 'b'
+ *   dna       "acgt"
+ *   english   letters and spaces with the frequencies of English text
+ *   uniform   all the 26 letters, equally often
+ *   runs      'a' all along, with a 'b' every 4 KiB: every position is a
+ *             candidate for the filters, the worst case but for Two-Way
+ *
+ * The patterns are taken from the text itself, except for "runs", where
+ * they are the 'a's with a 'b' in the middle. A file given on the command
+ * line comes as one more text. Every cell is the median of a few runs, in
+ * MB/s. "simd -i" is the vector filter ignoring the case, to compare with
+ * "simd", the last column is what "auto" takes.
+ *
+ * $ ./build/mygrep-bench [--size <MiB>] [<file>]
+ */
+
+#include "mygrep-algo.h"
+#include "mygrep-harness.h"
+#include "mygrep-input.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MYGREP_BENCH_RUNS 5
+
+static const size_t lengths[] = { 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+
+typedef enum
+{
+  TEXT_BINARY,
+  TEXT_DNA,
+  TEXT_ENGLISH,
+  TEXT_UNIFORM,
+  TEXT_RUNS,
+  TEXT_FILE
+} MygrepBenchText;
+
+static const char *text_names[] = {
+  "binary", "dna", "english", "uniform", "runs", "file"
+};
+
+/* per mille, the rest are spaces */
+static const struct
+{
+  char c;
+  int freq;
+} english[] = {
+  {'e', 102}, {'t', 75}, {'a', 65}, {'o', 61}, {'i', 57}, {'n', 55},
+  {'s', 51}, {'h', 49}, {'r', 48}, {'d', 34}, {'l', 32}, {'c', 22},
+  {'u', 22}, {'m', 19}, {'w', 19}, {'f', 18}, {'g', 16}, {'y', 16},
+  {'p', 15}, {'b', 12}, {'v', 8}, {'k', 6}, {'j', 1}, {'x', 1},
+  {'q', 1}, {'z', 1}
+};
+
+static uint64_t rng = 0x9e3779b97f4a7c15ull;
+
+static uint32_t
+mygrep_bench_random (void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 7;
+  rng ^= rng << 17;
+  return rng >> 32;
+}
+
+static char
+mygrep_bench_english (void)
+{
+  int r = mygrep_bench_random () % 1000, i;
+
+  for (i = 0; i < (int) (sizeof (english) / sizeof (english[0])); i++) {
+    r -= english[i].freq;
+    if (r < 0)
+      return english[i].c;
+  }
+
+  return ' ';
+}
+
+static void
+mygrep_bench_fill (char *text, size_t size, MygrepBenchText kind)
+{
+  size_t i;
+
+  for (i = 0; i < size; i++) {
+    switch (kind) {
+      case TEXT_BINARY:
+        text[i] = 'a' + mygrep_bench_random () % 2;
+        break;
+      case TEXT_DNA:
+        text[i] = "acgt"[mygrep_bench_random () % 4];
+        break;
+      case TEXT_ENGLISH:
+        text[i] = mygrep_bench_english ();
+        break;
+      case TEXT_UNIFORM:
+        text[i] = 'a' + mygrep_bench_random () % 26;
+        break;
+      default:
+        text[i] = i % 4096 == 4095 ? 'b' : 'a';
+        break;
+    }
+  }
+}
+
+static void
+mygrep_bench_pattern (char *what, size_t len, const char *text, size_t size,
+    MygrepBenchText kind)
+{
+  if (kind == TEXT_RUNS) {
+    memset (what, 'a', len);
+    what[len / 2] = 'b';
+    return;
+  }
+
+  memcpy (what, text + mygrep_bench_random () % (size - len), len);
+}
+
+/* MB/s of the median run. @count gets the count of the first run, or is
+ * what it has to be: -1 if any differs, or if the runs can't be kept. */
+static double
+mygrep_bench_run (MygrepPattern * pattern, const char *text, size_t size,
+    size_t *count)
+{
+  MygrepHarness *harness;
+  MygrepHarnessStats stats;
+  int r, ret = 0;
+
+  harness = mygrep_harness_new (1, MYGREP_BENCH_RUNS, -1);
+  if (!harness)
+    return -1;
+  for (r = 0; r < mygrep_harness_total_runs (harness); r++) {
+    size_t found;
+
+    mygrep_harness_start (harness);
+    found = mygrep_pattern_count (pattern, text, size, NULL);
+    mygrep_harness_stop (harness);
+
+    if (*count == (size_t) -1)
+      *count = found;
+    else if (found != *count)
+      ret = -1;
+  }
+
+  mygrep_harness_stats (harness, MYGREP_HARNESS_TIME, &stats);
+  mygrep_harness_free (harness);
+
+  return ret < 0 ? -1 : size / stats.median * 1e3;
+}
+
+static int
+mygrep_bench_text (const char *text, size_t size, MygrepBenchText kind)
+{
+  char what[256];
+  size_t l;
+  MygrepAlgo algo;
+  int ret = 0;
+
+  printf ("\n%s, %zu MiB\n%6s", text_names[kind], size >> 20, "length");
+  for (algo = MYGREP_ALGO_MEMCHR; algo < MYGREP_ALGO_LAST; algo++)
+    printf ("%10s", mygrep_algo_name (algo));
+  printf ("%10s%10s\n", "simd -i", "auto");
+
+  for (l = 0; l < sizeof (lengths) / sizeof (lengths[0]); l++) {
+    size_t len = lengths[l], count = -1, fold_count = -1;
+    double mbs;
+    MygrepPattern *pattern;
+
+    if (len >= size)
+      break;
+
+    mygrep_bench_pattern (what, len, text, size, kind);
+    printf ("%6zu", len);
+
+    for (algo = MYGREP_ALGO_MEMCHR; algo < MYGREP_ALGO_LAST; algo++) {
+      pattern = mygrep_pattern_new (what, len, algo);
+      mbs = mygrep_bench_run (pattern, text, size, &count);
+      mygrep_pattern_free (pattern);
+
+      if (mbs < 0) {
+        printf ("%10s", "MISMATCH");
+        ret = -1;
+      } else {
+        printf ("%10.0f", mbs);
+      }
+      fflush (stdout);
+    }
+
+    /* finds more than the others where the case differs */
+    pattern = mygrep_pattern_new_full (what, len, MYGREP_ALGO_SIMD,
+        MYGREP_PATTERN_IGNORE_CASE);
+    mbs = mygrep_bench_run (pattern, text, size, &fold_count);
+    mygrep_pattern_free (pattern);
+    if (mbs < 0) {
+      printf ("%10s", "MISMATCH");
+      ret = -1;
+    } else {
+      printf ("%10.0f", mbs);
+    }
+
+    pattern = mygrep_pattern_new (what, len, MYGREP_ALGO_AUTO);
+    printf ("%10s\n", mygrep_algo_name (mygrep_pattern_algo (pattern)));
+    mygrep_pattern_free (pattern);
+  }
+
+  return ret;
+}
+
+int
+main (int argc, char **argv)
+{
+  size_t size = 16 << 20;
+  MygrepBenchText kind;
+  MygrepFile map = { NULL };
+  char *text;
+  int arg, ret = 0;
+
+  for (arg = 1; arg < argc && argv[arg][0] == '-'; arg++) {
+    if (!strcmp (argv[arg], "--size") && arg + 1 < argc) {
+      size = (size_t) atoi (argv[++arg]) << 20;
+    } else {
+      printf ("usage:\nmygrep-bench [--size <MiB>] [<file>]\n");
+      return 1;
+    }
+  }
+
+  if (size == 0)
+    size = 1 << 20;
+
+  text = malloc (size);
+  for (kind = TEXT_BINARY; kind < TEXT_FILE; kind++) {
+    mygrep_bench_fill (text, size, kind);
+    if (mygrep_bench_text (text, size, kind) < 0)
+      ret = 1;
+  }
+  free (text);
+
+  if (arg < argc) {
+    if (mygrep_file_map (&map, argv[arg]) < 0) {
+      perror (argv[arg]);
+      return 1;
+    }
+    if (mygrep_bench_text (map.data, map.size, TEXT_FILE) < 0)
+      ret = 1;
+    mygrep_file_unmap (&map);
+  }
+
+  return ret;
+}
@@ -0,0 +1,256 @@
+/* Comparison of the builds of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Reads the JSON lines mygrep-harness wrote, a line per run of a variant of
+ * a tool, and tells how much faster each one is than the baseline of its
+ * tool: the first line of the tool, or the variant given. The speedup is
+ * the ratio of the medians of the time. Whether it's real is the two sided
+ * Mann-Whitney U test of the samples, which like the median needs nothing
+ * of the shape of the distribution, with the normal approximation that's
+ * good from a dozen runs on:
+ *
+ * $ ./build/mygrep-compare [--baseline <variant>] results.json
+ */
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* below it the difference is significant */
+#define MYGREP_COMPARE_ALPHA 0.01
+
+typedef struct
+{
+  char tool[64], variant[64], engine[64];
+  double *samples;
+  int n;
+  double median;
+} MygrepCompareRun;
+
+/* The string value of @key in @line, "" if none */
+static void
+mygrep_compare_string (const char *line, const char *key, char *value,
+    size_t size)
+{
+  const char *p = strstr (line, key), *q;
+  size_t len;
+
+  value[0] = 0;
+  if (!p || !(p = strchr (p + strlen (key), '"')))
+    return;
+  p++;
+  q = strchr (p, '"');
+  if (!q)
+    return;
+  len = q - p;
+  if (len > size - 1)
+    len = size - 1;
+  memcpy (value, p, len);
+  value[len] = 0;
+}
+
+static int
+mygrep_compare_double (const void *a, const void *b)
+{
+  double x = *(const double *) a, y = *(const double *) b;
+
+  return x < y ? -1 : x > y;
+}
+
+/* The time samples, -1 if the line has none and -2 if they can't be kept */
+static int
+mygrep_compare_parse (const char *line, MygrepCompareRun * run)
+{
+  const char *p = strstr (line, "\"time_ns\"");
+  char *end;
+  double *samples;
+  int alloc = 64;
+
+  if (!p || !(p = strstr (p, "\"samples\": [")))
+    return -1;
+  p += strlen ("\"samples\": [");
+
+  mygrep_compare_string (line, "\"tool\":", run->tool, sizeof (run->tool));
+  mygrep_compare_string (line, "\"variant\":", run->variant,
+      sizeof (run->variant));
+  mygrep_compare_string (line, "\"engine\":", run->engine,
+      sizeof (run->engine));
+
+  run->n = 0;
+  run->samples = malloc (alloc * sizeof (double));
+  if (!run->samples)
+    return -2;
+  while (*p && *p != ']') {
+    double v = strtod (p, &end);
+
+    if (end == p)
+      break;
+    if (run->n == alloc) {
+      samples = realloc (run->samples, (alloc *= 2) * sizeof (double));
+      if (!samples) {
+        free (run->samples);
+        return -2;
+      }
+      run->samples = samples;
+    }
+    run->samples[run->n++] = v;
+    p = end;
+    while (*p == ',' || *p == ' ')
+      p++;
+  }
+  if (run->n == 0) {
+    free (run->samples);
+    return -1;
+  }
+
+  qsort (run->samples, run->n, sizeof (double), mygrep_compare_double);
+  run->median = run->n % 2 ? run->samples[run->n / 2] :
+      (run->samples[run->n / 2 - 1] + run->samples[run->n / 2]) / 2;
+  return 0;
+}
+
+/* Two sided p of the Mann-Whitney U test, the samples are sorted */
+static double
+mygrep_compare_mann_whitney (const MygrepCompareRun * a,
+    const MygrepCompareRun * b)
+{
+  double rank_a = 0, ties = 0, u, mean, var, z, n = a->n + b->n;
+  int i = 0, j = 0;
+
+  /* merge, the ties get the mean of their ranks */
+  while (i < a->n || j < b->n) {
+    double v = i < a->n && (j >= b->n || a->samples[i] <= b->samples[j]) ?
+        a->samples[i] : b->samples[j];
+    int from_a = 0, t = 0;
+    double first = i + j + 1;
+
+    while (i < a->n && a->samples[i] == v) {
+      i++;
+      from_a++;
+      t++;
+    }
+    while (j < b->n && b->samples[j] == v) {
+      j++;
+      t++;
+    }
+    rank_a += from_a * (first + (t - 1) / 2.0);
+    ties += (double) t *t * t - t;
+  }
+
+  u = rank_a - a->n * (a->n + 1) / 2.0;
+  mean = a->n * (double) b->n / 2;
+  var = a->n * (double) b->n / 12 * ((n + 1) - ties / (n * (n - 1)));
+  if (var <= 0)
+    return 1;
+
+  /* with the continuity correction */
+  z = (fabs (u - mean) - 0.5) / sqrt (var);
+  return z <= 0 ? 1 : erfc (z / M_SQRT2);
+}
+
+int
+main (int argc, char **argv)
+{
+  const char *baseline = NULL;
+  MygrepCompareRun *runs = NULL, *more, *base;
+  int n_runs = 0, alloc = 0, arg, r, b, parsed, failed = 0;
+  char *line = NULL;
+  size_t line_size = 0;
+  FILE *f;
+
+  for (arg = 1; arg < argc && argv[arg][0] == '-'; arg++) {
+    if (!strcmp (argv[arg], "--baseline") && arg + 1 < argc)
+      baseline = argv[++arg];
+    else
+      break;
+  }
+
+  if (arg + 1 != argc) {
+    printf ("usage:\nmygrep-compare [--baseline <variant>] <results.json>\n");
+    return 1;
+  }
+
+  f = fopen (argv[arg], "r");
+  if (!f) {
+    perror (argv[arg]);
+    return 1;
+  }
+  while (getline (&line, &line_size, f) > 0) {
+    if (n_runs == alloc) {
+      more = realloc (runs, (alloc ? alloc * 2 : 16) *
+          sizeof (MygrepCompareRun));
+      if (!more) {
+        failed = 1;
+        break;
+      }
+      runs = more;
+      alloc = alloc ? alloc * 2 : 16;
+    }
+    parsed = mygrep_compare_parse (line, &runs[n_runs]);
+    if (parsed == -2) {
+      failed = 1;
+      break;
+    }
+    if (parsed == 0)
+      n_runs++;
+  }
+  free (line);
+  fclose (f);
+
+  if (failed) {
+    fprintf (stderr, "%s: out of memory\n", argv[arg]);
+    for (r = 0; r < n_runs; r++)
+      free (runs[r].samples);
+    free (runs);
+    return 1;
+  }
+
+  printf ("%-10s %-24s %-16s %12s %9s %10s\n", "tool", "variant", "engine",
+      "median us", "speedup", "p");
+
+  for (r = 0; r < n_runs; r++) {
+    double p;
+
+    /* the first of the tool, or the one asked for */
+    for (base = NULL, b = 0; b < n_runs && !base; b++)
+      if (!strcmp (runs[b].tool, runs[r].tool) &&
+          (!baseline || !strcmp (runs[b].variant, baseline)))
+        base = &runs[b];
+
+    printf ("%-10s %-24s %-16s %12.0f", runs[r].tool, runs[r].variant,
+        runs[r].engine, runs[r].median / 1e3);
+    if (!base || base == &runs[r]) {
+      printf (" %9s %10s\n", "baseline", "");
+      continue;
+    }
+
+    p = mygrep_compare_mann_whitney (base, &runs[r]);
+    printf (" %8.3fx %10.2g%s\n", base->median / runs[r].median, p,
+        p < MYGREP_COMPARE_ALPHA ? " *" : "");
+  }
+  printf ("* significant, p < %g\n", MYGREP_COMPARE_ALPHA);
+
+  for (r = 0; r < n_runs; r++)
+    free (runs[r].samples);
+  free (runs);
+  return 0;
+}
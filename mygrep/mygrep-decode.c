@@ -0,0 +1,437 @@
+/* Decompression of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "mygrep-decode.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+struct _MygrepDecoder
+{
+  int fd;
+  MygrepCodec codec;
+  size_t chunk, room;
+
+  /* read before the decoder started */
+  char head[MYGREP_DECODE_MAGIC];
+  size_t head_len;
+  char *input;
+
+  char *slots[MYGREP_DECODE_SLOTS];
+  size_t sizes[MYGREP_DECODE_SLOTS];
+  /* the caller takes the filled slots from read on, and holds the one
+   * before it if held. read + filled is where the thread writes. */
+  unsigned read, filled;
+  int held;
+
+  int done, stop, error;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  pthread_t thread;
+};
+
+MygrepCodec
+mygrep_codec_detect (const void *head, size_t size)
+{
+  const unsigned char *h = head;
+
+  if (size >= 2 && h[0] == 0x1f && h[1] == 0x8b)
+    return MYGREP_CODEC_GZIP;
+  if (size >= 4 && h[0] == 0x28 && h[1] == 0xb5 && h[2] == 0x2f &&
+      h[3] == 0xfd)
+    return MYGREP_CODEC_ZSTD;
+
+  return MYGREP_CODEC_NONE;
+}
+
+const char *
+mygrep_codec_name (MygrepCodec codec)
+{
+  switch (codec) {
+    case MYGREP_CODEC_GZIP:
+      return "gzip";
+    case MYGREP_CODEC_ZSTD:
+      return "zstd";
+    default:
+      return "none";
+  }
+}
+
+int
+mygrep_codec_of_file (const char *fname, MygrepCodec * codec)
+{
+  char head[MYGREP_DECODE_MAGIC];
+  ssize_t got;
+  int fd, err;
+
+  fd = open (fname, O_RDONLY);
+  if (fd < 0)
+    return -1;
+
+  do
+    got = pread (fd, head, sizeof (head), 0);
+  while (got < 0 && errno == EINTR);
+  err = errno;
+  close (fd);
+  if (got < 0) {
+    errno = err;
+    return -1;
+  }
+
+  *codec = mygrep_codec_detect (head, got);
+  return 0;
+}
+
+/* A slot to fill, waiting for the caller to give one back. NULL once the
+ * caller stopped. */
+static char *
+mygrep_decoder_slot (MygrepDecoder * d)
+{
+  char *slot = NULL;
+
+  pthread_mutex_lock (&d->lock);
+  while (!d->stop && d->filled + d->held == MYGREP_DECODE_SLOTS)
+    pthread_cond_wait (&d->cond, &d->lock);
+  if (!d->stop)
+    slot = d->slots[(d->read + d->filled) % MYGREP_DECODE_SLOTS] + d->room;
+  pthread_mutex_unlock (&d->lock);
+
+  return slot;
+}
+
+static void
+mygrep_decoder_put (MygrepDecoder * d, size_t size)
+{
+  pthread_mutex_lock (&d->lock);
+  d->sizes[(d->read + d->filled) % MYGREP_DECODE_SLOTS] = size;
+  d->filled++;
+  pthread_cond_broadcast (&d->cond);
+  pthread_mutex_unlock (&d->lock);
+}
+
+/* The next compressed bytes, the head first. 0 at the end. */
+static ssize_t
+mygrep_decoder_read (MygrepDecoder * d, const char **bytes)
+{
+  ssize_t got;
+
+  if (d->head_len) {
+    got = d->head_len;
+    d->head_len = 0;
+    *bytes = d->head;
+    return got;
+  }
+
+  do
+    got = read (d->fd, d->input, MYGREP_DECODE_INPUT);
+  while (got < 0 && errno == EINTR);
+  *bytes = d->input;
+
+  return got;
+}
+
+#ifdef HAVE_ZLIB
+static int
+mygrep_decoder_gzip (MygrepDecoder * d)
+{
+  z_stream z;
+  const char *bytes;
+  char *out = NULL;
+  size_t filled = 0;
+  ssize_t got;
+  /* the output was full, inflate () may have more without more input */
+  int pending = 0, member = 0, ret = 0, zr;
+
+  memset (&z, 0, sizeof (z));
+  /* 32: a gzip header */
+  if (inflateInit2 (&z, 15 + 32) != Z_OK) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  for (;;) {
+    if (!out) {
+      if (!(out = mygrep_decoder_slot (d)))
+        break;
+      filled = 0;
+    }
+
+    if (z.avail_in == 0 && !pending) {
+      got = mygrep_decoder_read (d, &bytes);
+      if (got <= 0) {
+        ret = got;
+        break;
+      }
+      z.next_in = (Bytef *) bytes;
+      z.avail_in = got;
+    }
+
+    z.next_out = (Bytef *) out + filled;
+    z.avail_out = d->chunk - filled;
+    zr = inflate (&z, Z_NO_FLUSH);
+    filled = d->chunk - z.avail_out;
+    pending = filled == d->chunk;
+
+    /* another member can follow, zcat reads them all */
+    if (zr == Z_STREAM_END) {
+      member = 0;
+      inflateReset (&z);
+    } else if (zr == Z_OK || zr == Z_BUF_ERROR) {
+      member = z.total_in > 0;
+    } else {
+      errno = EBADMSG;
+      ret = -1;
+      break;
+    }
+
+    if (pending) {
+      mygrep_decoder_put (d, filled);
+      out = NULL;
+    }
+  }
+
+  if (ret == 0 && member) {
+    errno = EBADMSG;
+    ret = -1;
+  }
+  if (ret == 0 && out && filled)
+    mygrep_decoder_put (d, filled);
+  inflateEnd (&z);
+
+  return ret;
+}
+#endif
+
+#ifdef HAVE_ZSTD
+static int
+mygrep_decoder_zstd (MygrepDecoder * d)
+{
+  ZSTD_DStream *z = ZSTD_createDStream ();
+  ZSTD_inBuffer in = { NULL, 0, 0 };
+  ZSTD_outBuffer out = { NULL, 0, 0 };
+  const char *bytes;
+  ssize_t got;
+  /* 0 between frames */
+  size_t zr = 0;
+  int pending = 0, ret = 0;
+
+  if (!z) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  for (;;) {
+    if (!out.dst) {
+      if (!(out.dst = mygrep_decoder_slot (d)))
+        break;
+      out.size = d->chunk;
+      out.pos = 0;
+    }
+
+    if (in.pos == in.size && !pending) {
+      got = mygrep_decoder_read (d, &bytes);
+      if (got <= 0) {
+        ret = got;
+        break;
+      }
+      in.src = bytes;
+      in.size = got;
+      in.pos = 0;
+    }
+
+    zr = ZSTD_decompressStream (z, &out, &in);
+    if (ZSTD_isError (zr)) {
+      errno = EBADMSG;
+      ret = -1;
+      break;
+    }
+    pending = out.pos == out.size;
+
+    if (pending) {
+      mygrep_decoder_put (d, out.pos);
+      out.dst = NULL;
+    }
+  }
+
+  if (ret == 0 && zr != 0) {
+    errno = EBADMSG;
+    ret = -1;
+  }
+  if (ret == 0 && out.dst && out.pos)
+    mygrep_decoder_put (d, out.pos);
+  ZSTD_freeDStream (z);
+
+  return ret;
+}
+#endif
+
+static void *
+mygrep_decoder_run (void *data)
+{
+  MygrepDecoder *d = data;
+  int ret = -1;
+
+#ifdef HAVE_ZLIB
+  if (d->codec == MYGREP_CODEC_GZIP)
+    ret = mygrep_decoder_gzip (d);
+#endif
+#ifdef HAVE_ZSTD
+  if (d->codec == MYGREP_CODEC_ZSTD)
+    ret = mygrep_decoder_zstd (d);
+#endif
+
+  pthread_mutex_lock (&d->lock);
+  if (ret < 0)
+    d->error = errno ? errno : EIO;
+  d->done = 1;
+  pthread_cond_broadcast (&d->cond);
+  pthread_mutex_unlock (&d->lock);
+
+  return NULL;
+}
+
+static void
+mygrep_decoder_destroy (MygrepDecoder * d)
+{
+  int s;
+
+  for (s = 0; s < MYGREP_DECODE_SLOTS; s++)
+    free (d->slots[s]);
+  free (d->input);
+  pthread_mutex_destroy (&d->lock);
+  pthread_cond_destroy (&d->cond);
+  free (d);
+}
+
+MygrepDecoder *
+mygrep_decoder_new (int fd, MygrepCodec codec, const void *head,
+    size_t head_len, size_t chunk, size_t room)
+{
+  MygrepDecoder *d;
+  int s, err;
+
+  switch (codec) {
+#ifdef HAVE_ZLIB
+    case MYGREP_CODEC_GZIP:
+#endif
+#ifdef HAVE_ZSTD
+    case MYGREP_CODEC_ZSTD:
+#endif
+      break;
+    default:
+      errno = ENOTSUP;
+      return NULL;
+  }
+
+  if (head_len > MYGREP_DECODE_MAGIC || chunk == 0) {
+    errno = EINVAL;
+    return NULL;
+  }
+
+  d = calloc (1, sizeof (MygrepDecoder));
+  if (!d)
+    return NULL;
+  d->fd = fd;
+  d->codec = codec;
+  d->chunk = chunk;
+  d->room = room;
+  memcpy (d->head, head, head_len);
+  d->head_len = head_len;
+  pthread_mutex_init (&d->lock, NULL);
+  pthread_cond_init (&d->cond, NULL);
+
+  d->input = malloc (MYGREP_DECODE_INPUT);
+  for (s = 0; s < MYGREP_DECODE_SLOTS; s++)
+    d->slots[s] = malloc (room + chunk);
+  for (s = 0; s < MYGREP_DECODE_SLOTS && d->input; s++)
+    if (!d->slots[s])
+      break;
+  if (!d->input || s < MYGREP_DECODE_SLOTS) {
+    mygrep_decoder_destroy (d);
+    errno = ENOMEM;
+    return NULL;
+  }
+
+  err = pthread_create (&d->thread, NULL, mygrep_decoder_run, d);
+  if (err) {
+    mygrep_decoder_destroy (d);
+    errno = err;
+    return NULL;
+  }
+
+  return d;
+}
+
+char *
+mygrep_decoder_next (MygrepDecoder * d, size_t *size)
+{
+  char *piece = NULL;
+  unsigned s;
+
+  pthread_mutex_lock (&d->lock);
+  if (d->held) {
+    d->held = 0;
+    pthread_cond_broadcast (&d->cond);
+  }
+  while (!d->filled && !d->done)
+    pthread_cond_wait (&d->cond, &d->lock);
+
+  if (d->filled) {
+    s = d->read;
+    d->read = (d->read + 1) % MYGREP_DECODE_SLOTS;
+    d->filled--;
+    d->held = 1;
+    *size = d->sizes[s];
+    piece = d->slots[s] + d->room;
+  }
+  pthread_mutex_unlock (&d->lock);
+
+  return piece;
+}
+
+int
+mygrep_decoder_free (MygrepDecoder * d)
+{
+  int err;
+
+  pthread_mutex_lock (&d->lock);
+  d->stop = 1;
+  pthread_cond_broadcast (&d->cond);
+  pthread_mutex_unlock (&d->lock);
+
+  pthread_join (d->thread, NULL);
+  err = d->error;
+  mygrep_decoder_destroy (d);
+
+  if (err) {
+    errno = err;
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,69 @@
+/* Decompression of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Compressed input, gzip or zstd, decompressed by a thread of its own into a
+ * ring of buffers while the caller searches the ones already filled. Each
+ * buffer has some room in front for the bytes a match may start with in the
+ * previous one. gzip needs zlib and zstd libzstd at build time, the input is
+ * told apart by its first bytes either way. */
+
+#ifndef MYGREP_DECODE_H
+#define MYGREP_DECODE_H
+
+#include <stddef.h>
+
+/* buffers of the ring */
+#define MYGREP_DECODE_SLOTS 4
+/* compressed bytes read at once */
+#define MYGREP_DECODE_INPUT (256 << 10)
+/* enough to tell the formats apart */
+#define MYGREP_DECODE_MAGIC 4
+
+typedef enum
+{
+  MYGREP_CODEC_NONE,
+  MYGREP_CODEC_GZIP,
+  MYGREP_CODEC_ZSTD,
+} MygrepCodec;
+
+typedef struct _MygrepDecoder MygrepDecoder;
+
+/* From the first @size bytes of the input */
+MygrepCodec mygrep_codec_detect (const void *head, size_t size);
+const char *mygrep_codec_name (MygrepCodec codec);
+
+/* Reads the first bytes of @fname. Returns -1 and leaves errno on failure. */
+int mygrep_codec_of_file (const char *fname, MygrepCodec * codec);
+
+/* Starts decompressing @fd, whose first @head_len bytes were already read
+ * to @head, in pieces of @chunk bytes with @room bytes in front. Returns
+ * NULL and leaves errno on failure, ENOTSUP if the codec isn't built in. */
+MygrepDecoder *mygrep_decoder_new (int fd, MygrepCodec codec,
+    const void *head, size_t head_len, size_t chunk, size_t room);
+
+/* The next piece, NULL at the end. The previous one goes back to the
+ * thread, the @room bytes before the piece are the caller's to write. */
+char *mygrep_decoder_next (MygrepDecoder * decoder, size_t *size);
+
+/* Stops the thread. Returns -1 and leaves errno if the input was bad or
+ * couldn't be read, EBADMSG for corrupt or truncated data. */
+int mygrep_decoder_free (MygrepDecoder * decoder);
+
+#endif
@@ -0,0 +1,119 @@
+/* Case folding of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "mygrep-fold.h"
+#include <stdlib.h>
+
+int
+mygrep_fold_init (MygrepFold * fold, const char *what, size_t len)
+{
+  const uint8_t *s = (const uint8_t *) what;
+  /* of the bytes a match can have at every offset */
+  uint8_t *any, *all;
+  int anchors = 0;
+  size_t i = 0, k;
+
+  fold->folded = malloc (len + 1);
+  any = malloc (len + 1);
+  all = malloc (len + 1);
+  if (!fold->folded || !any || !all) {
+    free (fold->folded);
+    free (any);
+    free (all);
+    return -1;
+  }
+  fold->len = len;
+  fold->caseless = 1;
+
+  while (i < len) {
+    uint32_t c = s[i];
+
+    if (c < 0x80) {
+      fold->folded[i] = c - 'A' < 26 ? c | 0x20 : c;
+      any[i] = all[i] = c;
+      if ((c | 0x20) - 'a' < 26) {
+        any[i] |= 0x20;
+        all[i] &= ~0x20;
+        fold->caseless = 0;
+      }
+      i++;
+    } else if (c >= 0xc2 && c < 0xe0 && i + 1 < len &&
+        (s[i + 1] & 0xc0) == 0x80) {
+      uint32_t f = mygrep_fold_char ((c & 0x1f) << 6 | (s[i + 1] & 0x3f)), u;
+
+      fold->folded[i] = 0xc0 | f >> 6;
+      fold->folded[i + 1] = 0x80 | (f & 0x3f);
+
+      /* every other character folding the same */
+      any[i] = all[i] = fold->folded[i];
+      any[i + 1] = all[i + 1] = fold->folded[i + 1];
+      for (u = 0x80; u < 0x800; u++) {
+        if (mygrep_fold_char (u) != f)
+          continue;
+        any[i] |= 0xc0 | u >> 6;
+        all[i] &= 0xc0 | u >> 6;
+        any[i + 1] |= 0x80 | (u & 0x3f);
+        all[i + 1] &= 0x80 | (u & 0x3f);
+      }
+      if (any[i] != all[i] || any[i + 1] != all[i + 1])
+        fold->caseless = 0;
+      i += 2;
+    } else {
+      fold->folded[i] = any[i] = all[i] = c;
+      i++;
+    }
+  }
+  fold->folded[len] = 0;
+
+  /* the bytes that are the same in every match, or but for bit 0x20 */
+  for (k = 0; k < len; k++) {
+    uint8_t diff = any[k] ^ all[k];
+
+    if (diff != 0 && diff != 0x20)
+      continue;
+
+    if (anchors++ == 0) {
+      fold->off[0] = k;
+      fold->byte[0] = any[k];
+      fold->mask[0] = diff;
+    }
+    fold->off[1] = k;
+    fold->byte[1] = any[k];
+    fold->mask[1] = diff;
+  }
+
+  /* nothing to filter with, every position is a candidate */
+  if (anchors == 0) {
+    fold->off[0] = fold->off[1] = 0;
+    fold->byte[0] = fold->byte[1] = 0xff;
+    fold->mask[0] = fold->mask[1] = 0xff;
+  }
+
+  free (any);
+  free (all);
+  return 0;
+}
+
+void
+mygrep_fold_clear (MygrepFold * fold)
+{
+  free (fold->folded);
+  fold->folded = NULL;
+}
@@ -0,0 +1,172 @@
+/* Case folding of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Searching without the case, with the vector filter still in front. Bytes
+ * that only differ in the case differ in bit 0x20 more often than not: the
+ * ASCII letters, and the second byte of most of the two byte characters
+ * of UTF-8 (é and É are c3 a9 and c3 89). So the filter compares two bytes
+ * of the pattern with that bit set on both sides, and the candidates get
+ * compared whole, folded.
+ *
+ * The folding is the simple one of Unicode, for the characters that keep
+ * their length: ASCII, Latin-1, Latin Extended-A, the pairs of Latin
+ * Extended-B, Greek, Cyrillic and Armenian. Anything else has to match
+ * exactly. */
+
+#ifndef MYGREP_FOLD_H
+#define MYGREP_FOLD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct
+{
+  /* the pattern, folded */
+  char *folded;
+  size_t len;
+
+  /* two bytes every match has, but for the bits in @mask:
+   * (where[off] | mask) == byte. The first and the last there are. */
+  size_t off[2];
+  uint8_t byte[2], mask[2];
+
+  /* nothing in the pattern has a case */
+  int caseless;
+} MygrepFold;
+
+int mygrep_fold_init (MygrepFold * fold, const char *what, size_t len);
+void mygrep_fold_clear (MygrepFold * fold);
+
+/* The lower case of a code point of two bytes in UTF-8, still two */
+static inline uint32_t
+mygrep_fold_char (uint32_t c)
+{
+  if ((c >= 0xc0 && c <= 0xde && c != 0xd7) ||
+      (c >= 0x391 && c <= 0x3ab && c != 0x3a2) || (c >= 0x410 && c <= 0x42f))
+    return c + 0x20;
+  if (c >= 0x400 && c <= 0x40f)
+    return c + 0x50;
+  if (c >= 0x531 && c <= 0x556)
+    return c + 0x30;
+
+  if (c >= 0x100 && c <= 0x17f) {
+    /* dotted and dotless i, kra, 'n and long s have no pair of this size */
+    if (c == 0x130 || c == 0x131 || c == 0x138 || c == 0x149 || c == 0x17f)
+      return c;
+    if (c == 0x178)
+      return 0xff;
+    /* here the upper case is odd */
+    if ((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17e))
+      return c & 1 ? c + 1 : c;
+    return c & 1 ? c : c + 1;
+  }
+
+  /* the pairs of Latin Extended-B, Coptic in Greek and Cyrillic */
+  if ((c >= 0x1de && c <= 0x1ef) || (c >= 0x1f8 && c <= 0x21f) ||
+      (c >= 0x222 && c <= 0x233) || (c >= 0x246 && c <= 0x24f) ||
+      (c >= 0x3d8 && c <= 0x3ef) || (c >= 0x460 && c <= 0x481) ||
+      (c >= 0x48a && c <= 0x4bf) || (c >= 0x4d0 && c <= 0x52f))
+    return c & 1 ? c : c + 1;
+  if ((c >= 0x1cd && c <= 0x1dc) || (c >= 0x4c1 && c <= 0x4ce))
+    return c & 1 ? c + 1 : c;
+
+  switch (c) {
+    case 0xb5:
+      return 0x3bc;
+    case 0x386:
+      return 0x3ac;
+    case 0x388:
+    case 0x389:
+    case 0x38a:
+      return c + 0x25;
+    case 0x38c:
+      return 0x3cc;
+    case 0x38e:
+    case 0x38f:
+      return c + 0x3f;
+    case 0x3c2:
+      return 0x3c3;
+    case 0x4c0:
+      return 0x4cf;
+    default:
+      return c;
+  }
+}
+
+#define MYGREP_FOLD_ONES 0x0101010101010101ull
+
+/* The upper case ASCII letters of @x to lower case, all its bytes being
+ * ASCII: a byte is one if adding 0x80 - 'A' sets its top bit and adding
+ * 0x80 - 'Z' - 1 doesn't */
+static inline uint64_t
+mygrep_fold_ascii (uint64_t x)
+{
+  uint64_t ge_a = x + (0x80 - 'A') * MYGREP_FOLD_ONES;
+  uint64_t gt_z = x + (0x80 - 'Z' - 1) * MYGREP_FOLD_ONES;
+
+  return x | ((ge_a ^ gt_z) & 0x80 * MYGREP_FOLD_ONES) >> 2;
+}
+
+/* Whether the @len bytes at @p fold to @folded */
+static inline int
+mygrep_fold_equal (const char *p, const char *folded, size_t len)
+{
+  const uint8_t *s = (const uint8_t *) p, *f = (const uint8_t *) folded;
+  size_t i = 0;
+
+  /* eight at a time while it's all ASCII, the rest a character at a time */
+  for (; i + 8 <= len; i += 8) {
+    uint64_t x, y;
+
+    memcpy (&x, s + i, 8);
+    memcpy (&y, f + i, 8);
+    if ((x | y) & 0x80 * MYGREP_FOLD_ONES)
+      break;
+    if (mygrep_fold_ascii (x) != y)
+      return 0;
+  }
+
+  while (i < len) {
+    uint32_t c = s[i];
+
+    if (c < 0x80) {
+      if (c - 'A' < 26)
+        c |= 0x20;
+      if (c != f[i])
+        return 0;
+      i++;
+    } else if (c >= 0xc2 && c < 0xe0 && i + 1 < len &&
+        (s[i + 1] & 0xc0) == 0x80) {
+      c = mygrep_fold_char ((c & 0x1f) << 6 | (s[i + 1] & 0x3f));
+      if (f[i] != (0xc0 | c >> 6) || f[i + 1] != (0x80 | (c & 0x3f)))
+        return 0;
+      i += 2;
+    } else {
+      if (c != f[i])
+        return 0;
+      i++;
+    }
+  }
+
+  return 1;
+}
+
+#endif
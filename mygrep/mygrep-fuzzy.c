@@ -0,0 +1,224 @@
+/* Approximate search of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define _GNU_SOURCE
+#include "mygrep-fuzzy.h"
+#include "mygrep-search.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct _MygrepFuzzy
+{
+  const MygrepSearch *search;
+  int n_whats, n_groups;
+
+  /* MYGREP_FUZZY_WORDS strings a group, 256 columns of words each */
+  uint64_t *peq;
+  uint64_t *bias;
+
+  int errors;
+  size_t *lens;
+
+  /* errors + 1 of every string, where they are in it */
+  MygrepPattern **pieces;
+  int *piece_what;
+  size_t *piece_start;
+  int n_pieces;
+  size_t piece_length;
+};
+
+MygrepFuzzy *
+mygrep_fuzzy_new (const char *const *whats, int n_whats, int errors,
+    MygrepPatternFlags flags, const char **error)
+{
+  MygrepFuzzy *fuzzy;
+  size_t len, start, stop;
+  int w, g, l, j, q;
+
+  if (errors < 0) {
+    *error = "the errors can't be negative";
+    return NULL;
+  }
+  for (w = 0; w < n_whats; w++) {
+    len = strlen (whats[w]);
+    if (len > MYGREP_FUZZY_MAX) {
+      *error = "a string can be 64 bytes at most";
+      return NULL;
+    }
+    /* deleting all of it would match everywhere */
+    if (len <= (size_t) errors) {
+      *error = "a string has to be longer than the errors";
+      return NULL;
+    }
+  }
+
+  fuzzy = calloc (1, sizeof (MygrepFuzzy));
+  fuzzy->search = mygrep_search_get ();
+  fuzzy->n_whats = n_whats;
+  fuzzy->n_groups = (n_whats + MYGREP_FUZZY_WORDS - 1) / MYGREP_FUZZY_WORDS;
+  fuzzy->peq = calloc (fuzzy->n_groups * 256 * MYGREP_FUZZY_WORDS,
+      sizeof (uint64_t));
+  fuzzy->bias = malloc (fuzzy->n_groups * MYGREP_FUZZY_WORDS *
+      sizeof (uint64_t));
+  fuzzy->errors = errors;
+  fuzzy->lens = malloc (n_whats * sizeof (size_t));
+  fuzzy->pieces = calloc (n_whats * (errors + 1), sizeof (MygrepPattern *));
+  fuzzy->piece_what = malloc (n_whats * (errors + 1) * sizeof (int));
+  fuzzy->piece_start = malloc (n_whats * (errors + 1) * sizeof (size_t));
+  fuzzy->piece_length = MYGREP_FUZZY_MAX;
+
+  /* the lanes that aren't strings never get to 0 */
+  for (w = 0; w < fuzzy->n_groups * MYGREP_FUZZY_WORDS; w++)
+    fuzzy->bias[w] = (uint64_t) 1 << 62;
+
+  for (w = 0; w < n_whats; w++) {
+    uint64_t *peq;
+
+    len = fuzzy->lens[w] = strlen (whats[w]);
+    g = w / MYGREP_FUZZY_WORDS;
+    l = w % MYGREP_FUZZY_WORDS;
+    peq = fuzzy->peq + g * 256 * MYGREP_FUZZY_WORDS + l;
+
+    for (j = 0; j < (int) len; j++) {
+      uint8_t c = whats[w][j];
+      uint64_t bit = (uint64_t) 1 << (MYGREP_FUZZY_MAX - len + j);
+
+      peq[c * MYGREP_FUZZY_WORDS] |= bit;
+      if ((flags & MYGREP_PATTERN_IGNORE_CASE) &&
+          ((c | 0x20) >= 'a' && (c | 0x20) <= 'z'))
+        peq[(c ^ 0x20) * MYGREP_FUZZY_WORDS] |= bit;
+    }
+    fuzzy->bias[g * MYGREP_FUZZY_WORDS + l] = len - errors - 1;
+
+    for (q = 0; q <= errors; q++) {
+      start = len * q / (errors + 1);
+      stop = len * (q + 1) / (errors + 1);
+      fuzzy->piece_what[fuzzy->n_pieces] = w;
+      fuzzy->piece_start[fuzzy->n_pieces] = start;
+      fuzzy->pieces[fuzzy->n_pieces++] =
+          mygrep_pattern_new_full (whats[w] + start, stop - start,
+          MYGREP_ALGO_AUTO, flags);
+      if (stop - start < fuzzy->piece_length)
+        fuzzy->piece_length = stop - start;
+    }
+  }
+
+  return fuzzy;
+}
+
+void
+mygrep_fuzzy_free (MygrepFuzzy * fuzzy)
+{
+  int q;
+
+  for (q = 0; q < fuzzy->n_pieces; q++)
+    mygrep_pattern_free (fuzzy->pieces[q]);
+  free (fuzzy->pieces);
+  free (fuzzy->piece_what);
+  free (fuzzy->piece_start);
+  free (fuzzy->lens);
+  free (fuzzy->peq);
+  free (fuzzy->bias);
+  free (fuzzy);
+}
+
+size_t
+mygrep_fuzzy_piece_length (const MygrepFuzzy * fuzzy)
+{
+  return fuzzy->piece_length;
+}
+
+/* A match that has the piece at @p as it is starts at most errors bytes
+ * before where the piece would be without them, and ends at most errors
+ * bytes after the string would. Only that is searched, not the line. */
+void
+mygrep_fuzzy_count (const MygrepFuzzy * fuzzy, const char *text,
+    size_t size, size_t *counts)
+{
+  const char **next = malloc (fuzzy->n_pieces * sizeof (const char *));
+  /* where each string was counted last */
+  const char **counted = calloc (fuzzy->n_whats, sizeof (const char *));
+  const char *end = text + size, *cursor = text, *line = NULL, *eol = NULL;
+  const char *p, *from, *to, *nl;
+  size_t before, after;
+  unsigned found;
+  int g, l, q, w, first;
+
+  memset (counts, 0, fuzzy->n_whats * sizeof (size_t));
+
+  for (q = 0; q < fuzzy->n_pieces; q++)
+    next[q] = mygrep_pattern_find (fuzzy->pieces[q], text, size);
+
+  for (;;) {
+    /* the next piece anywhere */
+    for (p = NULL, first = -1, q = 0; q < fuzzy->n_pieces; q++) {
+      if (next[q] && (!p || next[q] < p)) {
+        p = next[q];
+        first = q;
+      }
+    }
+    if (!p)
+      break;
+
+    if (!line || p >= eol) {
+      if (eol)
+        cursor = eol + 1;
+      nl = p > cursor ? memrchr (cursor, '\n', p - cursor) : NULL;
+      line = nl ? nl + 1 : cursor;
+      eol = memchr (p, '\n', end - p);
+      if (!eol)
+        eol = end;
+    }
+
+    w = fuzzy->piece_what[first];
+    if (counted[w] == line) {
+      /* this line is done for the string */
+      next[first] = eol < end ? mygrep_pattern_find (fuzzy->pieces[first],
+          eol + 1, end - eol - 1) : NULL;
+      continue;
+    }
+
+    before = fuzzy->piece_start[first] + fuzzy->errors;
+    after = fuzzy->lens[w] - fuzzy->piece_start[first] + fuzzy->errors;
+    from = (size_t) (p - line) > before ? p - before : line;
+    to = (size_t) (eol - p) > after ? p + after : eol;
+
+    /* the other strings of the group come for free, what they find in
+     * there they have anyway */
+    g = w / MYGREP_FUZZY_WORDS;
+    found = fuzzy->search->mygrep_fuzzy (fuzzy->peq +
+        g * 256 * MYGREP_FUZZY_WORDS, fuzzy->bias + g * MYGREP_FUZZY_WORDS,
+        from, to - from, 1u << (w % MYGREP_FUZZY_WORDS));
+
+    for (l = 0; found; l++, found >>= 1) {
+      if ((found & 1) && counted[g * MYGREP_FUZZY_WORDS + l] != line) {
+        counted[g * MYGREP_FUZZY_WORDS + l] = line;
+        counts[g * MYGREP_FUZZY_WORDS + l]++;
+      }
+    }
+
+    next[first] = p + 1 < end ? mygrep_pattern_find (fuzzy->pieces[first],
+        p + 1, end - p - 1) : NULL;
+  }
+
+  free (counted);
+  free (next);
+}
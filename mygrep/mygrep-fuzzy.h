@@ -0,0 +1,55 @@
+/* Approximate search of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Lines with a string in them give or take a few typos: at most k bytes
+ * inserted, deleted or changed, counted by lines like regular expressions.
+ *
+ * Myers' bit-parallel edit distance runs a column of the matrix per byte in
+ * a 64 bit word, and MygrepSearch does MYGREP_FUZZY_WORDS strings at once
+ * in vector lanes. It only runs over lines that can match: cut in k + 1
+ * pieces, a string with k errors still has one of them as it is, and the
+ * exact search finds those about as fast as it finds anything. */
+
+#ifndef MYGREP_FUZZY_H
+#define MYGREP_FUZZY_H
+
+#include <stddef.h>
+#include "mygrep-algo.h"
+
+/* bytes of a string, a word */
+#define MYGREP_FUZZY_MAX 64
+
+typedef struct _MygrepFuzzy MygrepFuzzy;
+
+/* NULL and a static @error if a string is longer than MYGREP_FUZZY_MAX or
+ * not longer than @errors. The strings have to stay around as long as the
+ * MygrepFuzzy. */
+MygrepFuzzy *mygrep_fuzzy_new (const char *const *whats, int n_whats,
+    int errors, MygrepPatternFlags flags, const char **error);
+void mygrep_fuzzy_free (MygrepFuzzy * fuzzy);
+
+/* Of the exact search, the shortest of the pieces */
+size_t mygrep_fuzzy_piece_length (const MygrepFuzzy * fuzzy);
+
+/* The lines with each string in them with at most the errors */
+void mygrep_fuzzy_count (const MygrepFuzzy * fuzzy, const char *text,
+    size_t size, size_t *counts);
+
+#endif
@@ -0,0 +1,755 @@
+/* GStreamer debug logs of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define _GNU_SOURCE
+#include "mygrep-gstlog.h"
+#include "mygrep-search.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The names of a column, which are in the text, and a hash table of their
+ * ids + 1 */
+typedef struct
+{
+  const char **names;
+  uint32_t *lens;
+  uint32_t n, alloc;
+
+  uint32_t *table;
+  uint32_t table_size;
+} MygrepGstDict;
+
+struct _MygrepGstLog
+{
+  const char *text;
+  size_t n_rows, alloc, skipped;
+
+  int64_t *ts;
+  uint32_t *pid;
+  uint64_t *thread;
+  uint8_t *level;
+  uint16_t *category;
+  uint32_t *file, *line, *function, *object;
+  /* of the line in the text, and of its message in the line */
+  size_t *start;
+  uint32_t *message, *len;
+
+  MygrepGstDict categories, files, functions, objects;
+};
+
+typedef enum
+{
+  MYGREP_GST_FIELD_TS,
+  MYGREP_GST_FIELD_PID,
+  MYGREP_GST_FIELD_THREAD,
+  MYGREP_GST_FIELD_LEVEL,
+  MYGREP_GST_FIELD_CATEGORY,
+  MYGREP_GST_FIELD_FILE,
+  MYGREP_GST_FIELD_LINE,
+  MYGREP_GST_FIELD_FUNCTION,
+  MYGREP_GST_FIELD_OBJECT,
+  MYGREP_GST_FIELD_MESSAGE,
+} MygrepGstField;
+
+static const char *const mygrep_gst_fields[] = {
+  "ts", "pid", "thread", "level", "category", "file", "line", "function",
+  "object", "message",
+};
+
+typedef enum
+{
+  MYGREP_GST_OP_EQ,
+  MYGREP_GST_OP_NE,
+  MYGREP_GST_OP_LT,
+  MYGREP_GST_OP_LE,
+  MYGREP_GST_OP_GT,
+  MYGREP_GST_OP_GE,
+  MYGREP_GST_OP_CONTAINS,
+} MygrepGstOp;
+
+typedef struct
+{
+  MygrepGstField field;
+  MygrepGstOp op;
+  /* names and the message */
+  char *value;
+  size_t value_len;
+  /* the rest */
+  int64_t number;
+  MygrepPattern *pattern;
+} MygrepGstPredicate;
+
+struct _MygrepGstQuery
+{
+  MygrepGstPredicate *predicates;
+  int n_predicates;
+};
+
+static const struct
+{
+  const char *name;
+  MygrepGstLevel level;
+} mygrep_gst_levels[] = {
+  {"ERROR", MYGREP_GST_ERROR},
+  {"WARN", MYGREP_GST_WARNING},
+  {"WARNING", MYGREP_GST_WARNING},
+  {"FIXME", MYGREP_GST_FIXME},
+  {"INFO", MYGREP_GST_INFO},
+  {"DEBUG", MYGREP_GST_DEBUG},
+  {"LOG", MYGREP_GST_LOG},
+  {"TRACE", MYGREP_GST_TRACE},
+  {"MEMDUMP", MYGREP_GST_MEMDUMP},
+  {"NONE", MYGREP_GST_NONE},
+};
+
+static int
+mygrep_gst_level (const char *p, size_t len)
+{
+  size_t i;
+
+  for (i = 0; i < sizeof (mygrep_gst_levels) / sizeof (mygrep_gst_levels[0]);
+      i++)
+    if (strlen (mygrep_gst_levels[i].name) == len &&
+        !strncasecmp (mygrep_gst_levels[i].name, p, len))
+      return mygrep_gst_levels[i].level;
+
+  return -1;
+}
+
+static uint32_t
+mygrep_gstdict_hash (const char *p, size_t len)
+{
+  uint32_t h = 2166136261u;
+
+  while (len--)
+    h = (h ^ (uint8_t) * p++) * 16777619u;
+
+  return h;
+}
+
+/* The id of the name, -1 if it isn't there */
+static int64_t
+mygrep_gstdict_find (const MygrepGstDict * d, const char *p, size_t len)
+{
+  uint32_t i, id;
+
+  if (!d->table_size)
+    return -1;
+
+  for (i = mygrep_gstdict_hash (p, len) & (d->table_size - 1);
+      (id = d->table[i]); i = (i + 1) & (d->table_size - 1))
+    if (d->lens[id - 1] == len && !memcmp (d->names[id - 1], p, len))
+      return id - 1;
+
+  return -1;
+}
+
+static int64_t
+mygrep_gstdict_add (MygrepGstDict * d, const char *p, size_t len)
+{
+  int64_t id = mygrep_gstdict_find (d, p, len);
+  uint32_t i, j;
+
+  if (id >= 0)
+    return id;
+
+  if (d->n == d->alloc) {
+    d->alloc = d->alloc ? d->alloc * 2 : 64;
+    d->names = realloc (d->names, d->alloc * sizeof (const char *));
+    d->lens = realloc (d->lens, d->alloc * sizeof (uint32_t));
+  }
+  d->names[d->n] = p;
+  d->lens[d->n] = len;
+  d->n++;
+
+  /* at most half full */
+  if (d->n * 2 > d->table_size) {
+    free (d->table);
+    d->table_size = d->table_size ? d->table_size * 2 : 128;
+    d->table = calloc (d->table_size, sizeof (uint32_t));
+    for (j = 0; j < d->n; j++) {
+      for (i = mygrep_gstdict_hash (d->names[j], d->lens[j]) &
+          (d->table_size - 1); d->table[i]; i = (i + 1) & (d->table_size - 1));
+      d->table[i] = j + 1;
+    }
+  } else {
+    for (i = mygrep_gstdict_hash (p, len) & (d->table_size - 1); d->table[i];
+        i = (i + 1) & (d->table_size - 1));
+    d->table[i] = d->n;
+  }
+
+  return d->n - 1;
+}
+
+static void
+mygrep_gstdict_clear (MygrepGstDict * d)
+{
+  free (d->names);
+  free (d->lens);
+  free (d->table);
+}
+
+/* Decimal digits at *@p, 0 if there are none */
+static int
+mygrep_gst_number (const char **p, const char *e, uint64_t * value)
+{
+  const char *s = *p;
+
+  for (*value = 0; *p < e && **p >= '0' && **p <= '9'; (*p)++)
+    *value = *value * 10 + (**p - '0');
+
+  return *p > s;
+}
+
+static const char *
+mygrep_gst_spaces (const char *p, const char *e)
+{
+  while (p < e && *p == ' ')
+    p++;
+  return p;
+}
+
+static const char *
+mygrep_gst_until (const char *p, const char *e, char c)
+{
+  const char *q = memchr (p, c, e - p);
+
+  return q ? q : e;
+}
+
+/* 0:00:05.1 to nanoseconds, @p goes past it */
+static int
+mygrep_gst_time (const char **p, const char *e, int64_t * ns)
+{
+  uint64_t h, m, s, frac = 0, scale = 1000000000;
+  const char *q;
+
+  if (!mygrep_gst_number (p, e, &h) || *p >= e || *(*p)++ != ':' ||
+      !mygrep_gst_number (p, e, &m) || *p >= e || *(*p)++ != ':' ||
+      !mygrep_gst_number (p, e, &s))
+    return 0;
+
+  if (*p < e && **p == '.') {
+    for (q = ++(*p); *p < e && **p >= '0' && **p <= '9' && *p - q < 9;
+        (*p)++) {
+      frac = frac * 10 + (**p - '0');
+      scale /= 10;
+    }
+  }
+
+  *ns = ((h * 60 + m) * 60 + s) * 1000000000 + frac * scale;
+  return 1;
+}
+
+/* Into row log->n_rows, if it's a debug line */
+static int
+mygrep_gstlog_parse_line (MygrepGstLog * log, const char *p, const char *e)
+{
+  const char *line = p, *q;
+  size_t r = log->n_rows;
+  uint64_t v;
+  int64_t id;
+  int level;
+
+  if (!mygrep_gst_time (&p, e, &log->ts[r]))
+    return 0;
+
+  p = mygrep_gst_spaces (p, e);
+  if (!mygrep_gst_number (&p, e, &v))
+    return 0;
+  log->pid[r] = v;
+
+  p = mygrep_gst_spaces (p, e);
+  log->thread[r] = 0;
+  if (e - p > 2 && p[0] == '0' && p[1] == 'x')
+    for (p += 2; p < e && ((*p >= '0' && *p <= '9') ||
+            ((*p | 0x20) >= 'a' && (*p | 0x20) <= 'f')); p++)
+      log->thread[r] = log->thread[r] << 4 |
+          (*p <= '9' ? *p - '0' : (*p | 0x20) - 'a' + 10);
+  else
+    p = mygrep_gst_until (p, e, ' ');
+
+  p = mygrep_gst_spaces (p, e);
+  q = mygrep_gst_until (p, e, ' ');
+  if ((level = mygrep_gst_level (p, q - p)) < 0)
+    return 0;
+  log->level[r] = level;
+
+  p = mygrep_gst_spaces (q, e);
+  q = mygrep_gst_until (p, e, ' ');
+  if (q == p || q == e)
+    return 0;
+  if ((id = mygrep_gstdict_add (&log->categories, p, q - p)) > UINT16_MAX)
+    return 0;
+  log->category[r] = id;
+
+  /* file:line:function:object, the object may have colons itself */
+  p = q + 1;
+  q = mygrep_gst_until (p, e, ':');
+  if (q == e)
+    return 0;
+  log->file[r] = mygrep_gstdict_add (&log->files, p, q - p);
+  p = q + 1;
+  if (!mygrep_gst_number (&p, e, &v) || p == e || *p++ != ':')
+    return 0;
+  log->line[r] = v;
+  q = mygrep_gst_until (p, e, ':');
+  if (q == e)
+    return 0;
+  log->function[r] = mygrep_gstdict_add (&log->functions, p, q - p);
+  p = q + 1;
+  q = mygrep_gst_until (p, e, ' ');
+  log->object[r] = mygrep_gstdict_add (&log->objects, p, q - p);
+
+  log->start[r] = line - log->text;
+  log->len[r] = e - line;
+  log->message[r] = (q < e ? q + 1 : e) - line;
+  log->n_rows++;
+
+  return 1;
+}
+
+static int
+mygrep_gstlog_grow (MygrepGstLog * log)
+{
+  size_t n = log->alloc ? log->alloc * 2 : 1024;
+
+#define MYGREP_GST_GROW(column) \
+  if (!(log->column = realloc (log->column, n * sizeof (*log->column)))) \
+    return -1;
+  MYGREP_GST_GROW (ts);
+  MYGREP_GST_GROW (pid);
+  MYGREP_GST_GROW (thread);
+  MYGREP_GST_GROW (level);
+  MYGREP_GST_GROW (category);
+  MYGREP_GST_GROW (file);
+  MYGREP_GST_GROW (line);
+  MYGREP_GST_GROW (function);
+  MYGREP_GST_GROW (object);
+  MYGREP_GST_GROW (start);
+  MYGREP_GST_GROW (message);
+  MYGREP_GST_GROW (len);
+#undef MYGREP_GST_GROW
+
+  log->alloc = n;
+  return 0;
+}
+
+MygrepGstLog *
+mygrep_gstlog_parse (const char *text, size_t size)
+{
+  MygrepGstLog *log = calloc (1, sizeof (MygrepGstLog));
+  const char *p = text, *e = text + size, *nl;
+
+  if (!log)
+    return NULL;
+  log->text = text;
+
+  for (; p < e; p = nl + 1) {
+    nl = memchr (p, '\n', e - p);
+    if (!nl)
+      nl = e;
+    if (log->n_rows == log->alloc && mygrep_gstlog_grow (log) < 0) {
+      mygrep_gstlog_free (log);
+      errno = ENOMEM;
+      return NULL;
+    }
+    if (nl > p && !mygrep_gstlog_parse_line (log, p, nl))
+      log->skipped++;
+  }
+
+  return log;
+}
+
+void
+mygrep_gstlog_free (MygrepGstLog * log)
+{
+  free (log->ts);
+  free (log->pid);
+  free (log->thread);
+  free (log->level);
+  free (log->category);
+  free (log->file);
+  free (log->line);
+  free (log->function);
+  free (log->object);
+  free (log->start);
+  free (log->message);
+  free (log->len);
+  mygrep_gstdict_clear (&log->categories);
+  mygrep_gstdict_clear (&log->files);
+  mygrep_gstdict_clear (&log->functions);
+  mygrep_gstdict_clear (&log->objects);
+  free (log);
+}
+
+size_t
+mygrep_gstlog_rows (const MygrepGstLog * log)
+{
+  return log->n_rows;
+}
+
+size_t
+mygrep_gstlog_skipped (const MygrepGstLog * log)
+{
+  return log->skipped;
+}
+
+static int
+mygrep_gst_is_name (MygrepGstField field)
+{
+  return field == MYGREP_GST_FIELD_CATEGORY ||
+      field == MYGREP_GST_FIELD_FILE || field == MYGREP_GST_FIELD_FUNCTION ||
+      field == MYGREP_GST_FIELD_OBJECT;
+}
+
+/* The value of a number field, @p to @e */
+static int
+mygrep_gst_value (MygrepGstField field, const char *p, const char *e,
+    int64_t * number)
+{
+  uint64_t v;
+  int level;
+
+  switch (field) {
+    case MYGREP_GST_FIELD_TS:
+      if (memchr (p, ':', e - p))
+        return mygrep_gst_time (&p, e, number) && p == e;
+      break;
+    case MYGREP_GST_FIELD_LEVEL:
+      if ((level = mygrep_gst_level (p, e - p)) >= 0) {
+        *number = level;
+        return 1;
+      }
+      break;
+    case MYGREP_GST_FIELD_THREAD:
+      if (e - p > 2 && p[0] == '0' && (p[1] | 0x20) == 'x') {
+        char *end;
+
+        *number = strtoull (p, &end, 16);
+        return end == e;
+      }
+      break;
+    default:
+      break;
+  }
+
+  if (!mygrep_gst_number (&p, e, &v) || p != e)
+    return 0;
+  *number = v;
+  return 1;
+}
+
+MygrepGstQuery *
+mygrep_gstquery_new (const char *query, MygrepPatternFlags flags,
+    const char **error)
+{
+  MygrepGstQuery *q = calloc (1, sizeof (MygrepGstQuery));
+  const char *p = query, *e = query + strlen (query), *s;
+  size_t f, n_fields = sizeof (mygrep_gst_fields) / sizeof (char *);
+
+  for (;;) {
+    MygrepGstPredicate pred;
+
+    memset (&pred, 0, sizeof (pred));
+
+    /* the field */
+    p = mygrep_gst_spaces (p, e);
+    for (s = p; p < e && *p >= 'a' && *p <= 'z'; p++);
+    for (f = 0; f < n_fields; f++)
+      if (strlen (mygrep_gst_fields[f]) == (size_t) (p - s) &&
+          !strncmp (mygrep_gst_fields[f], s, p - s))
+        break;
+    if (f == n_fields) {
+      *error = "unknown field";
+      goto fail;
+    }
+    pred.field = f;
+
+    /* how it's compared */
+    p = mygrep_gst_spaces (p, e);
+    if (e - p > 8 && !strncmp (p, "contains", 8) && p[8] == ' ') {
+      pred.op = MYGREP_GST_OP_CONTAINS;
+      p += 8;
+    } else if (e - p > 1 && (p[0] == '!' || p[0] == '<' || p[0] == '>' ||
+            p[0] == '=') && p[1] == '=') {
+      pred.op = p[0] == '!' ? MYGREP_GST_OP_NE : p[0] == '<' ?
+          MYGREP_GST_OP_LE : p[0] == '>' ? MYGREP_GST_OP_GE : MYGREP_GST_OP_EQ;
+      p += 2;
+    } else if (p < e && (*p == '<' || *p == '>' || *p == '=')) {
+      pred.op = *p == '<' ? MYGREP_GST_OP_LT : *p == '>' ?
+          MYGREP_GST_OP_GT : MYGREP_GST_OP_EQ;
+      p++;
+    } else {
+      *error = "expected = != < <= > >= or contains";
+      goto fail;
+    }
+
+    if ((pred.field == MYGREP_GST_FIELD_MESSAGE) !=
+        (pred.op == MYGREP_GST_OP_CONTAINS)) {
+      *error = "only the message is searched, with contains";
+      goto fail;
+    }
+    if (mygrep_gst_is_name (pred.field) && pred.op != MYGREP_GST_OP_EQ &&
+        pred.op != MYGREP_GST_OP_NE) {
+      *error = "names compare only with = and !=";
+      goto fail;
+    }
+
+    /* the value, up to a space or quoted */
+    p = mygrep_gst_spaces (p, e);
+    if (p < e && *p == '"') {
+      s = ++p;
+      p = mygrep_gst_until (p, e, '"');
+      if (p == e) {
+        *error = "missing \"";
+        goto fail;
+      }
+      pred.value = strndup (s, p - s);
+      pred.value_len = p++ - s;
+    } else {
+      s = p;
+      p = mygrep_gst_until (p, e, ' ');
+      pred.value = strndup (s, p - s);
+      pred.value_len = p - s;
+    }
+    if (!pred.value_len) {
+      free (pred.value);
+      *error = "missing value";
+      goto fail;
+    }
+
+    if (pred.op == MYGREP_GST_OP_CONTAINS) {
+      pred.pattern = mygrep_pattern_new_full (pred.value, pred.value_len,
+          MYGREP_ALGO_AUTO, flags);
+    } else if (!mygrep_gst_is_name (pred.field) &&
+        !mygrep_gst_value (pred.field, pred.value,
+            pred.value + pred.value_len, &pred.number)) {
+      free (pred.value);
+      *error = pred.field == MYGREP_GST_FIELD_LEVEL ? "unknown level" :
+          "bad number";
+      goto fail;
+    }
+
+    q->predicates = realloc (q->predicates,
+        (q->n_predicates + 1) * sizeof (MygrepGstPredicate));
+    q->predicates[q->n_predicates++] = pred;
+
+    p = mygrep_gst_spaces (p, e);
+    if (p == e)
+      break;
+    if (e - p < 4 || strncasecmp (p, "and ", 4)) {
+      *error = "expected and";
+      goto fail;
+    }
+    p += 4;
+  }
+
+  return q;
+
+fail:
+  mygrep_gstquery_free (q);
+  return NULL;
+}
+
+void
+mygrep_gstquery_free (MygrepGstQuery * q)
+{
+  int i;
+
+  for (i = 0; i < q->n_predicates; i++) {
+    if (q->predicates[i].pattern)
+      mygrep_pattern_free (q->predicates[i].pattern);
+    free (q->predicates[i].value);
+  }
+  free (q->predicates);
+  free (q);
+}
+
+/* The plain loops, for the wider columns */
+static void
+mygrep_gst_select_u32 (const uint32_t * column, size_t n, uint32_t lo,
+    uint32_t hi, int outside, uint8_t * keep)
+{
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    keep[i] &= -(uint8_t) ((column[i] - lo <= hi - lo) != outside);
+}
+
+static void
+mygrep_gst_select_u64 (const uint64_t * column, size_t n, uint64_t lo,
+    uint64_t hi, uint8_t * keep)
+{
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    keep[i] &= -(uint8_t) (column[i] - lo <= hi - lo);
+}
+
+/* [lo, hi] of @pred in [min, max], @outside for !=. Returns 0 if no row
+ * can match, 2 if every one does. */
+static int
+mygrep_gst_range (const MygrepGstPredicate * pred, int64_t min, int64_t max,
+    int64_t * lo, int64_t * hi, int *outside)
+{
+  int64_t v = pred->number;
+
+  *lo = min;
+  *hi = max;
+  *outside = 0;
+  switch (pred->op) {
+    case MYGREP_GST_OP_EQ:
+    case MYGREP_GST_OP_NE:
+      *outside = pred->op == MYGREP_GST_OP_NE;
+      if (v < min || v > max)
+        return *outside ? 2 : 0;
+      *lo = *hi = v;
+      return 1;
+    case MYGREP_GST_OP_LT:
+      *hi = v - 1;
+      break;
+    case MYGREP_GST_OP_LE:
+      *hi = v;
+      break;
+    case MYGREP_GST_OP_GT:
+      *lo = v + 1;
+      break;
+    case MYGREP_GST_OP_GE:
+      *lo = v;
+      break;
+    default:
+      break;
+  }
+
+  if (*lo < min)
+    *lo = min;
+  if (*hi > max)
+    *hi = max;
+  return *lo <= *hi ? 1 : 0;
+}
+
+size_t
+mygrep_gstquery_run (const MygrepGstQuery * query, const MygrepGstLog * log,
+    uint8_t * keep)
+{
+  const MygrepSearch *search = mygrep_search_get ();
+  size_t n = log->n_rows, i, found = 0;
+  int p, outside, range;
+
+  memset (keep, 0xff, n);
+
+  /* the columns first, the messages of what's left afterwards */
+  for (p = 0; p < query->n_predicates; p++) {
+    const MygrepGstPredicate *pred = &query->predicates[p];
+    const MygrepGstDict *dict = NULL;
+    const uint32_t *ids = NULL;
+    int64_t lo, hi, id;
+
+    switch (pred->field) {
+      case MYGREP_GST_FIELD_CATEGORY:
+        dict = &log->categories;
+        break;
+      case MYGREP_GST_FIELD_FILE:
+        dict = &log->files;
+        ids = log->file;
+        break;
+      case MYGREP_GST_FIELD_FUNCTION:
+        dict = &log->functions;
+        ids = log->function;
+        break;
+      case MYGREP_GST_FIELD_OBJECT:
+        dict = &log->objects;
+        ids = log->object;
+        break;
+      default:
+        break;
+    }
+
+    if (dict) {
+      /* a name that isn't in the log is on no line */
+      id = mygrep_gstdict_find (dict, pred->value, pred->value_len);
+      outside = pred->op == MYGREP_GST_OP_NE;
+      if (id < 0 && !outside)
+        memset (keep, 0, n);
+      else if (id >= 0 && ids)
+        mygrep_gst_select_u32 (ids, n, id, id, outside, keep);
+      else if (id >= 0)
+        search->mygrep_select_u16 (log->category, n, id, id, outside, keep);
+      continue;
+    }
+
+    switch (pred->field) {
+      case MYGREP_GST_FIELD_LEVEL:
+        range = mygrep_gst_range (pred, 0, UINT8_MAX, &lo, &hi, &outside);
+        if (range == 0)
+          memset (keep, 0, n);
+        else if (range == 1)
+          search->mygrep_select_u8 (log->level, n, lo, hi, outside, keep);
+        break;
+      case MYGREP_GST_FIELD_PID:
+      case MYGREP_GST_FIELD_LINE:
+        range = mygrep_gst_range (pred, 0, UINT32_MAX, &lo, &hi, &outside);
+        if (range == 0)
+          memset (keep, 0, n);
+        else if (range == 1)
+          mygrep_gst_select_u32 (pred->field == MYGREP_GST_FIELD_PID ?
+              log->pid : log->line, n, lo, hi, outside, keep);
+        break;
+      case MYGREP_GST_FIELD_TS:
+      case MYGREP_GST_FIELD_THREAD:
+        /* 63 bits are enough for both */
+        range = mygrep_gst_range (pred, 0, INT64_MAX, &lo, &hi, &outside);
+        if (range == 0) {
+          memset (keep, 0, n);
+        } else if (range == 1 && outside) {
+          for (i = 0; i < n; i++)
+            keep[i] &= -(uint8_t) ((pred->field == MYGREP_GST_FIELD_TS ?
+                    (uint64_t) log->ts[i] : log->thread[i]) != (uint64_t) lo);
+        } else if (range == 1) {
+          mygrep_gst_select_u64 (pred->field == MYGREP_GST_FIELD_TS ?
+              (const uint64_t *) log->ts : log->thread, n, lo, hi, keep);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  for (p = 0; p < query->n_predicates; p++) {
+    const MygrepGstPredicate *pred = &query->predicates[p];
+
+    if (!pred->pattern)
+      continue;
+    for (i = 0; i < n; i++) {
+      const char *line = log->text + log->start[i];
+
+      if (keep[i] && !mygrep_pattern_find (pred->pattern,
+              line + log->message[i], log->len[i] - log->message[i]))
+        keep[i] = 0;
+    }
+  }
+
+  for (i = 0; i < n; i++)
+    found += keep[i] & 1;
+
+  return found;
+}
@@ -0,0 +1,84 @@
+/* GStreamer debug logs of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The lines of GST_DEBUG output all look the same:
+ *
+ *   0:00:00.000015596  1234 0x55d0c DEBUG  queue gstpad.c:1069:gst_pad_push:<src> message
+ *
+ * timestamp, pid, thread, level, category, file:line:function:object and
+ * the message. The parser splits them once into a column per field: the
+ * numbers as numbers, the level as GstDebugLevel, and the names as ids of a
+ * dictionary per column. The message stays where it is in the text.
+ *
+ * A query is predicates joined by "and":
+ *
+ *   level<=WARN and category=basesrc and message contains caps
+ *
+ * level and category go over their columns with the vector predicates of
+ * MygrepSearch, a byte or two per line, the other columns in plain loops,
+ * and only the lines left have their message searched. */
+
+#ifndef MYGREP_GSTLOG_H
+#define MYGREP_GSTLOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mygrep-algo.h"
+
+/* GstDebugLevel */
+typedef enum
+{
+  MYGREP_GST_NONE = 0,
+  MYGREP_GST_ERROR = 1,
+  MYGREP_GST_WARNING = 2,
+  MYGREP_GST_FIXME = 3,
+  MYGREP_GST_INFO = 4,
+  MYGREP_GST_DEBUG = 5,
+  MYGREP_GST_LOG = 6,
+  MYGREP_GST_TRACE = 7,
+  MYGREP_GST_MEMDUMP = 9,
+} MygrepGstLevel;
+
+typedef struct _MygrepGstLog MygrepGstLog;
+typedef struct _MygrepGstQuery MygrepGstQuery;
+
+/* The @size bytes of @text have to stay around as long as the log. Lines
+ * that aren't debug lines are skipped. */
+MygrepGstLog *mygrep_gstlog_parse (const char *text, size_t size);
+void mygrep_gstlog_free (MygrepGstLog * log);
+
+size_t mygrep_gstlog_rows (const MygrepGstLog * log);
+size_t mygrep_gstlog_skipped (const MygrepGstLog * log);
+
+/* NULL and a static @error if @query doesn't parse. The fields are ts
+ * (nanoseconds or 0:00:05.1), pid, thread, level (a name or a number),
+ * category, file, line, function, object, compared with = != < <= > >=,
+ * names only with = and !=, and "message contains" a string. A value with
+ * spaces goes in double quotes. @flags are for the message. */
+MygrepGstQuery *mygrep_gstquery_new (const char *query,
+    MygrepPatternFlags flags, const char **error);
+void mygrep_gstquery_free (MygrepGstQuery * query);
+
+/* Sets @keep to 0xff for the rows of @log that match and 0 for the rest,
+ * and returns how many match */
+size_t mygrep_gstquery_run (const MygrepGstQuery * query,
+    const MygrepGstLog * log, uint8_t * keep);
+
+#endif
@@ -0,0 +1,384 @@
+/* Benchmark harness of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define _GNU_SOURCE
+#include "mygrep-harness.h"
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined (__x86_64__) || defined (__i386__)
+#include <x86intrin.h>
+#define MYGREP_HAVE_TSC 1
+#endif
+
+static const char *metric_names[] = {
+  "time_ns", "cycles", "branch_misses"
+};
+
+struct _MygrepHarness
+{
+  int warmup, runs, cpu;
+  int run;
+
+  /* perf_event_open () of the cycles and the branch misses, -1 if none */
+  int fds[MYGREP_HARNESS_LAST];
+  int have[MYGREP_HARNESS_LAST];
+
+  int64_t start[MYGREP_HARNESS_LAST];
+  /* runs of every metric */
+  int64_t *samples[MYGREP_HARNESS_LAST];
+};
+
+static int64_t
+mygrep_harness_now (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * (int64_t) 1000000000 + ts.tv_nsec;
+}
+
+#ifdef __linux__
+/* The threads the run starts count too, they are inherited */
+static int
+mygrep_harness_perf_open (uint64_t config)
+{
+  struct perf_event_attr attr;
+
+  memset (&attr, 0, sizeof (attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof (attr);
+  attr.config = config;
+  attr.disabled = 1;
+  attr.inherit = 1;
+  /* what perf_event_paranoid = 2 still allows */
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+  return syscall (SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+MygrepHarness *
+mygrep_harness_new (int warmup, int runs, int cpu)
+{
+  MygrepHarness *harness;
+  int m;
+
+  if (cpu >= 0) {
+    cpu_set_t set;
+
+    CPU_ZERO (&set);
+    CPU_SET (cpu, &set);
+    if (sched_setaffinity (0, sizeof (set), &set) < 0)
+      return NULL;
+  }
+
+  harness = calloc (1, sizeof (MygrepHarness));
+  if (!harness)
+    return NULL;
+  harness->warmup = warmup > 0 ? warmup : 0;
+  harness->runs = runs > 0 ? runs : 1;
+  harness->cpu = cpu;
+
+  for (m = 0; m < MYGREP_HARNESS_LAST; m++)
+    harness->fds[m] = -1;
+  for (m = 0; m < MYGREP_HARNESS_LAST; m++) {
+    harness->samples[m] = calloc (harness->runs, sizeof (int64_t));
+    if (!harness->samples[m]) {
+      mygrep_harness_free (harness);
+      return NULL;
+    }
+  }
+  harness->have[MYGREP_HARNESS_TIME] = 1;
+
+#ifdef __linux__
+  harness->fds[MYGREP_HARNESS_CYCLES] =
+      mygrep_harness_perf_open (PERF_COUNT_HW_CPU_CYCLES);
+  harness->fds[MYGREP_HARNESS_BRANCH_MISSES] =
+      mygrep_harness_perf_open (PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+  harness->have[MYGREP_HARNESS_BRANCH_MISSES] =
+      harness->fds[MYGREP_HARNESS_BRANCH_MISSES] >= 0;
+#ifdef MYGREP_HAVE_TSC
+  harness->have[MYGREP_HARNESS_CYCLES] = 1;
+#else
+  harness->have[MYGREP_HARNESS_CYCLES] =
+      harness->fds[MYGREP_HARNESS_CYCLES] >= 0;
+#endif
+
+  return harness;
+}
+
+void
+mygrep_harness_free (MygrepHarness * harness)
+{
+  int m;
+
+  for (m = 0; m < MYGREP_HARNESS_LAST; m++) {
+    if (harness->fds[m] >= 0)
+      close (harness->fds[m]);
+    free (harness->samples[m]);
+  }
+  free (harness);
+}
+
+int
+mygrep_harness_total_runs (const MygrepHarness * harness)
+{
+  return harness->warmup + harness->runs;
+}
+
+const char *
+mygrep_harness_counter (const MygrepHarness * harness)
+{
+  return harness->fds[MYGREP_HARNESS_CYCLES] >= 0 ? "perf" : "tsc";
+}
+
+static int64_t
+mygrep_harness_read (const MygrepHarness * harness, int m)
+{
+  int64_t value = 0;
+
+  if (harness->fds[m] >= 0) {
+    if (read (harness->fds[m], &value, sizeof (value)) != sizeof (value))
+      value = 0;
+    return value;
+  }
+
+#ifdef MYGREP_HAVE_TSC
+  if (m == MYGREP_HARNESS_CYCLES)
+    value = __rdtsc ();
+#endif
+
+  return value;
+}
+
+void
+mygrep_harness_start (MygrepHarness * harness)
+{
+  int m;
+
+#ifdef __linux__
+  for (m = 1; m < MYGREP_HARNESS_LAST; m++) {
+    if (harness->fds[m] >= 0) {
+      ioctl (harness->fds[m], PERF_EVENT_IOC_RESET, 0);
+      ioctl (harness->fds[m], PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+#endif
+
+  for (m = 1; m < MYGREP_HARNESS_LAST; m++)
+    harness->start[m] = mygrep_harness_read (harness, m);
+  harness->start[MYGREP_HARNESS_TIME] = mygrep_harness_now ();
+}
+
+int64_t
+mygrep_harness_stop (MygrepHarness * harness)
+{
+  int64_t end[MYGREP_HARNESS_LAST];
+  int m, measured = harness->run - harness->warmup;
+
+  end[MYGREP_HARNESS_TIME] = mygrep_harness_now ();
+  for (m = 1; m < MYGREP_HARNESS_LAST; m++)
+    end[m] = mygrep_harness_read (harness, m);
+
+#ifdef __linux__
+  for (m = 1; m < MYGREP_HARNESS_LAST; m++) {
+    if (harness->fds[m] >= 0)
+      ioctl (harness->fds[m], PERF_EVENT_IOC_DISABLE, 0);
+  }
+#endif
+
+  if (measured >= 0 && measured < harness->runs) {
+    for (m = 0; m < MYGREP_HARNESS_LAST; m++)
+      harness->samples[m][measured] = end[m] - harness->start[m];
+  }
+  harness->run++;
+
+  return end[MYGREP_HARNESS_TIME] - harness->start[MYGREP_HARNESS_TIME];
+}
+
+static int
+mygrep_harness_compare (const void *a, const void *b)
+{
+  double x = *(const double *) a, y = *(const double *) b;
+
+  return x < y ? -1 : x > y;
+}
+
+/* Linear between the closest ranks */
+static double
+mygrep_harness_percentile (const double *sorted, int n, double p)
+{
+  double rank = p * (n - 1);
+  int i = (int) rank;
+
+  if (i + 1 >= n)
+    return sorted[n - 1];
+
+  return sorted[i] + (rank - i) * (sorted[i + 1] - sorted[i]);
+}
+
+int
+mygrep_harness_stats (const MygrepHarness * harness,
+    MygrepHarnessMetric metric, MygrepHarnessStats * stats)
+{
+  int n = harness->run - harness->warmup, i, lo, hi;
+  double *sorted, sum = 0, half;
+
+  if (!harness->have[metric] || n <= 0)
+    return -1;
+  if (n > harness->runs)
+    n = harness->runs;
+
+  sorted = malloc (n * sizeof (double));
+  for (i = 0; i < n; i++) {
+    sorted[i] = harness->samples[metric][i];
+    sum += sorted[i];
+  }
+  qsort (sorted, n, sizeof (double), mygrep_harness_compare);
+
+  stats->n = n;
+  stats->min = sorted[0];
+  stats->max = sorted[n - 1];
+  stats->mean = sum / n;
+  stats->median = mygrep_harness_percentile (sorted, n, 0.5);
+  stats->p5 = mygrep_harness_percentile (sorted, n, 0.05);
+  stats->p95 = mygrep_harness_percentile (sorted, n, 0.95);
+
+  /* the ranks the median lies between with 95% probability, from the
+   * normal approximation of the binomial distribution */
+  half = 1.96 * sqrt (n) / 2;
+  lo = (int) floor (n / 2.0 - half) - 1;
+  hi = (int) ceil (n / 2.0 + half);
+  stats->ci_low = sorted[lo < 0 ? 0 : lo];
+  stats->ci_high = sorted[hi > n - 1 ? n - 1 : hi];
+
+  free (sorted);
+  return 0;
+}
+
+void
+mygrep_harness_print (const MygrepHarness * harness)
+{
+  MygrepHarnessStats stats;
+
+  if (mygrep_harness_stats (harness, MYGREP_HARNESS_TIME, &stats) < 0)
+    return;
+
+  printf ("%d runs (+%d warmup)%s: median %.0f us, 95%% CI [%.0f, %.0f] us, "
+      "p5 %.0f us, p95 %.0f us\n", stats.n, harness->warmup,
+      harness->cpu >= 0 ? " pinned" : "", stats.median / 1e3,
+      stats.ci_low / 1e3, stats.ci_high / 1e3, stats.p5 / 1e3,
+      stats.p95 / 1e3);
+
+  if (!mygrep_harness_stats (harness, MYGREP_HARNESS_CYCLES, &stats))
+    printf ("  cycles (%s): median %.0f\n", mygrep_harness_counter (harness),
+        stats.median);
+  if (!mygrep_harness_stats (harness, MYGREP_HARNESS_BRANCH_MISSES, &stats))
+    printf ("  branch misses: median %.0f\n", stats.median);
+}
+
+static void
+mygrep_harness_json_string (FILE * f, const char *s)
+{
+  fputc ('"', f);
+  for (; *s; s++) {
+    unsigned char c = *s;
+
+    if (c == '"' || c == '\\')
+      fprintf (f, "\\%c", c);
+    else if (c < 0x20)
+      fprintf (f, "\\u%04x", c);
+    else
+      fputc (c, f);
+  }
+  fputc ('"', f);
+}
+
+int
+mygrep_harness_write_json (const MygrepHarness * harness,
+    const char *fname, const char *tool, const char *variant,
+    const char *engine, const char *const *strings, int n_strings,
+    size_t matches)
+{
+  MygrepHarnessStats stats;
+  FILE *f;
+  int m, i, err;
+
+  f = fopen (fname, "a");
+  if (!f)
+    return -1;
+
+  fprintf (f, "{\"tool\": ");
+  mygrep_harness_json_string (f, tool);
+  fprintf (f, ", \"variant\": ");
+  mygrep_harness_json_string (f, variant);
+  fprintf (f, ", \"engine\": ");
+  mygrep_harness_json_string (f, engine);
+  fprintf (f, ", \"strings\": [");
+  for (i = 0; i < n_strings; i++) {
+    fprintf (f, i ? ", " : "");
+    mygrep_harness_json_string (f, strings[i]);
+  }
+  fprintf (f, "], \"matches\": %zu, \"warmup\": %d, \"cpu\": %d, "
+      "\"counter\": \"%s\"", matches, harness->warmup, harness->cpu,
+      mygrep_harness_counter (harness));
+
+  for (m = 0; m < MYGREP_HARNESS_LAST; m++) {
+    if (mygrep_harness_stats (harness, m, &stats) < 0) {
+      fprintf (f, ", \"%s\": null", metric_names[m]);
+      continue;
+    }
+
+    fprintf (f, ", \"%s\": {\"n\": %d, \"min\": %.0f, \"max\": %.0f, "
+        "\"mean\": %.1f, \"median\": %.1f, \"p5\": %.1f, \"p95\": %.1f, "
+        "\"ci95\": [%.1f, %.1f], \"samples\": [", metric_names[m], stats.n,
+        stats.min, stats.max, stats.mean, stats.median, stats.p5, stats.p95,
+        stats.ci_low, stats.ci_high);
+    for (i = 0; i < stats.n; i++)
+      fprintf (f, "%s%" PRId64, i ? ", " : "", harness->samples[m][i]);
+    fprintf (f, "]}");
+  }
+  fprintf (f, "}\n");
+
+  err = ferror (f);
+  if (fclose (f) != 0 || err) {
+    if (!errno)
+      errno = EIO;
+    return -1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,92 @@
+/* Benchmark harness of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Times the runs of a search the way a comparison of two builds needs: a
+ * few warmup runs first, which fault the pages in and settle the caches and
+ * the clock, then every run on its own, so the result is a distribution and
+ * not one total. The median goes with the 95% confidence interval of the
+ * median, which needs no assumption about the shape of the distribution.
+ *
+ * Besides the time, every run reads the cycles and the branch misses of
+ * the process from perf_event_open (), where the kernel allows it (see
+ * /proc/sys/kernel/perf_event_paranoid). Otherwise the cycles come from
+ * the TSC, and there are no branch misses. Pinning to a CPU keeps the
+ * scheduler from moving the runs around.
+ *
+ * The results go to a JSON file, a line per harness, so the runs of the
+ * likely, pure and vector variants can be appended to the same file and
+ * compared. */
+
+#ifndef MYGREP_HARNESS_H
+#define MYGREP_HARNESS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum
+{
+  MYGREP_HARNESS_TIME,
+  MYGREP_HARNESS_CYCLES,
+  MYGREP_HARNESS_BRANCH_MISSES,
+  MYGREP_HARNESS_LAST
+} MygrepHarnessMetric;
+
+typedef struct
+{
+  int n;
+  double min, max, mean;
+  double median, p5, p95;
+  /* of the median */
+  double ci_low, ci_high;
+} MygrepHarnessStats;
+
+typedef struct _MygrepHarness MygrepHarness;
+
+/* @cpu < 0 leaves the affinity as it is. Returns NULL and leaves errno if
+ * the pinning or an allocation fails. */
+MygrepHarness *mygrep_harness_new (int warmup, int runs, int cpu);
+void mygrep_harness_free (MygrepHarness * harness);
+
+/* Warmup runs included */
+int mygrep_harness_total_runs (const MygrepHarness * harness);
+
+/* Bracket a run. Stop returns its time in ns, be it a warmup run or not. */
+void mygrep_harness_start (MygrepHarness * harness);
+int64_t mygrep_harness_stop (MygrepHarness * harness);
+
+/* "perf" or "tsc", where the cycles come from */
+const char *mygrep_harness_counter (const MygrepHarness * harness);
+
+/* Of the measured runs. Returns -1 if the metric wasn't measured. */
+int mygrep_harness_stats (const MygrepHarness * harness,
+    MygrepHarnessMetric metric, MygrepHarnessStats * stats);
+
+/* Median time and its interval, and the medians of the counters */
+void mygrep_harness_print (const MygrepHarness * harness);
+
+/* Appends a line with the stats and the samples to @fname. @tool and
+ * @variant name the build, @engine how it searched. Returns -1 and leaves
+ * errno on failure. */
+int mygrep_harness_write_json (const MygrepHarness * harness,
+    const char *fname, const char *tool, const char *variant,
+    const char *engine, const char *const *strings, int n_strings,
+    size_t matches);
+
+#endif
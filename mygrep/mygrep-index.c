@@ -0,0 +1,450 @@
+/* Trigram index of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define _GNU_SOURCE
+#include "mygrep-index.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MYGREP_INDEX_MAGIC "MYGREPIX"
+/* 2: digits and punctuation are not folded into the letters anymore */
+#define MYGREP_INDEX_VERSION 2
+#define MYGREP_INDEX_BUCKETS (1 << 16)
+
+/* The file: this, a checksum per block, then a bitmap of the blocks per
+ * bucket, all of it in 64 bit words */
+typedef struct
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t block_size;
+  uint64_t source_size;
+  int64_t mtime_sec, mtime_nsec;
+  uint64_t n_blocks;
+  /* per bitmap */
+  uint64_t words;
+  /* of the checksums of the blocks */
+  uint64_t checksum;
+} MygrepIndexHeader;
+
+struct _MygrepIndex
+{
+  void *map;
+  size_t map_size;
+
+  const MygrepIndexHeader *header;
+  const uint64_t *sums;
+  const uint64_t *bitmaps;
+};
+
+typedef struct
+{
+  const char *where;
+  size_t size, block_size;
+  uint64_t *sums, *bitmaps;
+  size_t words;
+
+  /* blocks [first, last) */
+  size_t first, last;
+  pthread_t thread;
+  int started;
+  /* out of memory, the index can't be written */
+  int failed;
+} MygrepIndexRange;
+
+static inline uint32_t
+mygrep_index_bucket (const uint8_t * p)
+{
+  uint32_t t = 0;
+  int i;
+
+  for (i = 0; i < 3; i++)
+    t = t << 8 | ((unsigned) (p[i] - 'A') < 26 ? p[i] | 0x20 : p[i]);
+
+  return (t * 0x9e3779b1u) >> 16;
+}
+
+/* Four lanes of multiply and rotate, eight bytes each, so they overlap */
+static uint64_t
+mygrep_index_checksum (const char *p, size_t size)
+{
+  const uint64_t k = 0x9e3779b97f4a7c15ull;
+  uint64_t h[4] = { size, k, k << 1, k << 2 }, w;
+  size_t i = 0;
+  int l;
+
+  for (; i + 32 <= size; i += 32) {
+    for (l = 0; l < 4; l++) {
+      memcpy (&w, p + i + l * 8, 8);
+      h[l] = (h[l] ^ w) * k;
+      h[l] ^= h[l] >> 29;
+    }
+  }
+  for (; i < size; i++)
+    h[0] = (h[0] ^ (uint8_t) p[i]) * k;
+
+  return (h[0] ^ (h[1] >> 1) ^ (h[2] >> 2) ^ (h[3] >> 3)) * k;
+}
+
+static void *
+mygrep_index_range_run (void *data)
+{
+  MygrepIndexRange *r = data;
+  uint64_t *seen = malloc (MYGREP_INDEX_BUCKETS / 8);
+  size_t b;
+
+  if (!seen) {
+    r->failed = 1;
+    return NULL;
+  }
+
+  for (b = r->first; b < r->last; b++) {
+    const uint8_t *p = (const uint8_t *) r->where + b * r->block_size;
+    size_t len = r->size - b * r->block_size, i, w;
+
+    if (len > r->block_size)
+      len = r->block_size;
+    r->sums[b] = mygrep_index_checksum ((const char *) p, len);
+
+    /* the trigrams that start in the block, the bitmaps take them a
+     * bucket at a time afterwards */
+    memset (seen, 0, MYGREP_INDEX_BUCKETS / 8);
+    for (i = 0; i < len && b * r->block_size + i + 2 < r->size; i++) {
+      uint32_t bucket = mygrep_index_bucket (p + i);
+
+      seen[bucket >> 6] |= 1ull << (bucket & 63);
+    }
+
+    for (w = 0; w < MYGREP_INDEX_BUCKETS / 64; w++) {
+      uint64_t bits = seen[w];
+
+      for (; bits; bits &= bits - 1) {
+        size_t bucket = w * 64 + __builtin_ctzll (bits);
+
+        r->bitmaps[bucket * r->words + b / 64] |= 1ull << (b % 64);
+      }
+    }
+  }
+
+  free (seen);
+  return NULL;
+}
+
+int
+mygrep_index_build (const char *index_fname, const char *fname,
+    const char *where, size_t size, size_t block_size, int threads)
+{
+  MygrepIndexHeader header;
+  MygrepIndexRange *ranges;
+  uint64_t *sums, *bitmaps;
+  size_t n_blocks, words, per_thread;
+  struct stat st;
+  char *tmp;
+  FILE *f;
+  int t, ret = 0;
+
+  if (stat (fname, &st) < 0)
+    return -1;
+
+  if (block_size == 0)
+    block_size = MYGREP_INDEX_BLOCK;
+  n_blocks = (size + block_size - 1) / block_size;
+  words = (n_blocks + 63) / 64;
+
+  sums = calloc (n_blocks ? n_blocks : 1, sizeof (uint64_t));
+  bitmaps = calloc ((size_t) MYGREP_INDEX_BUCKETS * (words ? words : 1),
+      sizeof (uint64_t));
+  if (!sums || !bitmaps) {
+    free (sums);
+    free (bitmaps);
+    errno = ENOMEM;
+    return -1;
+  }
+
+  /* whole words of the bitmaps per thread, so they write apart */
+  if (threads < 1)
+    threads = 1;
+  if ((size_t) threads > words)
+    threads = words ? words : 1;
+  per_thread = (words + threads - 1) / threads * 64;
+
+  ranges = calloc (threads, sizeof (MygrepIndexRange));
+  if (!ranges) {
+    free (sums);
+    free (bitmaps);
+    errno = ENOMEM;
+    return -1;
+  }
+  for (t = 0; t < threads; t++) {
+    MygrepIndexRange *r = &ranges[t];
+
+    r->where = where;
+    r->size = size;
+    r->block_size = block_size;
+    r->sums = sums;
+    r->bitmaps = bitmaps;
+    r->words = words;
+    r->first = t * per_thread < n_blocks ? t * per_thread : n_blocks;
+    r->last = (t + 1) * per_thread < n_blocks ? (t + 1) * per_thread :
+        n_blocks;
+
+    if (t > 0)
+      r->started = !pthread_create (&r->thread, NULL,
+          mygrep_index_range_run, r);
+  }
+  mygrep_index_range_run (&ranges[0]);
+  for (t = 1; t < threads; t++) {
+    if (ranges[t].started)
+      pthread_join (ranges[t].thread, NULL);
+    else
+      mygrep_index_range_run (&ranges[t]);
+  }
+  for (t = 0; t < threads; t++)
+    ret |= ranges[t].failed;
+  free (ranges);
+  if (ret) {
+    free (sums);
+    free (bitmaps);
+    errno = ENOMEM;
+    return -1;
+  }
+
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, MYGREP_INDEX_MAGIC, sizeof (header.magic));
+  header.version = MYGREP_INDEX_VERSION;
+  header.block_size = block_size;
+  header.source_size = size;
+  header.mtime_sec = st.st_mtim.tv_sec;
+  header.mtime_nsec = st.st_mtim.tv_nsec;
+  header.n_blocks = n_blocks;
+  header.words = words;
+  header.checksum = mygrep_index_checksum ((const char *) sums,
+      n_blocks * sizeof (uint64_t));
+
+  /* a query never sees half an index */
+  if (asprintf (&tmp, "%s.XXXXXX", index_fname) < 0) {
+    free (sums);
+    free (bitmaps);
+    return -1;
+  }
+
+  t = mkstemp (tmp);
+  if (t < 0) {
+    ret = -1;
+  } else if (fchmod (t, st.st_mode & 0666) < 0) {
+    close (t);
+    ret = -1;
+  } else if (!(f = fdopen (t, "wb"))) {
+    close (t);
+    ret = -1;
+  } else {
+    if (fwrite (&header, sizeof (header), 1, f) != 1 ||
+        fwrite (sums, sizeof (uint64_t), n_blocks, f) != n_blocks ||
+        fwrite (bitmaps, sizeof (uint64_t), MYGREP_INDEX_BUCKETS * words,
+            f) != MYGREP_INDEX_BUCKETS * words)
+      ret = -1;
+    if (fclose (f) != 0)
+      ret = -1;
+  }
+
+  if (ret == 0 && rename (tmp, index_fname) < 0)
+    ret = -1;
+  if (ret < 0 && t >= 0) {
+    int saved = errno;
+
+    unlink (tmp);
+    errno = saved;
+  }
+
+  free (tmp);
+  free (sums);
+  free (bitmaps);
+  return ret;
+}
+
+MygrepIndex *
+mygrep_index_open (const char *index_fname, const char *fname)
+{
+  const MygrepIndexHeader *header;
+  MygrepIndex *index;
+  struct stat st, ist;
+  void *map;
+  int fd;
+
+  if (stat (fname, &st) < 0)
+    return NULL;
+
+  fd = open (index_fname, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  if (fstat (fd, &ist) < 0) {
+    close (fd);
+    return NULL;
+  }
+  if ((size_t) ist.st_size < sizeof (MygrepIndexHeader)) {
+    close (fd);
+    errno = EINVAL;
+    return NULL;
+  }
+
+  map = mmap (NULL, ist.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    return NULL;
+
+  header = map;
+  if (memcmp (header->magic, MYGREP_INDEX_MAGIC, sizeof (header->magic)) ||
+      header->version != MYGREP_INDEX_VERSION || header->block_size == 0 ||
+      header->words != (header->n_blocks + 63) / 64 ||
+      (uint64_t) ist.st_size != sizeof (MygrepIndexHeader) +
+      (header->n_blocks + (uint64_t) MYGREP_INDEX_BUCKETS * header->words) *
+      sizeof (uint64_t)) {
+    munmap (map, ist.st_size);
+    errno = EINVAL;
+    return NULL;
+  }
+
+  if (header->source_size != (uint64_t) st.st_size ||
+      header->mtime_sec != st.st_mtim.tv_sec ||
+      header->mtime_nsec != st.st_mtim.tv_nsec) {
+    munmap (map, ist.st_size);
+    errno = ESTALE;
+    return NULL;
+  }
+
+  index = calloc (1, sizeof (MygrepIndex));
+  index->map = map;
+  index->map_size = ist.st_size;
+  index->header = header;
+  index->sums = (const uint64_t *) (header + 1);
+  index->bitmaps = index->sums + header->n_blocks;
+
+  return index;
+}
+
+void
+mygrep_index_close (MygrepIndex * index)
+{
+  munmap (index->map, index->map_size);
+  free (index);
+}
+
+size_t
+mygrep_index_blocks (const MygrepIndex * index)
+{
+  return index->header->n_blocks;
+}
+
+/* Bit b of @cand: a match may start in block b */
+static void
+mygrep_index_candidates (const MygrepIndex * index,
+    const MygrepPattern * pattern, uint64_t * cand)
+{
+  const uint8_t *what = (const uint8_t *) mygrep_pattern_what (pattern);
+  size_t len = mygrep_pattern_length (pattern), words = index->header->words;
+  size_t n_blocks = index->header->n_blocks, i, w;
+  int fold = mygrep_pattern_ignores_case (pattern);
+
+  memset (cand, 0xff, words * sizeof (uint64_t));
+  if (n_blocks % 64)
+    cand[words - 1] = (1ull << (n_blocks % 64)) - 1;
+
+  if (len < 3 || len > index->header->block_size)
+    return;
+
+  for (i = 0; i + 3 <= len; i++) {
+    const uint64_t *row;
+
+    /* the other cases of a non ASCII letter differ in more than bit 0x20 */
+    if (fold && (what[i] | what[i + 1] | what[i + 2]) >= 0x80)
+      continue;
+
+    row = index->bitmaps + mygrep_index_bucket (what + i) * words;
+    /* in the block, or the next one */
+    for (w = 0; w < words; w++) {
+      uint64_t next = w + 1 < words ? row[w + 1] << 63 : 0;
+
+      cand[w] &= row[w] | row[w] >> 1 | next;
+    }
+  }
+}
+
+int
+mygrep_index_count (const MygrepIndex * index, const MygrepPattern * pattern,
+    const char *where, size_t size, size_t *count, size_t *candidates)
+{
+  const MygrepIndexHeader *header = index->header;
+  size_t block_size = header->block_size, len, pos = 0, w;
+  uint64_t *cand;
+
+  *count = 0;
+  *candidates = 0;
+  if (size != header->source_size) {
+    errno = ESTALE;
+    return -1;
+  }
+
+  len = mygrep_pattern_length (pattern);
+  if (len == 0 || len > size)
+    return 0;
+
+  cand = malloc (header->words * sizeof (uint64_t));
+  mygrep_index_candidates (index, pattern, cand);
+
+  for (w = 0; w < header->words; w++) {
+    uint64_t bits;
+
+    for (bits = cand[w]; bits; bits &= bits - 1) {
+      size_t b = w * 64 + __builtin_ctzll (bits), resume;
+      size_t start = b * block_size, end = start + block_size, stop;
+
+      if (end > size)
+        end = size;
+      if (mygrep_index_checksum (where + start, end - start) !=
+          index->sums[b]) {
+        free (cand);
+        errno = ESTALE;
+        return -1;
+      }
+      (*candidates)++;
+
+      /* the matches that start in the block, after the last one counted */
+      if (pos < start)
+        pos = start;
+      if (pos >= end)
+        continue;
+      stop = end + len - 1 < size ? end + len - 1 : size;
+      *count += mygrep_pattern_count (pattern, where + pos, stop - pos,
+          &resume);
+      pos += resume;
+    }
+  }
+
+  free (cand);
+  return 0;
+}
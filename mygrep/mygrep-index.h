@@ -0,0 +1,72 @@
+/* Trigram index of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* A sidecar file that narrows the search of a big file down to the blocks
+ * that may have a match, for the same file searched over and over.
+ *
+ * The file is cut in blocks (64 KiB), and every trigram of a block, with
+ * the ASCII letters in lower case, is hashed to one of 65536 buckets. Per
+ * bucket there's a bitmap of the blocks that have one of its trigrams. The
+ * blocks a pattern may start in are the ones where every trigram of the
+ * pattern is in the block or the next one (it can go over), which is an
+ * AND of a few bitmaps, and only those blocks get searched. Hashing loses
+ * nothing: a bucket has more blocks than its trigram, never fewer.
+ *
+ * The index keeps the size and the modification time of the file, which
+ * have to be the same to open it, and a checksum of every block, which is
+ * checked as the block is searched: a file changed behind the index makes
+ * the count fail instead of being wrong. Patterns shorter than a trigram,
+ * or longer than a block, search everything.
+ *
+ * The index is built in as many threads as given, a range of blocks each,
+ * and read with mmap (): a query touches the bitmaps of its trigrams and
+ * the blocks they point to, nothing else. */
+
+#ifndef MYGREP_INDEX_H
+#define MYGREP_INDEX_H
+
+#include <stddef.h>
+#include "mygrep-algo.h"
+
+#define MYGREP_INDEX_BLOCK (64 << 10)
+#define MYGREP_INDEX_SUFFIX ".mgi"
+
+typedef struct _MygrepIndex MygrepIndex;
+
+/* Writes the index of the @size bytes of @fname at @where to @index_fname,
+ * through a temporary file. Returns -1 and leaves errno on failure. */
+int mygrep_index_build (const char *index_fname, const char *fname,
+    const char *where, size_t size, size_t block_size, int threads);
+
+/* NULL and errno if it can't be read, ESTALE if it's not of @fname as it
+ * is now */
+MygrepIndex *mygrep_index_open (const char *index_fname, const char *fname);
+void mygrep_index_close (MygrepIndex * index);
+
+size_t mygrep_index_blocks (const MygrepIndex * index);
+
+/* @count gets what mygrep_pattern_count () would over the whole file at
+ * @where, and @candidates the blocks searched for it. Returns -1 with
+ * ESTALE if a block isn't what was indexed. */
+int mygrep_index_count (const MygrepIndex * index,
+    const MygrepPattern * pattern, const char *where, size_t size,
+    size_t *count, size_t *candidates);
+
+#endif
@@ -0,0 +1,372 @@
+/* Input of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define _GNU_SOURCE
+#include "mygrep-input.h"
+#include "mygrep-decode.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int
+mygrep_file_map (MygrepFile * file, const char *fname)
+{
+  struct stat st;
+  char *area;
+  size_t page = sysconf (_SC_PAGESIZE);
+  int fd, err;
+
+  fd = open (fname, O_RDONLY);
+  if (fd < 0)
+    return -1;
+
+  if (fstat (fd, &st) < 0)
+    goto fail;
+
+  /* The kernel zeroes the end of the last page of the file, but if the file
+   * fills it up, the zero has to come from a page of our own. So reserve
+   * one byte more and put the file over the start of it. */
+  file->size = st.st_size;
+  area = mmap (NULL, file->size + 1, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS,
+      -1, 0);
+  if (area == MAP_FAILED)
+    goto fail;
+
+  if (file->size && mmap (area, file->size, PROT_READ,
+          MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+    err = errno;
+    munmap (area, file->size + 1);
+    errno = err;
+    goto fail;
+  }
+  close (fd);
+
+  /* read ahead aggressively and drop the pages behind */
+  madvise (area, (file->size + page - 1) / page * page, MADV_SEQUENTIAL);
+
+  file->data = area;
+  return 0;
+
+fail:
+  err = errno;
+  close (fd);
+  errno = err;
+  return -1;
+}
+
+void
+mygrep_file_unmap (MygrepFile * file)
+{
+  munmap ((void *) file->data, file->size + 1);
+  file->data = NULL;
+}
+
+int
+mygrep_stream_init (MygrepStream * stream, const MygrepPattern * pattern,
+    size_t chunk)
+{
+  stream->pattern = pattern;
+  stream->chunk = chunk;
+  stream->kept = 0;
+  stream->count = 0;
+
+  stream->buf = malloc (chunk + mygrep_pattern_length (pattern));
+  return stream->buf ? 0 : -1;
+}
+
+void
+mygrep_stream_clear (MygrepStream * stream)
+{
+  free (stream->buf);
+  stream->buf = NULL;
+}
+
+char *
+mygrep_stream_space (MygrepStream * stream)
+{
+  return stream->buf + stream->kept;
+}
+
+void
+mygrep_stream_commit (MygrepStream * stream, size_t size)
+{
+  size_t filled = stream->kept + size, resume;
+
+  stream->count += mygrep_pattern_count (stream->pattern, stream->buf,
+      filled, &resume);
+
+  /* at most what_len - 1 bytes, the start of a match in the next piece */
+  stream->kept = filled - resume;
+  memmove (stream->buf, stream->buf + resume, stream->kept);
+}
+
+/* Every stream gets the same pieces, read once into the first one */
+static int
+mygrep_streams_read_fd (MygrepStream * streams, int n_streams, int fd)
+{
+  ssize_t got;
+  int s;
+
+  posix_fadvise (fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  for (;;) {
+    got = read (fd, mygrep_stream_space (&streams[0]), streams[0].chunk);
+    if (got == 0)
+      return 0;
+    if (got < 0) {
+      if (errno == EINTR)
+        continue;
+      return -1;
+    }
+
+    for (s = 1; s < n_streams; s++)
+      memcpy (mygrep_stream_space (&streams[s]),
+          mygrep_stream_space (&streams[0]), got);
+    for (s = 0; s < n_streams; s++)
+      mygrep_stream_commit (&streams[s], got);
+  }
+}
+
+int
+mygrep_stream_read_fd (MygrepStream * stream, int fd)
+{
+  return mygrep_streams_read_fd (stream, 1, fd);
+}
+
+/* Compressed: the thread decompresses the pieces ahead, and every stream
+ * searches them where they are, with the bytes it kept copied in front */
+static int
+mygrep_streams_decode (MygrepStream * streams, int n_streams, int fd,
+    MygrepCodec codec, const char *head, size_t head_len)
+{
+  MygrepDecoder *decoder;
+  size_t room = 0, tail = 0, size, len, resume;
+  char *piece, *last;
+  int s;
+
+  for (s = 0; s < n_streams; s++) {
+    len = mygrep_pattern_length (streams[s].pattern);
+    if (len > room + 1)
+      room = len - 1;
+  }
+
+  /* the end of what came so far, room bytes at most */
+  last = malloc (room + 1);
+  decoder = mygrep_decoder_new (fd, codec, head, head_len, streams[0].chunk,
+      room);
+  if (!last || !decoder) {
+    free (last);
+    return -1;
+  }
+
+  while ((piece = mygrep_decoder_next (decoder, &size))) {
+    memcpy (piece - tail, last, tail);
+
+    for (s = 0; s < n_streams; s++) {
+      MygrepStream *stream = &streams[s];
+      size_t filled = stream->kept + size;
+
+      stream->count += mygrep_pattern_count (stream->pattern,
+          piece - stream->kept, filled, &resume);
+      stream->kept = filled - resume;
+    }
+
+    tail = tail + size < room ? tail + size : room;
+    memcpy (last, piece + size - tail, tail);
+  }
+
+  free (last);
+  return mygrep_decoder_free (decoder);
+}
+
+int
+mygrep_stream_count_file (const char *fname,
+    const MygrepPattern * const *patterns, int n_patterns, size_t *counts)
+{
+  MygrepStream *streams;
+  MygrepCodec codec;
+  char head[MYGREP_DECODE_MAGIC];
+  size_t head_len = 0;
+  ssize_t got;
+  int fd, ret = 0, err, s, n_init;
+
+  fd = strcmp (fname, "-") ? open (fname, O_RDONLY) : STDIN_FILENO;
+  if (fd < 0)
+    return -1;
+
+  /* a pipe can't go back, the first bytes are searched as they are if they
+   * aren't a compressed header */
+  while (head_len < sizeof (head)) {
+    got = read (fd, head + head_len, sizeof (head) - head_len);
+    if (got < 0 && errno == EINTR)
+      continue;
+    if (got < 0)
+      ret = -1;
+    if (got <= 0)
+      break;
+    head_len += got;
+  }
+  codec = mygrep_codec_detect (head, head_len);
+
+  streams = calloc (n_patterns, sizeof (MygrepStream));
+  for (n_init = 0; n_init < n_patterns && ret == 0; n_init++)
+    ret = mygrep_stream_init (&streams[n_init], patterns[n_init],
+        MYGREP_STREAM_CHUNK);
+
+  if (ret == 0 && codec != MYGREP_CODEC_NONE) {
+    ret = mygrep_streams_decode (streams, n_patterns, fd, codec, head,
+        head_len);
+  } else if (ret == 0) {
+    for (s = 0; s < n_patterns; s++) {
+      memcpy (mygrep_stream_space (&streams[s]), head, head_len);
+      mygrep_stream_commit (&streams[s], head_len);
+    }
+    ret = mygrep_streams_read_fd (streams, n_patterns, fd);
+  }
+
+  err = errno;
+  for (s = 0; s < n_init; s++) {
+    counts[s] = streams[s].count;
+    mygrep_stream_clear (&streams[s]);
+  }
+  free (streams);
+  if (fd != STDIN_FILENO)
+    close (fd);
+  errno = err;
+
+  return ret;
+}
+
+int
+mygrep_follow_open (MygrepFollow * follow, const char *fname,
+    const MygrepPattern * const *patterns, int n_patterns)
+{
+  int err, s;
+
+  follow->n_streams = 0;
+  follow->offset = 0;
+  follow->fd = -1;
+
+  /* watched before it's read, nothing written in between is missed */
+  follow->inotify = inotify_init1 (IN_CLOEXEC);
+  follow->streams = calloc (n_patterns, sizeof (MygrepStream));
+  if (!follow->streams || follow->inotify < 0 ||
+      inotify_add_watch (follow->inotify, fname,
+          IN_MODIFY | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF) < 0)
+    goto fail;
+
+  follow->fd = open (fname, O_RDONLY | O_CLOEXEC);
+  if (follow->fd < 0)
+    goto fail;
+
+  for (s = 0; s < n_patterns; s++, follow->n_streams++)
+    if (mygrep_stream_init (&follow->streams[s], patterns[s],
+            MYGREP_STREAM_CHUNK) < 0)
+      goto fail;
+
+  return 0;
+
+fail:
+  err = errno;
+  mygrep_follow_close (follow);
+  errno = err;
+  return -1;
+}
+
+void
+mygrep_follow_close (MygrepFollow * follow)
+{
+  int s;
+
+  for (s = 0; s < follow->n_streams; s++)
+    mygrep_stream_clear (&follow->streams[s]);
+  free (follow->streams);
+  follow->streams = NULL;
+  follow->n_streams = 0;
+
+  if (follow->fd >= 0)
+    close (follow->fd);
+  if (follow->inotify >= 0)
+    close (follow->inotify);
+  follow->fd = follow->inotify = -1;
+}
+
+int
+mygrep_follow_next (MygrepFollow * follow, size_t *counts)
+{
+  /* the events of all the writes since the last time come in one read */
+  char events[4096] __attribute__ ((aligned (__alignof__ (struct
+                  inotify_event))));
+  const struct inotify_event *event;
+  struct stat st;
+  ssize_t got;
+  off_t end;
+  int s;
+
+  for (;;) {
+    if (fstat (follow->fd, &st) < 0)
+      return -1;
+
+    /* truncated, what's there now is new */
+    if (st.st_size < follow->offset) {
+      if (lseek (follow->fd, 0, SEEK_SET) < 0)
+        return -1;
+      for (s = 0; s < follow->n_streams; s++)
+        follow->streams[s].kept = 0;
+      follow->offset = 0;
+    }
+
+    if (st.st_size > follow->offset) {
+      if (mygrep_streams_read_fd (follow->streams, follow->n_streams,
+              follow->fd) < 0)
+        return -1;
+      end = lseek (follow->fd, 0, SEEK_CUR);
+      if (end < 0)
+        return -1;
+      follow->offset = end;
+
+      for (s = 0; s < follow->n_streams; s++)
+        counts[s] = follow->streams[s].count;
+      return 1;
+    }
+
+    /* removed, it's open only here */
+    if (st.st_nlink == 0)
+      return 0;
+
+    /* nothing new, sleep until something happens to the file */
+    got = read (follow->inotify, events, sizeof (events));
+    if (got < 0)
+      return -1;
+
+    for (event = (const struct inotify_event *) events;
+        (const char *) event < events + got;
+        event = (const struct inotify_event *) ((const char *) (event + 1) +
+            event->len)) {
+      if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED))
+        return 0;
+    }
+  }
+}
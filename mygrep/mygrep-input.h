@@ -0,0 +1,107 @@
+/* Input of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The ways to get the bytes to search without reading the whole file into
+ * the heap first: mapping it, or going through it a chunk at a time, which
+ * also works for pipes and files bigger than the memory. */
+
+#ifndef MYGREP_INPUT_H
+#define MYGREP_INPUT_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include "mygrep-algo.h"
+
+#define MYGREP_STREAM_CHUNK (1 << 20)
+
+typedef struct
+{
+  const char *data;
+  size_t size;
+} MygrepFile;
+
+/* Maps the whole file read only. There's always a zero byte after the data,
+ * so it's a C string for the naive searches as long as the file has no zero
+ * bytes itself. Returns -1 and leaves errno on failure. */
+int mygrep_file_map (MygrepFile * file, const char *fname);
+void mygrep_file_unmap (MygrepFile * file);
+
+/* Counts the matches of bytes coming in pieces. The buffer is @chunk bytes
+ * plus the length of the pattern - 1 bytes of a match that may go on in the
+ * next piece. */
+typedef struct
+{
+  const MygrepPattern *pattern;
+
+  char *buf;
+  size_t chunk;
+  /* of the previous pieces, at the start of buf */
+  size_t kept;
+
+  size_t count;
+} MygrepStream;
+
+int mygrep_stream_init (MygrepStream * stream, const MygrepPattern * pattern,
+    size_t chunk);
+void mygrep_stream_clear (MygrepStream * stream);
+
+/* Where the next piece goes, there's room for chunk bytes */
+char *mygrep_stream_space (MygrepStream * stream);
+
+/* Searches the @size bytes written to the space */
+void mygrep_stream_commit (MygrepStream * stream, size_t size);
+
+/* Reads @fd to the end. Returns -1 and leaves errno on failure. */
+int mygrep_stream_read_fd (MygrepStream * stream, int fd);
+
+/* One pass over @fname, "-" is stdin, with MYGREP_STREAM_CHUNK pieces, for
+ * all the patterns at once: a pipe can be read only once. gzip and zstd are
+ * decompressed on the way, by a thread of their own, see mygrep-decode.h. */
+int mygrep_stream_count_file (const char *fname,
+    const MygrepPattern * const *patterns, int n_patterns, size_t *counts);
+
+/* A file that is being written, a log of a running pipeline: what's there
+ * is searched, then only what's appended, with inotify saying when. The
+ * streams keep their bytes in between, so a match written half now and
+ * half later counts once. */
+typedef struct
+{
+  MygrepStream *streams;
+  int n_streams;
+
+  int fd;
+  int inotify;
+  /* searched so far */
+  off_t offset;
+} MygrepFollow;
+
+/* Returns -1 and leaves errno on failure */
+int mygrep_follow_open (MygrepFollow * follow, const char *fname,
+    const MygrepPattern * const *patterns, int n_patterns);
+void mygrep_follow_close (MygrepFollow * follow);
+
+/* Searches what came since the last call, sleeping until there's something
+ * if there isn't. Returns 1 and the counts so far, 0 when the file is gone
+ * or moved, and -1 with errno on failure, EINTR if a signal came while it
+ * slept. A file that got shorter is searched from the start again, the
+ * counts go on. */
+int mygrep_follow_next (MygrepFollow * follow, size_t *counts);
+
+#endif
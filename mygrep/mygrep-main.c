@@ -0,0 +1,682 @@
+/* Command line of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "mygrep-main.h"
+#include "mygrep-algo.h"
+#include "mygrep-decode.h"
+#include "mygrep-fuzzy.h"
+#include "mygrep-gstlog.h"
+#include "mygrep-harness.h"
+#include "mygrep-index.h"
+#include "mygrep-input.h"
+#include "mygrep-multi.h"
+#include "mygrep-output.h"
+#include "mygrep-parallel.h"
+#include "mygrep-regex.h"
+#include "mygrep-tree.h"
+#include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* With a zero after it, for run_search () */
+static char *
+read_whole_file (const char *fname, size_t * size)
+{
+  FILE *f;
+  long fsize;
+  char *string;
+
+  f = fopen (fname, "rb");
+  if (!f) {
+    fprintf (stderr, "File %s not found\n", fname);
+    return NULL;
+  }
+
+  if (fseek (f, 0, SEEK_END) < 0 || (fsize = ftell (f)) < 0 ||
+      fseek (f, 0, SEEK_SET) < 0) {
+    fprintf (stderr, "File %s can't be read\n", fname);
+    fclose (f);
+    return NULL;
+  }
+
+  string = malloc (fsize + 1);
+  if (!string || fread (string, 1, fsize, f) != (size_t) fsize) {
+    fprintf (stderr, "File %s can't be read\n", fname);
+    free (string);
+    fclose (f);
+    return NULL;
+  }
+  fclose (f);
+
+  string[fsize] = 0;
+  *size = fsize;
+
+  return string;
+}
+
+static int64_t
+now_us (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void
+usage (void)
+{
+  fprintf (stderr, "usage:\nmygrep [--simd | --algo <auto | memchr | simd | "
+      "horspool | two-way>] [--mmap | --stream] [--threads <n>] [--scaling] "
+      "[--multi] [--runs <n>] [--warmup <n>] [--cpu <n>] [--json <file>] "
+      "[--lines] [--line-number] [--byte-offset] "
+      "[--regex] [--regex-cache <bytes>] [--ignore-case] [--index] "
+      "[--recursive [--pread]] [--gst] [--follow] [--fuzzy <errors>] "
+      "<filename | -> <string to search> [<string to search>...]\n");
+}
+
+/* ^C ends --follow with the totals */
+static volatile sig_atomic_t follow_stopped;
+
+static void
+follow_stop (int sig)
+{
+  (void) sig;
+  follow_stopped = 1;
+}
+
+int
+mygrep_main (int argc, char **argv, const MygrepTool * tool)
+{
+  char *file = NULL;
+  const char *fname;
+  const char *const *whats;
+  int64_t measurement = 0;
+  int ans = -1, nr, num_runs = 100, arg, n_whats, w;
+  int warmup = 1, cpu = -1;
+  const char *json = NULL;
+  char engine[64];
+  /* --lines prints them instead of counting */
+  int lines = 0;
+  MygrepLinesFlags line_flags = 0;
+  MygrepHarness *harness;
+  int use_mmap = 0, stream = 0, scaling = 0, threads = 1, use_multi = 0;
+  /* MYGREP_ALGO_LAST is run_search () */
+  MygrepAlgo algo = MYGREP_ALGO_LAST;
+  MygrepPattern **patterns = NULL;
+  /* --regex: the strings are regular expressions, counted by lines */
+  int use_regex = 0;
+  int ignore_case = 0;
+  size_t regex_cache = MYGREP_REGEX_CACHE;
+  MygrepRegex **regexes = NULL;
+  /* --index: the sidecar of the file, built the first time */
+  int use_index = 0;
+  MygrepIndex *index = NULL;
+  MygrepCodec codec = MYGREP_CODEC_NONE;
+  /* --recursive: the file name is a directory */
+  int recursive = 0;
+  MygrepTreeFlags tree_flags = 0;
+  MygrepTreeResult tree = { 0 };
+  /* --gst: the strings are queries over the columns of the lines */
+  int use_gst = 0;
+  MygrepGstLog *gstlog = NULL;
+  MygrepGstQuery **queries = NULL;
+  uint8_t *keep = NULL;
+  size_t *candidates = NULL;
+  /* --follow: searched as it's written, until it's gone or ^C */
+  int follow = 0;
+  /* --fuzzy: the lines with the strings give or take some errors */
+  int fuzzy_errors = -1;
+  MygrepFuzzy *fuzzy = NULL;
+  size_t length = 0, *counts;
+  MygrepMulti *multi = NULL;
+  MygrepFile map = { NULL };
+
+  for (arg = 1; arg < argc && argv[arg][0] == '-' && argv[arg][1]; arg++) {
+    if (!strcmp (argv[arg], "--simd"))
+      algo = MYGREP_ALGO_SIMD;
+    else if (!strcmp (argv[arg], "--algo") && arg + 1 < argc) {
+      algo = mygrep_algo_from_name (argv[++arg]);
+      if (algo == MYGREP_ALGO_LAST)
+        goto bad_arguments;
+    } else if (!strcmp (argv[arg], "--mmap"))
+      use_mmap = 1;
+    else if (!strcmp (argv[arg], "--stream"))
+      stream = 1;
+    else if (!strcmp (argv[arg], "--threads") && arg + 1 < argc)
+      threads = atoi (argv[++arg]);
+    else if (!strcmp (argv[arg], "--runs") && arg + 1 < argc)
+      num_runs = atoi (argv[++arg]);
+    else if (!strcmp (argv[arg], "--warmup") && arg + 1 < argc)
+      warmup = atoi (argv[++arg]);
+    else if (!strcmp (argv[arg], "--cpu") && arg + 1 < argc)
+      cpu = atoi (argv[++arg]);
+    else if (!strcmp (argv[arg], "--json") && arg + 1 < argc)
+      json = argv[++arg];
+    else if (!strcmp (argv[arg], "--scaling"))
+      scaling = 1;
+    else if (!strcmp (argv[arg], "--multi"))
+      use_multi = 1;
+    else if (!strcmp (argv[arg], "--lines"))
+      lines = 1;
+    else if (!strcmp (argv[arg], "--line-number")) {
+      lines = 1;
+      line_flags |= MYGREP_LINES_NUMBER;
+    } else if (!strcmp (argv[arg], "--byte-offset")) {
+      lines = 1;
+      line_flags |= MYGREP_LINES_OFFSET;
+    } else if (!strcmp (argv[arg], "--regex"))
+      use_regex = 1;
+    else if (!strcmp (argv[arg], "--ignore-case"))
+      ignore_case = 1;
+    else if (!strcmp (argv[arg], "--index")) {
+      /* only what the index points to is read */
+      use_index = 1;
+      use_mmap = 1;
+    } else if (!strcmp (argv[arg], "--recursive"))
+      recursive = 1;
+    else if (!strcmp (argv[arg], "--pread"))
+      tree_flags |= MYGREP_TREE_PREAD;
+    else if (!strcmp (argv[arg], "--gst"))
+      use_gst = 1;
+    else if (!strcmp (argv[arg], "--follow"))
+      follow = 1;
+    else if (!strcmp (argv[arg], "--fuzzy") && arg + 1 < argc)
+      fuzzy_errors = atoi (argv[++arg]);
+    else if (!strcmp (argv[arg], "--regex-cache") && arg + 1 < argc)
+      regex_cache = strtoul (argv[++arg], NULL, 10);
+    else
+      goto bad_arguments;
+  }
+
+  if (argc < arg + 1) {
+    fprintf (stderr, "need file name\n");
+    goto bad_arguments;
+  }
+
+  if (argc < arg + 2) {
+    fprintf (stderr, "need search string\n");
+    goto bad_arguments;
+  }
+  fname = argv[arg];
+  whats = (const char *const *) &argv[arg + 1];
+  n_whats = argc - arg - 1;
+
+  /* it would match everywhere without ever moving on, a regex of nothing
+   * matching every line is another thing */
+  for (w = 0; w < n_whats && !use_regex; w++) {
+    if (!whats[w][0]) {
+      fprintf (stderr, "can't search for an empty string\n");
+      goto bad_arguments;
+    }
+  }
+
+  /* a pipe can be read only once */
+  if (!strcmp (fname, "-")) {
+    stream = 1;
+    num_runs = 1;
+    warmup = 0;
+  } else if (recursive) {
+    /* every file on its own */
+  } else if (mygrep_codec_of_file (fname, &codec) == 0 &&
+      codec != MYGREP_CODEC_NONE) {
+    /* decompressed as it's searched, never whole */
+    printf ("%s is %s compressed\n", fname, mygrep_codec_name (codec));
+    stream = 1;
+  }
+
+  /* inotify watches a file, and the end of a compressed one can't be
+   * decompressed on its own */
+  if (follow && (!strcmp (fname, "-") || recursive ||
+          codec != MYGREP_CODEC_NONE)) {
+    fprintf (stderr, "--follow needs a plain file\n");
+    goto bad_arguments;
+  }
+  if (follow)
+    stream = 1;
+
+  /* run_search () can't go on with a match in the next chunk, nor be split
+   * over threads */
+  if ((stream || threads > 1 || scaling || lines || ignore_case ||
+          use_index || recursive || use_gst) && algo == MYGREP_ALGO_LAST)
+    algo = MYGREP_ALGO_AUTO;
+
+  if (scaling && stream) {
+    fprintf (stderr, "--scaling needs the whole file\n");
+    goto bad_arguments;
+  }
+
+  if (use_multi && stream) {
+    fprintf (stderr, "--multi needs the whole file\n");
+    goto bad_arguments;
+  }
+
+  if (lines && stream) {
+    fprintf (stderr, "--lines needs the whole file\n");
+    goto bad_arguments;
+  }
+
+  if (use_multi && ignore_case) {
+    fprintf (stderr, "--multi doesn't ignore the case\n");
+    goto bad_arguments;
+  }
+
+  /* a line can go over a chunk, and the DFA grows as it goes */
+  if (use_regex && (stream || threads > 1 || scaling || use_multi)) {
+    fprintf (stderr, "--regex needs the whole file, in one thread\n");
+    goto bad_arguments;
+  }
+
+  if (use_index && (stream || scaling || use_multi || use_regex || lines)) {
+    fprintf (stderr, "--index counts the strings of a whole file\n");
+    goto bad_arguments;
+  }
+
+  if (use_gst && (stream || scaling || use_multi || use_regex || lines ||
+          use_index || recursive)) {
+    fprintf (stderr, "--gst queries the lines of a whole file\n");
+    goto bad_arguments;
+  }
+
+  if (fuzzy_errors >= 0 && (stream || threads > 1 || scaling || use_multi ||
+          use_regex || lines || use_index || recursive || use_gst)) {
+    fprintf (stderr,
+        "--fuzzy counts the lines of a whole file, in one thread\n");
+    goto bad_arguments;
+  }
+
+  if (recursive && (stream || scaling || use_multi || use_regex || lines ||
+          use_index)) {
+    fprintf (stderr, "--recursive counts the strings of every file under %s\n",
+        fname);
+    goto bad_arguments;
+  }
+
+  if (recursive) {
+    if (threads <= 1)
+      threads = sysconf (_SC_NPROCESSORS_ONLN);
+    printf ("Searching %s with %d threads\n", fname, threads);
+  } else if (use_mmap && !stream) {
+    if (mygrep_file_map (&map, fname) < 0) {
+      fprintf (stderr, "File %s can't be mapped: %s\n", fname,
+          strerror (errno));
+      return 1;
+    }
+    file = (char *) map.data;
+    length = map.size;
+  } else if (!stream && !(file = read_whole_file (fname, &length))) {
+    return 1;
+  }
+
+  /* every string is prepared once, for all the runs */
+  if (use_gst) {
+    int64_t start = now_us ();
+
+    gstlog = mygrep_gstlog_parse (file, length);
+    if (!gstlog) {
+      fprintf (stderr, "File %s can't be parsed: %s\n", fname,
+          strerror (errno));
+      return 1;
+    }
+    printf ("%zu lines in columns in %" PRId64 " us, %zu others "
+        "skipped\n", mygrep_gstlog_rows (gstlog),
+        now_us () - start, mygrep_gstlog_skipped (gstlog));
+
+    queries = calloc (n_whats, sizeof (MygrepGstQuery *));
+    for (w = 0; w < n_whats; w++) {
+      const char *error;
+
+      queries[w] = mygrep_gstquery_new (whats[w],
+          ignore_case ? MYGREP_PATTERN_IGNORE_CASE : 0, &error);
+      if (!queries[w]) {
+        fprintf (stderr, "Bad query %s: %s\n", whats[w], error);
+        return 1;
+      }
+    }
+    keep = malloc (mygrep_gstlog_rows (gstlog) + 1);
+  } else if (fuzzy_errors >= 0) {
+    const char *error;
+
+    fuzzy = mygrep_fuzzy_new (whats, n_whats, fuzzy_errors,
+        ignore_case ? MYGREP_PATTERN_IGNORE_CASE : 0, &error);
+    if (!fuzzy) {
+      fprintf (stderr, "Can't search with %d errors: %s\n", fuzzy_errors,
+          error);
+      return 1;
+    }
+    printf ("Up to %d errors, lines with a piece of %zu bytes or more "
+        "searched\n", fuzzy_errors, mygrep_fuzzy_piece_length (fuzzy));
+  } else if (use_regex) {
+    regexes = calloc (n_whats, sizeof (MygrepRegex *));
+    for (w = 0; w < n_whats; w++) {
+      const char *error;
+
+      regexes[w] = mygrep_regex_new (whats[w], regex_cache,
+          ignore_case ? MYGREP_REGEX_IGNORE_CASE : 0, &error);
+      if (!regexes[w]) {
+        fprintf (stderr, "Bad regex %s: %s\n", whats[w], error);
+        return 1;
+      }
+      if (!lines)
+        printf ("%s: regex, prefilter %s\n", whats[w],
+            mygrep_regex_literal (regexes[w]) ?
+            mygrep_regex_literal (regexes[w]) : "none");
+    }
+  } else if (algo != MYGREP_ALGO_LAST) {
+    patterns = calloc (n_whats, sizeof (MygrepPattern *));
+    for (w = 0; w < n_whats; w++) {
+      patterns[w] = mygrep_pattern_new_full (whats[w], strlen (whats[w]),
+          algo, ignore_case ? MYGREP_PATTERN_IGNORE_CASE : 0);
+      if (!lines)
+        printf ("%s: %s%s\n", whats[w],
+            mygrep_algo_name (mygrep_pattern_algo (patterns[w])),
+            mygrep_pattern_ignores_case (patterns[w]) ?
+            ", ignoring case" : "");
+    }
+  }
+
+  /* one pass, printed and done: 1 if nothing matched, like grep */
+  if (lines) {
+    MygrepWriter writer;
+    size_t found;
+
+    mygrep_writer_init (&writer, STDOUT_FILENO, MYGREP_WRITER_SIZE);
+    if (regexes)
+      found = mygrep_regex_lines_write (regexes, n_whats, file, length,
+          line_flags, &writer);
+    else
+      found = mygrep_lines_write ((const MygrepPattern * const *) patterns,
+          n_whats, file, length, line_flags, &writer);
+    if (mygrep_writer_flush (&writer) < 0) {
+      fprintf (stderr, "Can't write the lines: %s\n", strerror (errno));
+      found = 0;
+    }
+    mygrep_writer_clear (&writer);
+
+    return found ? 0 : 1;
+  }
+
+  /* every append is searched and what it found printed, there are no runs
+   * to time */
+  if (follow) {
+    MygrepFollow tail;
+    struct sigaction action = { .sa_handler = follow_stop };
+    size_t *seen = calloc (n_whats, sizeof (size_t));
+    int got = 0;
+
+    counts = calloc (n_whats, sizeof (size_t));
+    if (mygrep_follow_open (&tail, fname,
+            (const MygrepPattern * const *) patterns, n_whats) < 0) {
+      fprintf (stderr, "File %s can't be followed: %s\n", fname,
+          strerror (errno));
+      return 1;
+    }
+    printf ("Following %s\n", fname);
+
+    /* no SA_RESTART, the wait for the next write ends with it */
+    sigaction (SIGINT, &action, NULL);
+    sigaction (SIGTERM, &action, NULL);
+
+    while (!follow_stopped && (got = mygrep_follow_next (&tail, counts)) > 0) {
+      for (w = 0; w < n_whats; w++) {
+        if (counts[w] != seen[w])
+          printf ("%s: %zu (+%zu) at %lld bytes\n", whats[w], counts[w],
+              counts[w] - seen[w], (long long) tail.offset);
+        seen[w] = counts[w];
+      }
+      /* right away, even into a pipe */
+      fflush (stdout);
+    }
+    if (got < 0 && errno != EINTR)
+      fprintf (stderr, "File %s can't be read: %s\n", fname, strerror (errno));
+    else if (got == 0)
+      printf ("File %s is gone\n", fname);
+
+    for (ans = 0, w = 0; w < n_whats; w++)
+      ans += seen[w];
+    printf ("matches found: %d\n", ans);
+    for (w = 0; n_whats > 1 && w < n_whats; w++)
+      printf ("  %s: %zu\n", whats[w], seen[w]);
+
+    mygrep_follow_close (&tail);
+    for (w = 0; w < n_whats; w++)
+      mygrep_pattern_free (patterns[w]);
+    free (patterns);
+    free (seen);
+    free (counts);
+    return got < 0 && errno != EINTR ? 1 : 0;
+  }
+
+  if (scaling) {
+    if (threads <= 1)
+      threads = sysconf (_SC_NPROCESSORS_ONLN);
+    return mygrep_parallel_scaling (patterns[0], file, length, threads) < 0 ?
+        1 : 0;
+  }
+
+  /* the threads build it, the count goes over the blocks it gives */
+  if (use_index) {
+    size_t len = strlen (fname) + sizeof (MYGREP_INDEX_SUFFIX);
+    char *index_fname = malloc (len);
+
+    snprintf (index_fname, len, "%s%s", fname, MYGREP_INDEX_SUFFIX);
+    index = mygrep_index_open (index_fname, fname);
+    if (!index) {
+      int64_t start = now_us ();
+
+      printf ("Indexing %s to %s\n", fname, index_fname);
+      if (mygrep_index_build (index_fname, fname, file, length, 0,
+              threads > 1 ? threads : sysconf (_SC_NPROCESSORS_ONLN)) < 0 ||
+          !(index = mygrep_index_open (index_fname, fname))) {
+        fprintf (stderr, "File %s can't be indexed: %s\n", fname,
+            strerror (errno));
+        return 1;
+      }
+      printf ("Indexed in %" PRId64 " us\n",
+          now_us () - start);
+    }
+    free (index_fname);
+    candidates = calloc (n_whats, sizeof (size_t));
+  }
+
+  if (use_multi)
+    multi = mygrep_multi_new (whats, n_whats);
+  counts = calloc (n_whats, sizeof (size_t));
+
+  /* how the runs search, for the JSON */
+  if (multi)
+    snprintf (engine, sizeof (engine), "multi");
+  else if (fuzzy)
+    snprintf (engine, sizeof (engine), "fuzzy-%d", fuzzy_errors);
+  else if (regexes)
+    snprintf (engine, sizeof (engine), "regex");
+  else if (queries)
+    snprintf (engine, sizeof (engine), "gst-columns");
+  else if (index)
+    snprintf (engine, sizeof (engine), "index/%s", mygrep_algo_name (algo));
+  else if (recursive)
+    snprintf (engine, sizeof (engine), "tree-%d/%s", threads,
+        mygrep_algo_name (algo));
+  else if (algo == MYGREP_ALGO_LAST)
+    snprintf (engine, sizeof (engine), "run_search");
+  else if (stream)
+    snprintf (engine, sizeof (engine), "%s/%s",
+        codec != MYGREP_CODEC_NONE ? mygrep_codec_name (codec) : "stream",
+        mygrep_algo_name (algo));
+  else if (threads > 1)
+    snprintf (engine, sizeof (engine), "threads-%d/%s", threads,
+        mygrep_algo_name (algo));
+  else
+    snprintf (engine, sizeof (engine), "%s", mygrep_algo_name (algo));
+  if (ignore_case)
+    strncat (engine, "-i", sizeof (engine) - strlen (engine) - 1);
+
+  harness = mygrep_harness_new (warmup, num_runs, cpu);
+  if (!harness) {
+    if (errno == ENOMEM)
+      fprintf (stderr, "Can't keep %d runs: %s\n", num_runs, strerror (errno));
+    else
+      fprintf (stderr, "Can't pin to CPU %d: %s\n", cpu, strerror (errno));
+    return 1;
+  }
+
+  for (nr = 0; nr < mygrep_harness_total_runs (harness); nr++) {
+    int prev_ans = -1;
+    if (ans != -1)
+      prev_ans = ans;
+
+    mygrep_harness_start (harness);
+    if (multi) {
+      mygrep_multi_count (multi, file, length, counts);
+    } else if (fuzzy) {
+      mygrep_fuzzy_count (fuzzy, file, length, counts);
+    } else if (stream) {
+      if (mygrep_stream_count_file (fname,
+              (const MygrepPattern * const *) patterns, n_whats, counts) < 0) {
+        fprintf (stderr, "File %s can't be read: %s\n", fname,
+            strerror (errno));
+        return 1;
+      }
+    } else if (recursive) {
+      size_t f;
+
+      /* the last run is the one printed */
+      mygrep_tree_result_clear (&tree);
+      if (mygrep_tree_count (fname, (const MygrepPattern * const *) patterns,
+              n_whats, threads, tree_flags, &tree) < 0) {
+        fprintf (stderr, "%s can't be searched: %s\n", fname,
+            strerror (errno));
+        return 1;
+      }
+      for (w = 0; w < n_whats; w++)
+        for (counts[w] = 0, f = 0; f < tree.n_files; f++)
+          counts[w] += tree.files[f].counts[w];
+    }
+
+    for (w = 0; w < n_whats && !multi && !fuzzy && !stream && !recursive;
+        w++) {
+      if (index) {
+        if (mygrep_index_count (index, patterns[w], file, length, &counts[w],
+                &candidates[w]) < 0) {
+          fprintf (stderr, "File %s changed since it was indexed\n", fname);
+          return 1;
+        }
+      } else if (queries) {
+        counts[w] = mygrep_gstquery_run (queries[w], gstlog, keep);
+      } else if (regexes) {
+        counts[w] = mygrep_regex_count (regexes[w], file, length);
+      } else if (threads > 1) {
+        counts[w] = mygrep_parallel_count (patterns[w], file, length,
+            threads);
+      } else if (patterns) {
+        counts[w] = mygrep_pattern_count (patterns[w], file, length, NULL);
+      } else {
+        counts[w] = tool->run_search (file, whats[w]);
+      }
+    }
+    /* us, like it always was */
+    if (nr >= warmup)
+      measurement += mygrep_harness_stop (harness) / 1000;
+    else
+      mygrep_harness_stop (harness);
+
+    for (ans = 0, w = 0; w < n_whats; w++)
+      ans += counts[w];
+
+    if (prev_ans != -1 && ans != prev_ans) {
+      fprintf (stderr, "Sanity check failed\n");
+      abort ();
+    }
+  }
+
+  printf ("Time to search elapsed: %" PRId64 " us\n", measurement);
+
+  printf ("matches found: %d\n", ans);
+  for (w = 0; n_whats > 1 && w < n_whats; w++)
+    printf ("  %s: %zu\n", whats[w], counts[w]);
+  if (recursive) {
+    size_t f, found;
+
+    for (f = 0; f < tree.n_files; f++) {
+      if (tree.files[f].error) {
+        fprintf (stderr, "File %s can't be read: %s\n", tree.files[f].path,
+            strerror (tree.files[f].error));
+        continue;
+      }
+      for (found = 0, w = 0; w < n_whats; w++)
+        found += tree.files[f].counts[w];
+      if (found)
+        printf ("  %s: %zu\n", tree.files[f].path, found);
+    }
+    printf ("%zu files read with %s, %zu directories not listed\n",
+        tree.n_files, tree.uring ? "io_uring" : "pread", tree.n_errors);
+  }
+  for (w = 0; index && w < n_whats; w++)
+    printf ("  %s: %zu of %zu blocks searched\n", whats[w], candidates[w],
+        mygrep_index_blocks (index));
+  for (w = 0; regexes && w < n_whats; w++) {
+    if (mygrep_regex_flushes (regexes[w]))
+      printf ("  %s: the DFA cache got full %d times\n", whats[w],
+          mygrep_regex_flushes (regexes[w]));
+  }
+  mygrep_harness_print (harness);
+
+  if (json && mygrep_harness_write_json (harness, json, tool->name,
+          tool->variant, engine, whats, n_whats, ans) < 0)
+    fprintf (stderr, "File %s can't be written: %s\n", json, strerror (errno));
+  mygrep_harness_free (harness);
+
+  if (multi)
+    mygrep_multi_free (multi);
+  if (fuzzy)
+    mygrep_fuzzy_free (fuzzy);
+  for (w = 0; patterns && w < n_whats; w++)
+    mygrep_pattern_free (patterns[w]);
+  free (patterns);
+  for (w = 0; regexes && w < n_whats; w++)
+    mygrep_regex_free (regexes[w]);
+  free (regexes);
+  if (index)
+    mygrep_index_close (index);
+  mygrep_tree_result_clear (&tree);
+  for (w = 0; queries && w < n_whats; w++)
+    mygrep_gstquery_free (queries[w]);
+  free (queries);
+  if (gstlog)
+    mygrep_gstlog_free (gstlog);
+  free (keep);
+  free (candidates);
+  free (counts);
+  if (map.data)
+    mygrep_file_unmap (&map);
+  else
+    free (file);
+  return 0;
+
+bad_arguments:
+  usage ();
+  return 1;
+}
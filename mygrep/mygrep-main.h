@@ -0,0 +1,45 @@
+/* Command line of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The options, their checks and the runs are the same for every tool, what
+ * a tool brings is its naive search: the one of the G_LIKELY or the
+ * G_GNUC_PURE experiment. It runs when no engine of mygrep/ is asked for. */
+
+#ifndef MYGREP_MAIN_H
+#define MYGREP_MAIN_H
+
+/* Counts @what in the zero terminated @where, a match starting after the
+ * end of the previous one */
+typedef int (*MygrepSearchFunc) (const char *where, const char *what);
+
+typedef struct
+{
+  /* "unlikely" or "pure", the tool of the JSON */
+  const char *name;
+  /* how it was built, "likely-lto" for example */
+  const char *variant;
+  MygrepSearchFunc run_search;
+} MygrepTool;
+
+/* Returns what main () does: 0, or 1 on bad arguments or failure. With
+ * --lines it's 1 if no line matched, like grep. */
+int mygrep_main (int argc, char **argv, const MygrepTool * tool);
+
+#endif
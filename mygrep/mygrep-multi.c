@@ -0,0 +1,249 @@
+/* Multi-pattern search of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "mygrep-multi.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct _MygrepMulti
+{
+  int n_patterns;
+  size_t *lengths;
+  /* patterns that are the same as an earlier one count with it */
+  int *same_as;
+
+  /* class of every byte, 0 for the ones of no pattern */
+  uint8_t classes[256];
+  int n_classes;
+
+  /* states x classes, the next state. Once built, the states are numbered
+   * so the ones where patterns end come last, from first_match on, and the
+   * numbers are multiplied by n_classes: the scan only adds the class. */
+  uint32_t *delta;
+  int n_states;
+  uint32_t first_match;
+  /* the pattern that ends in the state or -1, and the next state of the
+   * fail chain where one ends, 0 for none */
+  int *ends;
+  uint32_t *more;
+};
+
+/* The trie first, its missing edges are 0, which is where they go in the
+ * DFA too if the root has no edge for the class */
+static int
+mygrep_multi_build_trie (MygrepMulti * multi, const char *const *patterns)
+{
+  int p, n = 1;
+
+  for (p = 0; p < multi->n_patterns; p++) {
+    uint32_t s = 0;
+    size_t i;
+
+    for (i = 0; i < multi->lengths[p]; i++) {
+      uint32_t *next = &multi->delta[s * multi->n_classes +
+          multi->classes[(uint8_t) patterns[p][i]]];
+
+      if (!*next)
+        *next = n++;
+      s = *next;
+    }
+
+    if (multi->lengths[p] == 0)
+      continue;
+
+    if (multi->ends[s] >= 0)
+      multi->same_as[p] = multi->ends[s];
+    else
+      multi->ends[s] = p;
+  }
+
+  return n;
+}
+
+/* Breadth first, so the fail state of every state is done before it */
+static void
+mygrep_multi_build_dfa (MygrepMulti * multi)
+{
+  uint32_t *queue = malloc (multi->n_states * sizeof (uint32_t));
+  uint32_t *fail = calloc (multi->n_states, sizeof (uint32_t));
+  int head = 0, tail = 0, c;
+
+  for (c = 0; c < multi->n_classes; c++) {
+    uint32_t child = multi->delta[c];
+
+    if (child)
+      queue[tail++] = child;
+  }
+
+  while (head < tail) {
+    uint32_t s = queue[head++];
+    uint32_t *row = &multi->delta[s * multi->n_classes];
+    const uint32_t *fail_row = &multi->delta[fail[s] * multi->n_classes];
+
+    multi->more[s] = multi->ends[fail[s]] >= 0 ? fail[s] : multi->more[fail[s]];
+
+    for (c = 0; c < multi->n_classes; c++) {
+      if (row[c]) {
+        fail[row[c]] = fail_row[c];
+        queue[tail++] = row[c];
+      } else {
+        row[c] = fail_row[c];
+      }
+    }
+  }
+
+  free (queue);
+  free (fail);
+}
+
+/* Moves the states where something ends to the end, and premultiplies */
+static void
+mygrep_multi_renumber (MygrepMulti * multi)
+{
+  uint32_t *order = malloc (multi->n_states * sizeof (uint32_t));
+  int *ends = malloc (multi->n_states * sizeof (int));
+  uint32_t *more = malloc (multi->n_states * sizeof (uint32_t));
+  uint32_t *delta = malloc (multi->n_states * multi->n_classes *
+      sizeof (uint32_t));
+  int s, c, n = 0, pass;
+
+  /* the root has nothing, so it stays 0 */
+  for (pass = 0; pass < 2; pass++) {
+    if (pass == 1)
+      multi->first_match = n * multi->n_classes;
+    for (s = 0; s < multi->n_states; s++) {
+      int matches = multi->ends[s] >= 0 || multi->more[s];
+
+      if (matches == pass)
+        order[s] = n++;
+    }
+  }
+
+  for (s = 0; s < multi->n_states; s++) {
+    const uint32_t *from = &multi->delta[s * multi->n_classes];
+    uint32_t *to = &delta[order[s] * multi->n_classes];
+
+    for (c = 0; c < multi->n_classes; c++)
+      to[c] = order[from[c]] * multi->n_classes;
+    ends[order[s]] = multi->ends[s];
+    more[order[s]] = multi->more[s] ? order[multi->more[s]] : 0;
+  }
+
+  free (multi->delta);
+  free (multi->ends);
+  free (multi->more);
+  free (order);
+  multi->delta = delta;
+  multi->ends = ends;
+  multi->more = more;
+}
+
+MygrepMulti *
+mygrep_multi_new (const char *const *patterns, int n_patterns)
+{
+  MygrepMulti *multi = calloc (1, sizeof (MygrepMulti));
+  size_t total = 0;
+  int p, i;
+
+  multi->n_patterns = n_patterns;
+  multi->lengths = malloc (n_patterns * sizeof (size_t));
+  multi->same_as = malloc (n_patterns * sizeof (int));
+
+  multi->n_classes = 1;
+  for (p = 0; p < n_patterns; p++) {
+    multi->lengths[p] = strlen (patterns[p]);
+    multi->same_as[p] = -1;
+    total += multi->lengths[p];
+
+    for (i = 0; patterns[p][i]; i++) {
+      uint8_t b = patterns[p][i];
+
+      if (!multi->classes[b])
+        multi->classes[b] = multi->n_classes++;
+    }
+  }
+
+  /* a state per byte of the patterns at most, plus the root */
+  multi->delta = calloc ((total + 1) * multi->n_classes, sizeof (uint32_t));
+  multi->ends = malloc ((total + 1) * sizeof (int));
+  for (i = 0; i <= (int) total; i++)
+    multi->ends[i] = -1;
+
+  multi->n_states = mygrep_multi_build_trie (multi, patterns);
+  multi->more = calloc (multi->n_states, sizeof (uint32_t));
+  mygrep_multi_build_dfa (multi);
+  mygrep_multi_renumber (multi);
+
+  return multi;
+}
+
+void
+mygrep_multi_free (MygrepMulti * multi)
+{
+  free (multi->lengths);
+  free (multi->same_as);
+  free (multi->delta);
+  free (multi->ends);
+  free (multi->more);
+  free (multi);
+}
+
+void
+mygrep_multi_count (const MygrepMulti * multi, const char *where,
+    size_t size, size_t *counts)
+{
+  /* per pattern, where its next match may start */
+  size_t *next = calloc (multi->n_patterns, sizeof (size_t));
+  const uint32_t *delta = multi->delta;
+  const uint8_t *classes = multi->classes;
+  const uint32_t first_match = multi->first_match;
+  uint32_t s = 0;
+  size_t i;
+  int p;
+
+  memset (counts, 0, multi->n_patterns * sizeof (size_t));
+
+  for (i = 0; i < size; i++) {
+    uint32_t t;
+
+    s = delta[s + classes[(uint8_t) where[i]]];
+    if (s < first_match)
+      continue;
+
+    /* every pattern that ends here, the longest first */
+    t = s / multi->n_classes;
+    for (t = multi->ends[t] >= 0 ? t : multi->more[t]; t; t = multi->more[t]) {
+      p = multi->ends[t];
+
+      if (i + 1 - multi->lengths[p] >= next[p]) {
+        counts[p]++;
+        next[p] = i + 1;
+      }
+    }
+  }
+
+  for (p = 0; p < multi->n_patterns; p++) {
+    if (multi->same_as[p] >= 0)
+      counts[p] = counts[multi->same_as[p]];
+  }
+
+  free (next);
+}
@@ -0,0 +1,43 @@
+/* Multi-pattern search of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Aho-Corasick: all the patterns in one pass, with the automaton made a
+ * DFA, so it's a table lookup per byte of the text. The bytes no pattern
+ * has are all the same to it, the table has a column per class of bytes
+ * instead of 256, which keeps dozens of keywords within the L1 cache.
+ *
+ * Every pattern is counted as if it was searched on its own: left to right,
+ * a match starts after the end of the previous match of the same pattern. */
+
+#ifndef MYGREP_MULTI_H
+#define MYGREP_MULTI_H
+
+#include <stddef.h>
+
+typedef struct _MygrepMulti MygrepMulti;
+
+MygrepMulti *mygrep_multi_new (const char *const *patterns, int n_patterns);
+void mygrep_multi_free (MygrepMulti * multi);
+
+/* @counts gets a count per pattern, in the order of mygrep_multi_new () */
+void mygrep_multi_count (const MygrepMulti * multi, const char *where,
+    size_t size, size_t *counts);
+
+#endif
@@ -0,0 +1,231 @@
+/* Output of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define _GNU_SOURCE
+#include "mygrep-output.h"
+#include "mygrep-search.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+int
+mygrep_writer_init (MygrepWriter * writer, int fd, size_t size)
+{
+  writer->fd = fd;
+  writer->size = size;
+  writer->used = 0;
+  writer->error = 0;
+
+  writer->buf = malloc (size);
+  return writer->buf ? 0 : -1;
+}
+
+static void
+mygrep_writer_write_fd (MygrepWriter * writer, const char *data, size_t len)
+{
+  while (len && !writer->error) {
+    ssize_t done = write (writer->fd, data, len);
+
+    if (done < 0) {
+      if (errno != EINTR)
+        writer->error = errno;
+      continue;
+    }
+
+    data += done;
+    len -= done;
+  }
+}
+
+void
+mygrep_writer_write (MygrepWriter * writer, const char *data, size_t len)
+{
+  if (writer->used + len > writer->size) {
+    mygrep_writer_write_fd (writer, writer->buf, writer->used);
+    writer->used = 0;
+
+    /* no point in copying what fills the buffer on its own */
+    if (len >= writer->size) {
+      mygrep_writer_write_fd (writer, data, len);
+      return;
+    }
+  }
+
+  memcpy (writer->buf + writer->used, data, len);
+  writer->used += len;
+}
+
+int
+mygrep_writer_flush (MygrepWriter * writer)
+{
+  mygrep_writer_write_fd (writer, writer->buf, writer->used);
+  writer->used = 0;
+
+  if (writer->error) {
+    errno = writer->error;
+    return -1;
+  }
+
+  return 0;
+}
+
+void
+mygrep_writer_clear (MygrepWriter * writer)
+{
+  free (writer->buf);
+  writer->buf = NULL;
+}
+
+/* "<value>:" */
+static void
+mygrep_writer_write_number (MygrepWriter * writer, size_t value)
+{
+  char digits[24];
+  char *p = digits + sizeof (digits);
+
+  *--p = ':';
+  do {
+    *--p = '0' + value % 10;
+    value /= 10;
+  } while (value);
+
+  mygrep_writer_write (writer, p, digits + sizeof (digits) - p);
+}
+
+/* The line [@start, @end), @line being the number of the line @counted is
+ * in */
+static void
+mygrep_lines_write_line (MygrepWriter * writer, const MygrepSearch * search,
+    const char *where, const char *start, const char *end,
+    MygrepLinesFlags flags, const char **counted, size_t *line)
+{
+  if (flags & MYGREP_LINES_NUMBER) {
+    *line += search->mygrep_count_byte (*counted, start - *counted, '\n');
+    *counted = start;
+    mygrep_writer_write_number (writer, *line);
+  }
+  if (flags & MYGREP_LINES_OFFSET)
+    mygrep_writer_write_number (writer, start - where);
+  mygrep_writer_write (writer, start, end - start);
+  mygrep_writer_write (writer, "\n", 1);
+}
+
+size_t
+mygrep_lines_write (const MygrepPattern * const *patterns, int n_patterns,
+    const char *where, size_t size, MygrepLinesFlags flags,
+    MygrepWriter * writer)
+{
+  const MygrepSearch *search = mygrep_search_get ();
+  const char *z = where + size, **next;
+  /* the newlines before @counted are in @line */
+  const char *pos = where, *counted = where;
+  size_t line = 1, lines = 0;
+  int p;
+
+  /* the next match of every pattern, found again once the lines go past */
+  next = malloc (n_patterns * sizeof (const char *));
+  for (p = 0; p < n_patterns; p++)
+    next[p] = mygrep_pattern_find (patterns[p], where, size);
+
+  for (;;) {
+    const char *match = NULL, *start, *end;
+    size_t len = 0;
+
+    for (p = 0; p < n_patterns; p++) {
+      if (next[p] && (!match || next[p] < match)) {
+        match = next[p];
+        len = mygrep_pattern_length (patterns[p]);
+      }
+    }
+    if (!match)
+      break;
+
+    /* the lines before this one had no match, there's no newline in
+     * between but the ones that end them */
+    start = memrchr (pos, '\n', match - pos);
+    start = start ? start + 1 : pos;
+    end = memchr (match + len - 1, '\n', z - (match + len - 1));
+    end = end ? end : z;
+
+    mygrep_lines_write_line (writer, search, where, start, end, flags,
+        &counted, &line);
+    lines++;
+
+    if (end == z)
+      break;
+    pos = end + 1;
+
+    for (p = 0; p < n_patterns; p++) {
+      if (next[p] && next[p] < pos)
+        next[p] = mygrep_pattern_find (patterns[p], pos, z - pos);
+    }
+  }
+
+  free (next);
+  return lines;
+}
+
+size_t
+mygrep_regex_lines_write (MygrepRegex * const *regexes, int n_regexes,
+    const char *where, size_t size, MygrepLinesFlags flags,
+    MygrepWriter * writer)
+{
+  const MygrepSearch *search = mygrep_search_get ();
+  const char *z = where + size, *counted = where, **next;
+  size_t line = 1, lines = 0, *lens;
+  int r;
+
+  /* the next matching line of every regex, as for the patterns */
+  next = malloc (n_regexes * sizeof (const char *));
+  lens = malloc (n_regexes * sizeof (size_t));
+  for (r = 0; r < n_regexes; r++)
+    next[r] = mygrep_regex_find_line (regexes[r], where, size, &lens[r]);
+
+  for (;;) {
+    const char *start = NULL, *end;
+
+    for (r = 0; r < n_regexes; r++) {
+      if (next[r] && (!start || next[r] < start)) {
+        start = next[r];
+        end = start + lens[r];
+      }
+    }
+    if (!start)
+      break;
+
+    mygrep_lines_write_line (writer, search, where, start, end, flags,
+        &counted, &line);
+    lines++;
+
+    if (end == z)
+      break;
+
+    for (r = 0; r < n_regexes; r++) {
+      if (next[r] && next[r] <= end)
+        next[r] = mygrep_regex_find_line (regexes[r], end + 1, z - end - 1,
+            &lens[r]);
+    }
+  }
+
+  free (lens);
+  free (next);
+  return lines;
+}
@@ -0,0 +1,73 @@
+/* Output of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The matching lines, the way grep prints them. Finding the lines costs
+ * next to nothing over finding the matches: the line of a match goes back
+ * to the previous newline with memrchr () and on to the next one with
+ * memchr (), and only the line numbers need the newlines in between, which
+ * the engine counts a vector at a time. Whatever is printed goes through a
+ * big buffer, a write () per megabyte rather than per line. */
+
+#ifndef MYGREP_OUTPUT_H
+#define MYGREP_OUTPUT_H
+
+#include <stddef.h>
+#include "mygrep-algo.h"
+#include "mygrep-regex.h"
+
+#define MYGREP_WRITER_SIZE (1 << 20)
+
+typedef struct
+{
+  int fd;
+  char *buf;
+  size_t size, used;
+  /* errno of the first write () that failed, the rest is dropped */
+  int error;
+} MygrepWriter;
+
+int mygrep_writer_init (MygrepWriter * writer, int fd, size_t size);
+void mygrep_writer_write (MygrepWriter * writer, const char *data,
+    size_t len);
+/* Returns -1 and leaves errno if any write () failed so far */
+int mygrep_writer_flush (MygrepWriter * writer);
+void mygrep_writer_clear (MygrepWriter * writer);
+
+typedef enum
+{
+  /* "<line number>:" before every line, from 1 */
+  MYGREP_LINES_NUMBER = 1 << 0,
+  /* "<offset of the line in bytes>:" */
+  MYGREP_LINES_OFFSET = 1 << 1
+} MygrepLinesFlags;
+
+/* Writes every line of @where with a match of any of the patterns, once,
+ * with a newline after it even if the last line has none. Returns how many
+ * lines. */
+size_t mygrep_lines_write (const MygrepPattern * const *patterns,
+    int n_patterns, const char *where, size_t size, MygrepLinesFlags flags,
+    MygrepWriter * writer);
+
+/* The same for the lines the regular expressions match */
+size_t mygrep_regex_lines_write (MygrepRegex * const *regexes,
+    int n_regexes, const char *where, size_t size, MygrepLinesFlags flags,
+    MygrepWriter * writer);
+
+#endif
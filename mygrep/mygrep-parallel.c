@@ -0,0 +1,232 @@
+/* Parallel search of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "mygrep-parallel.h"
+#include "mygrep-harness.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct
+{
+  const MygrepPattern *pattern;
+  const char *where;
+  size_t size;
+  size_t what_len;
+
+  /* matches that start in [start, end) */
+  size_t start, end;
+
+  /* of the scan from start: position and count after each block */
+  size_t n_blocks;
+  size_t *positions;
+  size_t *counts;
+  size_t count, resume;
+
+  pthread_t thread;
+  int started;
+} MygrepRange;
+
+/* Matches that start in [from, to), @from being where the scan stands.
+ * @next gets where it stands afterwards, which is never before @to. */
+static size_t
+mygrep_range_step (const MygrepRange * r, size_t from, size_t to,
+    size_t *next)
+{
+  size_t stop = to + r->what_len - 1, resume, ret;
+
+  if (from >= to) {
+    *next = from;
+    return 0;
+  }
+
+  if (stop > r->size)
+    stop = r->size;
+
+  ret = mygrep_pattern_count (r->pattern, r->where + from, stop - from,
+      &resume);
+  *next = from + resume > to ? from + resume : to;
+
+  return ret;
+}
+
+static size_t
+mygrep_range_block_end (const MygrepRange * r, size_t block)
+{
+  size_t to = r->start + (block + 1) * MYGREP_PARALLEL_BLOCK;
+
+  return to < r->end ? to : r->end;
+}
+
+static void *
+mygrep_range_run (void *data)
+{
+  MygrepRange *r = data;
+  size_t pos = r->start, b;
+
+  r->count = 0;
+  for (b = 0; b < r->n_blocks; b++) {
+    r->count += mygrep_range_step (r, pos, mygrep_range_block_end (r, b),
+        &pos);
+    r->positions[b] = pos;
+    r->counts[b] = r->count;
+  }
+  r->resume = pos;
+
+  return NULL;
+}
+
+/* The count of @r for a scan that enters it at @pos, @pos gets the exit */
+static size_t
+mygrep_range_fix_up (const MygrepRange * r, size_t *pos)
+{
+  size_t count = 0, b;
+
+  /* nothing went over the split, the thread was right */
+  if (*pos == r->start) {
+    *pos = r->resume;
+    return r->count;
+  }
+
+  for (b = 0; b < r->n_blocks; b++) {
+    count += mygrep_range_step (r, *pos, mygrep_range_block_end (r, b), pos);
+
+    /* same place, same matches from here on */
+    if (*pos == r->positions[b]) {
+      *pos = r->resume;
+      return count + r->count - r->counts[b];
+    }
+  }
+
+  return count;
+}
+
+size_t
+mygrep_parallel_count (const MygrepPattern * pattern, const char *where,
+    size_t size, int threads)
+{
+  MygrepRange *ranges;
+  size_t what_len = mygrep_pattern_length (pattern);
+  size_t per_thread, count = 0, pos = 0;
+  int t;
+
+  if (what_len == 0 || what_len > size)
+    return 0;
+
+  /* less than a block per thread isn't worth a thread */
+  if (threads > (int) (size / MYGREP_PARALLEL_BLOCK))
+    threads = size / MYGREP_PARALLEL_BLOCK;
+  if (threads <= 1)
+    return mygrep_pattern_count (pattern, where, size, NULL);
+
+  /* ranges start at pages, so the threads don't share them */
+  per_thread = (size / threads + 4095) & ~(size_t) 4095;
+
+  ranges = calloc (threads, sizeof (MygrepRange));
+  for (t = 0; t < threads; t++) {
+    MygrepRange *r = &ranges[t];
+
+    r->pattern = pattern;
+    r->where = where;
+    r->size = size;
+    r->what_len = what_len;
+    r->start = t * per_thread < size ? t * per_thread : size;
+    r->end = t == threads - 1 || (t + 1) * per_thread > size ?
+        size : (t + 1) * per_thread;
+    r->n_blocks = (r->end - r->start + MYGREP_PARALLEL_BLOCK - 1) /
+        MYGREP_PARALLEL_BLOCK;
+    r->positions = malloc (r->n_blocks * sizeof (size_t));
+    r->counts = malloc (r->n_blocks * sizeof (size_t));
+
+    /* the first range goes in this thread */
+    if (t > 0)
+      r->started = !pthread_create (&r->thread, NULL, mygrep_range_run, r);
+  }
+  mygrep_range_run (&ranges[0]);
+
+  for (t = 0; t < threads; t++) {
+    MygrepRange *r = &ranges[t];
+
+    if (t > 0) {
+      if (r->started)
+        pthread_join (r->thread, NULL);
+      else
+        mygrep_range_run (r);
+    }
+
+    count += mygrep_range_fix_up (r, &pos);
+    free (r->positions);
+    free (r->counts);
+  }
+  free (ranges);
+
+  return count;
+}
+
+int
+mygrep_parallel_scaling (const MygrepPattern * pattern, const char *where,
+    size_t size, int max_threads)
+{
+  const int runs = 10;
+  size_t serial;
+  double base = 0;
+  int threads, ret = 0;
+
+  /* the first pass also brings the file to the page cache */
+  serial = mygrep_pattern_count (pattern, where, size, NULL);
+
+  printf ("%8s %12s %10s %8s\n", "threads", "matches", "MB/s", "speedup");
+  for (threads = 1;; threads *= 2) {
+    MygrepHarness *harness;
+    MygrepHarnessStats stats;
+    double mbs;
+    size_t count = 0;
+    int r;
+
+    if (threads > max_threads)
+      threads = max_threads;
+
+    harness = mygrep_harness_new (1, runs, -1);
+    if (!harness) {
+      ret = -1;
+      break;
+    }
+    for (r = 0; r < mygrep_harness_total_runs (harness); r++) {
+      mygrep_harness_start (harness);
+      count = mygrep_parallel_count (pattern, where, size, threads);
+      mygrep_harness_stop (harness);
+    }
+    mygrep_harness_stats (harness, MYGREP_HARNESS_TIME, &stats);
+    mygrep_harness_free (harness);
+
+    mbs = size / stats.median * 1e3;
+    if (threads == 1)
+      base = mbs;
+    printf ("%8d %12zu %10.1f %7.2fx%s\n", threads, count, mbs, mbs / base,
+        count == serial ? "" : " WRONG COUNT");
+    if (count != serial)
+      ret = -1;
+
+    if (threads == max_threads)
+      break;
+  }
+
+  return ret;
+}
@@ -0,0 +1,46 @@
+/* Parallel search of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The buffer is split into a range per thread, and every thread counts its
+ * range as if no match of the previous range went into it. Then the ranges
+ * are put together in order: where a match did go over the split, the range
+ * is searched again from the end of that match, until the new scan and the
+ * one of the thread stand at the same place, which for text is a block or
+ * so. From there they'd find the same matches, so the rest is taken from
+ * the thread. The count is always the one of the serial search. */
+
+#ifndef MYGREP_PARALLEL_H
+#define MYGREP_PARALLEL_H
+
+#include <stddef.h>
+#include "mygrep-algo.h"
+
+/* Where the scans compare their positions */
+#define MYGREP_PARALLEL_BLOCK (256 << 10)
+
+size_t mygrep_parallel_count (const MygrepPattern * pattern,
+    const char *where, size_t size, int threads);
+
+/* Counts with 1, 2, 4... up to @max_threads threads and prints the median
+ * throughput of each. Returns -1 if any count differs from the serial one. */
+int mygrep_parallel_scaling (const MygrepPattern * pattern,
+    const char *where, size_t size, int max_threads);
+
+#endif
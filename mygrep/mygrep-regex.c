@@ -0,0 +1,1138 @@
+/* Regular expressions of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define _GNU_SOURCE
+#include "mygrep-regex.h"
+#include "mygrep-algo.h"
+#include <ctype.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The virtual symbols around every line, after the 256 bytes */
+#define SYM_BOL 256
+#define SYM_EOL 257
+
+/* Transitions that aren't states */
+#define STATE_UNKNOWN -1
+#define STATE_MATCH -2
+
+/* The most { } can repeat, RE_DUP_MAX of POSIX */
+#define MYGREP_REGEX_DUP_MAX 255
+/* Of the parse tree, { } copies what it repeats */
+#define MYGREP_REGEX_MAX_NODES (1 << 16)
+
+typedef enum
+{
+  NODE_SET,
+  NODE_BOL,
+  NODE_EOL,
+  NODE_EMPTY,
+  NODE_CAT,
+  NODE_ALT,
+  NODE_STAR,
+  NODE_PLUS,
+  NODE_QUEST
+} MygrepNodeType;
+
+typedef struct
+{
+  MygrepNodeType type;
+  /* NODE_SET: the set, and the byte if it's a single one, -1 if not */
+  int set, byte;
+  int left, right;
+} MygrepNode;
+
+typedef enum
+{
+  OP_SET,
+  OP_BOL,
+  OP_EOL,
+  OP_SPLIT,
+  OP_JMP,
+  OP_MATCH
+} MygrepOp;
+
+typedef struct
+{
+  MygrepOp op;
+  /* OP_SET: the set, OP_SPLIT and OP_JMP: where to */
+  int x, y;
+} MygrepInst;
+
+typedef struct
+{
+  uint32_t bits[8];
+} MygrepSet;
+
+typedef struct
+{
+  const char *p, *end;
+  const char *error;
+
+  MygrepNode *nodes;
+  int n_nodes, nodes_size;
+} MygrepParser;
+
+typedef struct
+{
+  /* in pcs */
+  int start, len;
+  uint32_t hash;
+} MygrepDState;
+
+struct _MygrepRegex
+{
+  MygrepInst *prog;
+  int n_prog, prog_size;
+  MygrepSet *sets;
+  int n_sets, sets_size;
+
+  uint8_t classes[256];
+  int n_classes;
+
+  /* the lazy DFA: a row of n_classes transitions per state, the states are
+   * the offsets of their rows */
+  int *trans;
+  MygrepDState *states;
+  int n_states, states_size;
+  int *pcs;
+  int n_pcs, pcs_size;
+  int *table;
+  int table_size;
+  size_t cache_size;
+  int flushes;
+
+  int line_start;
+  /* of line_start, to bring it back after a flush */
+  int *start_pcs;
+  int n_start_pcs;
+
+  /* closure */
+  int *marks, mark;
+  int *stack;
+  int *scratch;
+
+  char *literal;
+  MygrepPattern *prefilter;
+  /* the expression is the literal, what the prefilter finds matches */
+  int exact;
+};
+
+static void *
+mygrep_grow (void *array, int *size, int need, size_t item)
+{
+  if (need <= *size)
+    return array;
+
+  while (*size < need)
+    *size = *size ? *size * 2 : 16;
+
+  return realloc (array, *size * item);
+}
+
+/* Parser */
+
+static int
+mygrep_node (MygrepParser * parser, MygrepNodeType type, int left, int right)
+{
+  MygrepNode *node;
+
+  parser->nodes = mygrep_grow (parser->nodes, &parser->nodes_size,
+      parser->n_nodes + 1, sizeof (MygrepNode));
+  node = &parser->nodes[parser->n_nodes];
+  node->type = type;
+  node->set = -1;
+  node->byte = -1;
+  node->left = left;
+  node->right = right;
+
+  return parser->n_nodes++;
+}
+
+static int
+mygrep_set_new (MygrepRegex * regex)
+{
+  regex->sets = mygrep_grow (regex->sets, &regex->sets_size,
+      regex->n_sets + 1, sizeof (MygrepSet));
+  memset (&regex->sets[regex->n_sets], 0, sizeof (MygrepSet));
+
+  return regex->n_sets++;
+}
+
+static inline int
+mygrep_set_has (const MygrepSet * set, int c)
+{
+  return set->bits[c >> 5] >> (c & 31) & 1;
+}
+
+static inline void
+mygrep_set_add (MygrepSet * set, int c)
+{
+  set->bits[c >> 5] |= 1u << (c & 31);
+}
+
+static void
+mygrep_set_add_range (MygrepSet * set, int from, int to)
+{
+  for (; from <= to; from++)
+    mygrep_set_add (set, from);
+}
+
+/* \d \w \s, 0 if @c isn't one of them */
+static int
+mygrep_set_add_escape (MygrepSet * set, char c)
+{
+  switch (c) {
+    case 'd':
+      mygrep_set_add_range (set, '0', '9');
+      return 1;
+    case 'w':
+      mygrep_set_add_range (set, '0', '9');
+      mygrep_set_add_range (set, 'a', 'z');
+      mygrep_set_add_range (set, 'A', 'Z');
+      mygrep_set_add (set, '_');
+      return 1;
+    case 's':
+      mygrep_set_add_range (set, '\t', '\r');
+      mygrep_set_add (set, ' ');
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+/* [:alpha:] and the others of POSIX, of the ASCII bytes. @name is what's
+ * between the colons. 0 if it isn't one of them. */
+static int
+mygrep_set_add_named (MygrepSet * set, const char *name, size_t len)
+{
+  static const struct
+  {
+    const char *name;
+    int (*in) (int c);
+  } classes[] = {
+    {"alnum", isalnum}, {"alpha", isalpha}, {"blank", isblank},
+    {"cntrl", iscntrl}, {"digit", isdigit}, {"graph", isgraph},
+    {"lower", islower}, {"print", isprint}, {"punct", ispunct},
+    {"space", isspace}, {"upper", isupper}, {"xdigit", isxdigit}
+  };
+  size_t n;
+  int c;
+
+  for (n = 0; n < sizeof (classes) / sizeof (classes[0]); n++) {
+    if (strlen (classes[n].name) != len || memcmp (classes[n].name, name, len))
+      continue;
+    for (c = 0; c < 128; c++) {
+      if (classes[n].in (c))
+        mygrep_set_add (set, c);
+    }
+    return 1;
+  }
+
+  return 0;
+}
+
+static char
+mygrep_escaped (char c)
+{
+  switch (c) {
+    case 'n':
+      return '\n';
+    case 't':
+      return '\t';
+    case 'r':
+      return '\r';
+    default:
+      return c;
+  }
+}
+
+static int
+mygrep_node_set (MygrepParser * parser, MygrepRegex * regex, int byte)
+{
+  int node = mygrep_node (parser, NODE_SET, -1, -1);
+
+  parser->nodes[node].set = mygrep_set_new (regex);
+  if (byte >= 0) {
+    mygrep_set_add (&regex->sets[parser->nodes[node].set], byte);
+    parser->nodes[node].byte = byte;
+  }
+
+  return node;
+}
+
+static int
+mygrep_parse_class (MygrepParser * parser, MygrepRegex * regex)
+{
+  int node = mygrep_node_set (parser, regex, -1), negate = 0, first = 1;
+  int set = parser->nodes[node].set, i;
+
+  if (parser->p < parser->end && *parser->p == '^') {
+    negate = 1;
+    parser->p++;
+  }
+
+  while (parser->p < parser->end && (*parser->p != ']' || first)) {
+    int from, to;
+
+    first = 0;
+    if (parser->p + 1 < parser->end && parser->p[0] == '[' &&
+        (parser->p[1] == ':' || parser->p[1] == '=' || parser->p[1] == '.')) {
+      const char *name = parser->p + 2, *close;
+
+      for (close = name; close + 1 < parser->end; close++) {
+        if (close[0] == parser->p[1] && close[1] == ']')
+          break;
+      }
+      if (close + 1 >= parser->end) {
+        parser->error = "missing ] of a class in [ ]";
+        return -1;
+      }
+      /* the collating elements and their classes are the bytes */
+      if (parser->p[1] != ':') {
+        if (close - name != 1) {
+          parser->error = "[= =] and [. .] take a single byte";
+          return -1;
+        }
+        mygrep_set_add (&regex->sets[set], (uint8_t) * name);
+      } else if (!mygrep_set_add_named (&regex->sets[set], name,
+              close - name)) {
+        parser->error = "unknown class in [ ]";
+        return -1;
+      }
+      parser->p = close + 2;
+      continue;
+    }
+
+    from = (uint8_t) * parser->p++;
+    if (from == '\\' && parser->p < parser->end) {
+      if (mygrep_set_add_escape (&regex->sets[set], *parser->p++))
+        continue;
+      from = (uint8_t) mygrep_escaped (parser->p[-1]);
+    }
+
+    to = from;
+    if (parser->p + 1 < parser->end && parser->p[0] == '-' &&
+        parser->p[1] != ']') {
+      to = (uint8_t) parser->p[1];
+      parser->p += 2;
+      if (to == '\\' && parser->p < parser->end)
+        to = (uint8_t) mygrep_escaped (*parser->p++);
+      if (to < from) {
+        parser->error = "bad range in [ ]";
+        return -1;
+      }
+    }
+    mygrep_set_add_range (&regex->sets[set], from, to);
+  }
+
+  if (parser->p >= parser->end) {
+    parser->error = "missing ]";
+    return -1;
+  }
+  parser->p++;
+
+  if (negate) {
+    for (i = 0; i < 8; i++)
+      regex->sets[set].bits[i] = ~regex->sets[set].bits[i];
+  }
+
+  return node;
+}
+
+static int mygrep_parse_alt (MygrepParser * parser, MygrepRegex * regex);
+
+static int
+mygrep_parse_atom (MygrepParser * parser, MygrepRegex * regex)
+{
+  char c = *parser->p++;
+  int node;
+
+  switch (c) {
+    case '(':
+      node = mygrep_parse_alt (parser, regex);
+      if (node < 0)
+        return -1;
+      if (parser->p >= parser->end || *parser->p != ')') {
+        parser->error = "missing )";
+        return -1;
+      }
+      parser->p++;
+      return node;
+    case '[':
+      return mygrep_parse_class (parser, regex);
+    case '.':
+      node = mygrep_node_set (parser, regex, -1);
+      mygrep_set_add_range (&regex->sets[parser->nodes[node].set], 0, 255);
+      return node;
+    case '^':
+      return mygrep_node (parser, NODE_BOL, -1, -1);
+    case '$':
+      return mygrep_node (parser, NODE_EOL, -1, -1);
+    case '*':
+    case '+':
+    case '?':
+      parser->error = "nothing to repeat";
+      return -1;
+    case '\\':
+      if (parser->p >= parser->end) {
+        parser->error = "trailing \\";
+        return -1;
+      }
+      c = *parser->p++;
+      node = mygrep_node_set (parser, regex, -1);
+      if (mygrep_set_add_escape (&regex->sets[parser->nodes[node].set], c))
+        return node;
+      c = mygrep_escaped (c);
+      mygrep_set_add (&regex->sets[parser->nodes[node].set], (uint8_t) c);
+      parser->nodes[node].byte = (uint8_t) c;
+      return node;
+    default:
+      return mygrep_node_set (parser, regex, (uint8_t) c);
+  }
+}
+
+/* Another tree like the one at @node, the sets are shared */
+static int
+mygrep_node_copy (MygrepParser * parser, int node)
+{
+  MygrepNode n = parser->nodes[node];
+  int left = n.left >= 0 ? mygrep_node_copy (parser, n.left) : -1;
+  int right = n.right >= 0 ? mygrep_node_copy (parser, n.right) : -1;
+  int copy = mygrep_node (parser, n.type, left, right);
+
+  parser->nodes[copy].set = n.set;
+  parser->nodes[copy].byte = n.byte;
+
+  return copy;
+}
+
+/* -1 if there's no number, -2 if it's too big */
+static int
+mygrep_parse_bound (MygrepParser * parser)
+{
+  int n = 0;
+
+  if (parser->p >= parser->end || *parser->p < '0' || *parser->p > '9')
+    return -1;
+  while (parser->p < parser->end && *parser->p >= '0' && *parser->p <= '9') {
+    n = n * 10 + *parser->p++ - '0';
+    if (n > MYGREP_REGEX_DUP_MAX)
+      n = MYGREP_REGEX_DUP_MAX + 1;
+  }
+
+  return n > MYGREP_REGEX_DUP_MAX ? -2 : n;
+}
+
+/* {m}, {m,}, {m,n} and {,n} after @node, @parser being at the {. 0 and
+ * @parser where it was if it isn't one of them, grep takes the { for itself
+ * then. */
+static int
+mygrep_parse_interval (MygrepParser * parser, int *node)
+{
+  const char *start = parser->p++;
+  int min, max, i, ret = -1;
+
+  min = mygrep_parse_bound (parser);
+  max = min;
+  if (parser->p < parser->end && *parser->p == ',') {
+    parser->p++;
+    max = mygrep_parse_bound (parser);
+    if (min == -1 && max == -1) {
+      parser->p = start;
+      return 0;
+    }
+    if (min == -1)
+      min = 0;
+    else if (max == -1)
+      max = INT32_MAX;
+  }
+  if (min == -1 || parser->p >= parser->end || *parser->p != '}') {
+    parser->p = start;
+    return 0;
+  }
+  parser->p++;
+
+  if (min == -2 || max == -2) {
+    parser->error = "{ } repeats more than 255 times";
+    return -1;
+  }
+  if (max < min) {
+    parser->error = "bad { }, the minimum is over the maximum";
+    return -1;
+  }
+
+  /* the atom itself is the first one, copies the others */
+  for (i = 0; i < min; i++) {
+    int next = i ? mygrep_node_copy (parser, *node) : *node;
+
+    ret = ret < 0 ? next : mygrep_node (parser, NODE_CAT, ret, next);
+  }
+  for (; i < max && (max != INT32_MAX || i == min); i++) {
+    int next = i ? mygrep_node_copy (parser, *node) : *node;
+
+    next = mygrep_node (parser, max == INT32_MAX ? NODE_STAR : NODE_QUEST,
+        next, -1);
+    ret = ret < 0 ? next : mygrep_node (parser, NODE_CAT, ret, next);
+  }
+
+  if (parser->n_nodes > MYGREP_REGEX_MAX_NODES) {
+    parser->error = "{ } makes the expression too big";
+    return -1;
+  }
+
+  *node = ret < 0 ? mygrep_node (parser, NODE_EMPTY, -1, -1) : ret;
+  return 1;
+}
+
+static int
+mygrep_parse_repeat (MygrepParser * parser, MygrepRegex * regex)
+{
+  int node = mygrep_parse_atom (parser, regex);
+
+  while (node >= 0 && parser->p < parser->end) {
+    char c = *parser->p;
+
+    if (c == '{') {
+      int interval = mygrep_parse_interval (parser, &node);
+
+      if (interval < 0)
+        return -1;
+      if (interval == 0)
+        break;
+      continue;
+    }
+    if (c == '*')
+      node = mygrep_node (parser, NODE_STAR, node, -1);
+    else if (c == '+')
+      node = mygrep_node (parser, NODE_PLUS, node, -1);
+    else if (c == '?')
+      node = mygrep_node (parser, NODE_QUEST, node, -1);
+    else
+      break;
+    parser->p++;
+  }
+
+  return node;
+}
+
+static int
+mygrep_parse_cat (MygrepParser * parser, MygrepRegex * regex)
+{
+  int node = -1;
+
+  while (parser->p < parser->end && *parser->p != '|' && *parser->p != ')') {
+    int next = mygrep_parse_repeat (parser, regex);
+
+    if (next < 0)
+      return -1;
+    node = node < 0 ? next : mygrep_node (parser, NODE_CAT, node, next);
+  }
+
+  return node < 0 ? mygrep_node (parser, NODE_EMPTY, -1, -1) : node;
+}
+
+static int
+mygrep_parse_alt (MygrepParser * parser, MygrepRegex * regex)
+{
+  int node = mygrep_parse_cat (parser, regex);
+
+  while (node >= 0 && parser->p < parser->end && *parser->p == '|') {
+    int next;
+
+    parser->p++;
+    next = mygrep_parse_cat (parser, regex);
+    if (next < 0)
+      return -1;
+    node = mygrep_node (parser, NODE_ALT, node, next);
+  }
+
+  return node;
+}
+
+/* The longest run of single bytes in the concatenation at the top, which
+ * every match has */
+static void
+mygrep_literal_walk (const MygrepParser * parser, int node, char *run,
+    int *run_len, char *best, int *best_len)
+{
+  const MygrepNode *n = &parser->nodes[node];
+
+  if (n->type == NODE_CAT) {
+    mygrep_literal_walk (parser, n->left, run, run_len, best, best_len);
+    mygrep_literal_walk (parser, n->right, run, run_len, best, best_len);
+    return;
+  }
+
+  if (n->type == NODE_SET && n->byte >= 0 && n->byte != '\n') {
+    run[(*run_len)++] = n->byte;
+    if (*run_len > *best_len) {
+      *best_len = *run_len;
+      memcpy (best, run, *run_len);
+    }
+    return;
+  }
+
+  /* nothing or anything in between, the run is over */
+  *run_len = 0;
+}
+
+static int
+mygrep_literal_only (const MygrepParser * parser, int node)
+{
+  const MygrepNode *n = &parser->nodes[node];
+
+  if (n->type == NODE_CAT)
+    return mygrep_literal_only (parser, n->left) &&
+        mygrep_literal_only (parser, n->right);
+
+  return n->type == NODE_SET && n->byte >= 0 && n->byte != '\n';
+}
+
+/* Compiler */
+
+static int
+mygrep_emit (MygrepRegex * regex, MygrepOp op, int x, int y)
+{
+  regex->prog = mygrep_grow (regex->prog, &regex->prog_size,
+      regex->n_prog + 1, sizeof (MygrepInst));
+  regex->prog[regex->n_prog].op = op;
+  regex->prog[regex->n_prog].x = x;
+  regex->prog[regex->n_prog].y = y;
+
+  return regex->n_prog++;
+}
+
+static void
+mygrep_compile (MygrepRegex * regex, const MygrepParser * parser, int node)
+{
+  const MygrepNode *n = &parser->nodes[node];
+  int split, jmp, start;
+
+  switch (n->type) {
+    case NODE_SET:
+      mygrep_emit (regex, OP_SET, n->set, 0);
+      break;
+    case NODE_BOL:
+      mygrep_emit (regex, OP_BOL, 0, 0);
+      break;
+    case NODE_EOL:
+      mygrep_emit (regex, OP_EOL, 0, 0);
+      break;
+    case NODE_EMPTY:
+      break;
+    case NODE_CAT:
+      mygrep_compile (regex, parser, n->left);
+      mygrep_compile (regex, parser, n->right);
+      break;
+    case NODE_ALT:
+      split = mygrep_emit (regex, OP_SPLIT, regex->n_prog + 1, 0);
+      mygrep_compile (regex, parser, n->left);
+      jmp = mygrep_emit (regex, OP_JMP, 0, 0);
+      regex->prog[split].y = regex->n_prog;
+      mygrep_compile (regex, parser, n->right);
+      regex->prog[jmp].x = regex->n_prog;
+      break;
+    case NODE_STAR:
+      split = mygrep_emit (regex, OP_SPLIT, regex->n_prog + 1, 0);
+      mygrep_compile (regex, parser, n->left);
+      mygrep_emit (regex, OP_JMP, split, 0);
+      regex->prog[split].y = regex->n_prog;
+      break;
+    case NODE_PLUS:
+      start = regex->n_prog;
+      mygrep_compile (regex, parser, n->left);
+      mygrep_emit (regex, OP_SPLIT, start, regex->n_prog + 1);
+      break;
+    case NODE_QUEST:
+      split = mygrep_emit (regex, OP_SPLIT, regex->n_prog + 1, 0);
+      mygrep_compile (regex, parser, n->left);
+      regex->prog[split].y = regex->n_prog;
+      break;
+  }
+}
+
+/* Bytes no set tells apart share a class, the newline has its own */
+static void
+mygrep_regex_classes (MygrepRegex * regex)
+{
+  int map[256][2], s, b;
+
+  memset (regex->classes, 0, sizeof (regex->classes));
+  regex->n_classes = 1;
+
+  for (s = -1; s < regex->n_sets; s++) {
+    int n = 0;
+
+    memset (map, -1, sizeof (map));
+    for (b = 0; b < 256; b++) {
+      int in = s < 0 ? b == '\n' : mygrep_set_has (&regex->sets[s], b);
+      int *to = &map[regex->classes[b]][in];
+
+      if (*to < 0)
+        *to = n++;
+      regex->classes[b] = *to;
+    }
+    regex->n_classes = n;
+  }
+}
+
+/* DFA */
+
+/* Adds the consuming instructions @pc leads to */
+static void
+mygrep_closure_add (MygrepRegex * regex, int *set, int *n, int pc)
+{
+  int top = 0;
+
+  regex->stack[top++] = pc;
+  while (top) {
+    const MygrepInst *inst;
+
+    pc = regex->stack[--top];
+    if (regex->marks[pc] == regex->mark)
+      continue;
+    regex->marks[pc] = regex->mark;
+
+    inst = &regex->prog[pc];
+    if (inst->op == OP_JMP) {
+      regex->stack[top++] = inst->x;
+    } else if (inst->op == OP_SPLIT) {
+      regex->stack[top++] = inst->y;
+      regex->stack[top++] = inst->x;
+    } else {
+      set[(*n)++] = pc;
+    }
+  }
+}
+
+static int
+mygrep_compare_int (const void *a, const void *b)
+{
+  return *(const int *) a - *(const int *) b;
+}
+
+static inline int
+mygrep_regex_takes (const MygrepRegex * regex, int pc, int sym, int bol)
+{
+  const MygrepInst *inst = &regex->prog[pc];
+
+  if (inst->op == OP_SET)
+    return sym < 256 && mygrep_set_has (&regex->sets[inst->x], sym);
+  if (inst->op == OP_BOL)
+    return sym == SYM_BOL || bol;
+  if (inst->op == OP_EOL)
+    return sym == SYM_EOL;
+
+  return 0;
+}
+
+/* What @pcs go to on @sym, to @out, sorted. Returns how many, -1 if a
+ * match is among them. The set of the line start has the extra pc n_prog,
+ * an empty line being the only place both ^ and $ hold. */
+static int
+mygrep_regex_step (MygrepRegex * regex, const int *pcs, int n_pcs, int sym,
+    int *out)
+{
+  int i, n = 0, bol = 0;
+
+  if (sym == SYM_EOL && n_pcs && pcs[n_pcs - 1] == regex->n_prog)
+    bol = 1;
+
+  regex->mark++;
+  for (i = 0; i < n_pcs; i++) {
+    if (pcs[i] < regex->n_prog &&
+        mygrep_regex_takes (regex, pcs[i], sym, bol))
+      mygrep_closure_add (regex, out, &n, pcs[i] + 1);
+  }
+
+  /* not anchored: a match may start after any byte of the line */
+  if (sym != SYM_EOL)
+    mygrep_closure_add (regex, out, &n, 0);
+
+  /* ^ and $ don't take anything, the ones right after hold as well */
+  for (i = 0; sym >= 256 && i < n; i++) {
+    if (regex->prog[out[i]].op != OP_SET &&
+        mygrep_regex_takes (regex, out[i], sym, bol))
+      mygrep_closure_add (regex, out, &n, out[i] + 1);
+  }
+
+  for (i = 0; i < n; i++) {
+    if (regex->prog[out[i]].op == OP_MATCH)
+      return -1;
+  }
+
+  if (sym == SYM_BOL)
+    out[n++] = regex->n_prog;
+
+  qsort (out, n, sizeof (int), mygrep_compare_int);
+  return n;
+}
+
+static uint32_t
+mygrep_hash (const int *pcs, int n)
+{
+  uint32_t h = 2166136261u;
+  int i;
+
+  for (i = 0; i < n; i++)
+    h = (h ^ pcs[i]) * 16777619u;
+
+  return h;
+}
+
+static size_t
+mygrep_regex_cache_used (const MygrepRegex * regex)
+{
+  return (size_t) regex->n_states * (regex->n_classes * sizeof (int) +
+      sizeof (MygrepDState)) + regex->n_pcs * sizeof (int) +
+      regex->table_size * sizeof (int);
+}
+
+static void
+mygrep_regex_flush (MygrepRegex * regex)
+{
+  regex->n_states = 0;
+  regex->n_pcs = 0;
+  memset (regex->table, -1, regex->table_size * sizeof (int));
+  regex->flushes++;
+}
+
+static void
+mygrep_regex_rehash (MygrepRegex * regex)
+{
+  int s;
+
+  regex->table_size = regex->table_size ? regex->table_size * 2 : 64;
+  regex->table = realloc (regex->table, regex->table_size * sizeof (int));
+  memset (regex->table, -1, regex->table_size * sizeof (int));
+
+  for (s = 0; s < regex->n_states; s++) {
+    int slot = regex->states[s].hash & (regex->table_size - 1);
+
+    while (regex->table[slot] >= 0)
+      slot = (slot + 1) & (regex->table_size - 1);
+    regex->table[slot] = s;
+  }
+}
+
+/* The state of @pcs, made if there's none yet. Returns its row. */
+static int
+mygrep_regex_add_full (MygrepRegex * regex, const int *pcs, int n,
+    int may_flush)
+{
+  uint32_t hash = mygrep_hash (pcs, n);
+  MygrepDState *state;
+  int slot, s, c;
+
+  slot = hash & (regex->table_size - 1);
+  for (; (s = regex->table[slot]) >= 0;
+      slot = (slot + 1) & (regex->table_size - 1)) {
+    state = &regex->states[s];
+    if (state->hash == hash && state->len == n &&
+        !memcmp (&regex->pcs[state->start], pcs, n * sizeof (int)))
+      return s * regex->n_classes;
+  }
+
+  /* full, start over from this state and the one of the line start */
+  if (may_flush && mygrep_regex_cache_used (regex) > regex->cache_size) {
+    mygrep_regex_flush (regex);
+    regex->line_start = mygrep_regex_add_full (regex, regex->start_pcs,
+        regex->n_start_pcs, 0);
+    return mygrep_regex_add_full (regex, pcs, n, 0);
+  }
+
+  if ((regex->n_states + 1) * 2 > regex->table_size) {
+    mygrep_regex_rehash (regex);
+    return mygrep_regex_add_full (regex, pcs, n, 0);
+  }
+
+  s = regex->n_states++;
+  regex->states = mygrep_grow (regex->states, &regex->states_size,
+      regex->n_states, sizeof (MygrepDState));
+  regex->pcs = mygrep_grow (regex->pcs, &regex->pcs_size, regex->n_pcs + n,
+      sizeof (int));
+
+  /* trans grows along with states, states_size rows */
+  regex->trans = realloc (regex->trans,
+      (size_t) regex->states_size * regex->n_classes * sizeof (int));
+  for (c = 0; c < regex->n_classes; c++)
+    regex->trans[s * regex->n_classes + c] = STATE_UNKNOWN;
+
+  state = &regex->states[s];
+  state->start = regex->n_pcs;
+  state->len = n;
+  state->hash = hash;
+  memcpy (&regex->pcs[regex->n_pcs], pcs, n * sizeof (int));
+  regex->n_pcs += n;
+  regex->table[slot] = s;
+
+  return s * regex->n_classes;
+}
+
+static int
+mygrep_regex_add (MygrepRegex * regex, const int *pcs, int n)
+{
+  return mygrep_regex_add_full (regex, pcs, n, 1);
+}
+
+/* From the state of row @row on a byte of class @cls */
+static int
+mygrep_regex_transition (MygrepRegex * regex, int row, int cls, int byte)
+{
+  const MygrepDState *state = &regex->states[row / regex->n_classes];
+  int flushes = regex->flushes, n, next;
+
+  /* the end of the line, then the start of the next one */
+  if (byte == '\n') {
+    n = mygrep_regex_step (regex, &regex->pcs[state->start], state->len,
+        SYM_EOL, regex->scratch);
+    next = n < 0 ? STATE_MATCH : regex->line_start;
+  } else {
+    n = mygrep_regex_step (regex, &regex->pcs[state->start], state->len,
+        byte, regex->scratch);
+    next = n < 0 ? STATE_MATCH : mygrep_regex_add (regex, regex->scratch, n);
+  }
+
+  /* after a flush the row is some other state's, or none */
+  if (regex->flushes == flushes)
+    regex->trans[row + cls] = next;
+
+  return next;
+}
+
+static inline int
+mygrep_regex_next (MygrepRegex * regex, int row, uint8_t byte)
+{
+  int cls = regex->classes[byte];
+  int next = regex->trans[row + cls];
+
+  if (next == STATE_UNKNOWN)
+    next = mygrep_regex_transition (regex, row, cls, byte);
+
+  return next;
+}
+
+MygrepRegex *
+mygrep_regex_new (const char *pattern, size_t cache_size,
+    MygrepRegexFlags flags, const char **error)
+{
+  MygrepRegex *regex = calloc (1, sizeof (MygrepRegex));
+  MygrepParser parser = { 0 };
+  int root, n, s;
+
+  parser.p = pattern;
+  parser.end = pattern + strlen (pattern);
+
+  root = mygrep_parse_alt (&parser, regex);
+  if (root >= 0 && parser.p < parser.end) {
+    parser.error = "unmatched )";
+    root = -1;
+  }
+  if (root < 0) {
+    *error = parser.error;
+    free (parser.nodes);
+    free (regex->sets);
+    free (regex);
+    return NULL;
+  }
+
+  /* the newline ends the line before anything can take it */
+  for (s = 0; s < regex->n_sets; s++) {
+    int c;
+
+    regex->sets[s].bits['\n' >> 5] &= ~(1u << ('\n' & 31));
+    for (c = 'a'; c <= 'z' && (flags & MYGREP_REGEX_IGNORE_CASE); c++) {
+      if (mygrep_set_has (&regex->sets[s], c) ||
+          mygrep_set_has (&regex->sets[s], c - 0x20)) {
+        mygrep_set_add (&regex->sets[s], c);
+        mygrep_set_add (&regex->sets[s], c - 0x20);
+      }
+    }
+  }
+
+  mygrep_compile (regex, &parser, root);
+  mygrep_emit (regex, OP_MATCH, 0, 0);
+  mygrep_regex_classes (regex);
+
+  {
+    char *run = malloc (parser.n_nodes + 1);
+    int run_len = 0, best_len = 0;
+
+    regex->literal = calloc (parser.n_nodes + 1, 1);
+    mygrep_literal_walk (&parser, root, run, &run_len, regex->literal,
+        &best_len);
+    free (run);
+
+    if (best_len >= 2) {
+      int i;
+
+      regex->prefilter = mygrep_pattern_new_full (regex->literal, best_len,
+          MYGREP_ALGO_AUTO, (flags & MYGREP_REGEX_IGNORE_CASE) ?
+          MYGREP_PATTERN_IGNORE_CASE : 0);
+      regex->exact = mygrep_literal_only (&parser, root);
+      /* the prefilter folds more than ASCII */
+      for (i = 0; i < best_len && (flags & MYGREP_REGEX_IGNORE_CASE); i++) {
+        if ((uint8_t) regex->literal[i] >= 0x80)
+          regex->exact = 0;
+      }
+    } else {
+      free (regex->literal);
+      regex->literal = NULL;
+    }
+  }
+  free (parser.nodes);
+
+  regex->cache_size = cache_size ? cache_size : MYGREP_REGEX_CACHE;
+  regex->marks = calloc (regex->n_prog, sizeof (int));
+  regex->stack = malloc ((regex->n_prog * 2 + 1) * sizeof (int));
+  regex->scratch = malloc ((regex->n_prog + 1) * sizeof (int));
+  regex->start_pcs = malloc ((regex->n_prog + 1) * sizeof (int));
+  mygrep_regex_rehash (regex);
+
+  /* the state every line starts in, after its BOL */
+  regex->mark++;
+  n = 0;
+  mygrep_closure_add (regex, regex->scratch, &n, 0);
+  qsort (regex->scratch, n, sizeof (int), mygrep_compare_int);
+  regex->n_start_pcs = mygrep_regex_step (regex, regex->scratch, n, SYM_BOL,
+      regex->start_pcs);
+  regex->line_start = regex->n_start_pcs < 0 ? STATE_MATCH :
+      mygrep_regex_add (regex, regex->start_pcs, regex->n_start_pcs);
+
+  return regex;
+}
+
+void
+mygrep_regex_free (MygrepRegex * regex)
+{
+  if (regex->prefilter)
+    mygrep_pattern_free (regex->prefilter);
+  free (regex->literal);
+  free (regex->prog);
+  free (regex->sets);
+  free (regex->trans);
+  free (regex->states);
+  free (regex->pcs);
+  free (regex->table);
+  free (regex->start_pcs);
+  free (regex->marks);
+  free (regex->stack);
+  free (regex->scratch);
+  free (regex);
+}
+
+const char *
+mygrep_regex_literal (const MygrepRegex * regex)
+{
+  return regex->literal;
+}
+
+int
+mygrep_regex_flushes (const MygrepRegex * regex)
+{
+  return regex->flushes;
+}
+
+/* The line of @p, which may be its newline */
+static const char *
+mygrep_regex_line (const char *where, const char *z, const char *p,
+    size_t *len)
+{
+  const char *start = memrchr (where, '\n', p - where);
+  const char *end = memchr (p, '\n', z - p);
+
+  start = start ? start + 1 : where;
+  *len = (end ? end : z) - start;
+
+  return start;
+}
+
+static int
+mygrep_regex_match_line (MygrepRegex * regex, const char *line, size_t len)
+{
+  int s = regex->line_start;
+  size_t i;
+
+  for (i = 0; i < len && s != STATE_MATCH; i++)
+    s = mygrep_regex_next (regex, s, line[i]);
+
+  return s == STATE_MATCH || mygrep_regex_next (regex, s, '\n') == STATE_MATCH;
+}
+
+const char *
+mygrep_regex_find_line (MygrepRegex * regex, const char *where, size_t size,
+    size_t *len)
+{
+  const char *p = where, *z = where + size;
+  int s;
+
+  if (size == 0)
+    return NULL;
+
+  if (regex->prefilter) {
+    const char *match;
+
+    while ((match = mygrep_pattern_find (regex->prefilter, p, z - p))) {
+      const char *line = mygrep_regex_line (p, z, match, len);
+
+      if (regex->exact || mygrep_regex_match_line (regex, line, *len))
+        return line;
+      if (line + *len == z)
+        break;
+      p = line + *len + 1;
+    }
+
+    return NULL;
+  }
+
+  s = regex->line_start;
+  if (s == STATE_MATCH)
+    return mygrep_regex_line (where, z, where, len);
+
+  for (; p < z; p++) {
+    s = mygrep_regex_next (regex, s, *p);
+    if (s == STATE_MATCH)
+      return mygrep_regex_line (where, z, p, len);
+  }
+
+  /* the last line has no newline */
+  if (z[-1] != '\n' && mygrep_regex_next (regex, s, '\n') == STATE_MATCH)
+    return mygrep_regex_line (where, z, z - 1, len);
+
+  return NULL;
+}
+
+size_t
+mygrep_regex_count (MygrepRegex * regex, const char *where, size_t size)
+{
+  const char *line, *z = where + size;
+  size_t count = 0, len;
+
+  while ((line = mygrep_regex_find_line (regex, where, z - where, &len))) {
+    count++;
+    if (line + len >= z)
+      break;
+    where = line + len + 1;
+  }
+
+  return count;
+}
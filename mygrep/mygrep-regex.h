@@ -0,0 +1,79 @@
+/* Regular expressions of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Line oriented, like grep: a line matches if the expression matches
+ * anywhere in it, '.' and the classes don't take the newline, ^ and $ are
+ * the start and the end of the line.
+ *
+ * The syntax is the usual one of the extended expressions: . [a-z] [^...]
+ * with [:digit:] and the other classes of POSIX over the ASCII bytes,
+ * \d \w \s, * + ? {m,n}, | and ( ). \ takes anything else literally, and
+ * like in grep so does a { that doesn't start a {m,n}. A {m,n} repeats at
+ * most 255 times.
+ *
+ * The expression compiles to a program of the Thompson NFA, and a DFA is
+ * built from it lazily, a state the first time the text gets there. The
+ * states take at most the cache size given, when it's full the cache is
+ * emptied and goes on from where it was, so a pathological expression
+ * gets slower but never takes the memory.
+ *
+ * The longest literal every match has to contain ("ERROR" in
+ * "0:0[0-9].*ERROR.*pad") is searched for first with the substring search,
+ * and only the lines it's found in go through the DFA. */
+
+#ifndef MYGREP_REGEX_H
+#define MYGREP_REGEX_H
+
+#include <stddef.h>
+
+/* Of the states, the default one */
+#define MYGREP_REGEX_CACHE (1 << 20)
+
+typedef enum
+{
+  /* the case of the ASCII letters doesn't matter */
+  MYGREP_REGEX_IGNORE_CASE = 1 << 0
+} MygrepRegexFlags;
+
+typedef struct _MygrepRegex MygrepRegex;
+
+/* Returns NULL and sets @error to what's wrong if @pattern doesn't parse.
+ * @cache_size 0 is MYGREP_REGEX_CACHE. */
+MygrepRegex *mygrep_regex_new (const char *pattern, size_t cache_size,
+    MygrepRegexFlags flags, const char **error);
+void mygrep_regex_free (MygrepRegex * regex);
+
+/* The first line with a match, @where being the start of a line. @len gets
+ * its length without the newline. NULL if none. The DFA grows as it goes,
+ * so the regex can't be used by two threads at once. */
+const char *mygrep_regex_find_line (MygrepRegex * regex, const char *where,
+    size_t size, size_t *len);
+
+/* Lines with a match */
+size_t mygrep_regex_count (MygrepRegex * regex, const char *where,
+    size_t size);
+
+/* What the prefilter looks for, NULL if nothing */
+const char *mygrep_regex_literal (const MygrepRegex * regex);
+
+/* How many times the cache got full */
+int mygrep_regex_flushes (const MygrepRegex * regex);
+
+#endif
@@ -0,0 +1,642 @@
+/* Search engines of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* This file goes through the IFTR once per backend, so everything but the
+ * interface instance has to be static. The vector code is whatever the
+ * backend flags enable: AVX2 takes 32 positions at once, SSE2 16, and the
+ * rest is memchr () + memcmp ().
+ *
+ * A position is a candidate if both the first and the last byte of the
+ * pattern match there, which for text is rare enough that the memcmp () of
+ * the middle doesn't matter.
+ *
+ * Without the case it's the same filter on the two bytes MygrepFold picks,
+ * with its bits of the case set on both sides, and the folded compare of
+ * the candidates. */
+
+#include "mygrep-search.h"
+#include "iftr/iface-trampoline.h"
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+#define MYGREP_LANES 32
+typedef __m256i MygrepVec;
+
+static inline MygrepVec
+mygrep_splat (char c)
+{
+  return _mm256_set1_epi8 (c);
+}
+
+static inline MygrepVec
+mygrep_splat16 (uint16_t v)
+{
+  return _mm256_set1_epi16 (v);
+}
+
+/* bit i: the first byte matches at @p + i and the last one at @q + i */
+static inline uint32_t
+mygrep_candidates (const char *p, const char *q, MygrepVec first,
+    MygrepVec last)
+{
+  MygrepVec a = _mm256_loadu_si256 ((const MygrepVec *) p);
+  MygrepVec b = _mm256_loadu_si256 ((const MygrepVec *) q);
+
+  return _mm256_movemask_epi8 (_mm256_and_si256 (_mm256_cmpeq_epi8 (a, first),
+          _mm256_cmpeq_epi8 (b, last)));
+}
+
+/* the same, with @fmask and @lmask ORed into the bytes first */
+static inline uint32_t
+mygrep_candidates_fold (const char *p, const char *q, MygrepVec first,
+    MygrepVec last, MygrepVec fmask, MygrepVec lmask)
+{
+  MygrepVec a = _mm256_or_si256 (_mm256_loadu_si256 ((const MygrepVec *) p),
+      fmask);
+  MygrepVec b = _mm256_or_si256 (_mm256_loadu_si256 ((const MygrepVec *) q),
+      lmask);
+
+  return _mm256_movemask_epi8 (_mm256_and_si256 (_mm256_cmpeq_epi8 (a, first),
+          _mm256_cmpeq_epi8 (b, last)));
+}
+
+/* Bytes equal to @c in the @n vectors from @p. The equal lanes count down
+ * in bytes, up to 255 vectors, then go to 64 bits through a sum of absolute
+ * differences: a popcount of the whole vector at once. */
+static inline size_t
+mygrep_count_vecs (const char *p, size_t n, MygrepVec c)
+{
+  size_t ans = 0;
+
+  while (n) {
+    size_t k = n < 255 ? n : 255;
+    MygrepVec acc = _mm256_setzero_si256 ();
+
+    for (n -= k; k; k--, p += MYGREP_LANES)
+      acc = _mm256_sub_epi8 (acc,
+          _mm256_cmpeq_epi8 (_mm256_loadu_si256 ((const MygrepVec *) p), c));
+
+    acc = _mm256_sad_epu8 (acc, _mm256_setzero_si256 ());
+    ans += _mm256_extract_epi16 (acc, 0) + _mm256_extract_epi16 (acc, 4) +
+        _mm256_extract_epi16 (acc, 8) + _mm256_extract_epi16 (acc, 12);
+  }
+
+  return ans;
+}
+
+/* keep &= lo <= p[i] <= hi, flipped by @flip: a byte minus lo is inside if
+ * the unsigned minimum with the span leaves it as it is */
+static inline void
+mygrep_keep_u8 (const uint8_t * p, uint8_t * keep, MygrepVec lo,
+    MygrepVec span, MygrepVec flip)
+{
+  MygrepVec d = _mm256_sub_epi8 (_mm256_loadu_si256 ((const MygrepVec *) p),
+      lo);
+  MygrepVec in = _mm256_cmpeq_epi8 (_mm256_min_epu8 (d, span), d);
+
+  _mm256_storeu_si256 ((MygrepVec *) keep,
+      _mm256_and_si256 (_mm256_loadu_si256 ((const MygrepVec *) keep),
+          _mm256_xor_si256 (in, flip)));
+}
+
+/* The same for MYGREP_LANES 16 bit values, the masks packed to bytes */
+static inline void
+mygrep_keep_u16 (const uint16_t * p, uint8_t * keep, MygrepVec lo,
+    MygrepVec span, MygrepVec flip)
+{
+  MygrepVec a = _mm256_sub_epi16 (_mm256_loadu_si256 ((const MygrepVec *) p),
+      lo);
+  MygrepVec b = _mm256_sub_epi16 (_mm256_loadu_si256 ((const MygrepVec *)
+          (p + 16)), lo);
+  MygrepVec in;
+
+  a = _mm256_cmpeq_epi16 (_mm256_min_epu16 (a, span), a);
+  b = _mm256_cmpeq_epi16 (_mm256_min_epu16 (b, span), b);
+  /* packs goes by 128 bit lanes */
+  in = _mm256_permute4x64_epi64 (_mm256_packs_epi16 (a, b), 0xd8);
+
+  _mm256_storeu_si256 ((MygrepVec *) keep,
+      _mm256_and_si256 (_mm256_loadu_si256 ((const MygrepVec *) keep),
+          _mm256_xor_si256 (in, flip)));
+}
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+
+#define MYGREP_LANES 16
+typedef __m128i MygrepVec;
+
+static inline MygrepVec
+mygrep_splat (char c)
+{
+  return _mm_set1_epi8 (c);
+}
+
+static inline MygrepVec
+mygrep_splat16 (uint16_t v)
+{
+  return _mm_set1_epi16 (v);
+}
+
+static inline uint32_t
+mygrep_candidates (const char *p, const char *q, MygrepVec first,
+    MygrepVec last)
+{
+  MygrepVec a = _mm_loadu_si128 ((const MygrepVec *) p);
+  MygrepVec b = _mm_loadu_si128 ((const MygrepVec *) q);
+
+  return _mm_movemask_epi8 (_mm_and_si128 (_mm_cmpeq_epi8 (a, first),
+          _mm_cmpeq_epi8 (b, last)));
+}
+
+static inline uint32_t
+mygrep_candidates_fold (const char *p, const char *q, MygrepVec first,
+    MygrepVec last, MygrepVec fmask, MygrepVec lmask)
+{
+  MygrepVec a = _mm_or_si128 (_mm_loadu_si128 ((const MygrepVec *) p), fmask);
+  MygrepVec b = _mm_or_si128 (_mm_loadu_si128 ((const MygrepVec *) q), lmask);
+
+  return _mm_movemask_epi8 (_mm_and_si128 (_mm_cmpeq_epi8 (a, first),
+          _mm_cmpeq_epi8 (b, last)));
+}
+
+static inline size_t
+mygrep_count_vecs (const char *p, size_t n, MygrepVec c)
+{
+  size_t ans = 0;
+
+  while (n) {
+    size_t k = n < 255 ? n : 255;
+    MygrepVec acc = _mm_setzero_si128 ();
+
+    for (n -= k; k; k--, p += MYGREP_LANES)
+      acc = _mm_sub_epi8 (acc,
+          _mm_cmpeq_epi8 (_mm_loadu_si128 ((const MygrepVec *) p), c));
+
+    acc = _mm_sad_epu8 (acc, _mm_setzero_si128 ());
+    ans += _mm_extract_epi16 (acc, 0) + _mm_extract_epi16 (acc, 4);
+  }
+
+  return ans;
+}
+
+static inline void
+mygrep_keep_u8 (const uint8_t * p, uint8_t * keep, MygrepVec lo,
+    MygrepVec span, MygrepVec flip)
+{
+  MygrepVec d = _mm_sub_epi8 (_mm_loadu_si128 ((const MygrepVec *) p), lo);
+  MygrepVec in = _mm_cmpeq_epi8 (_mm_min_epu8 (d, span), d);
+
+  _mm_storeu_si128 ((MygrepVec *) keep,
+      _mm_and_si128 (_mm_loadu_si128 ((const MygrepVec *) keep),
+          _mm_xor_si128 (in, flip)));
+}
+
+/* SSE2 has no unsigned 16 bit minimum: the values go signed with their
+ * top bit flipped, and over the span is outside */
+static inline void
+mygrep_keep_u16 (const uint16_t * p, uint8_t * keep, MygrepVec lo,
+    MygrepVec span, MygrepVec flip)
+{
+  const MygrepVec top = _mm_set1_epi16 ((short) 0x8000);
+  MygrepVec a = _mm_xor_si128 (_mm_sub_epi16 (_mm_loadu_si128 ((const
+                  MygrepVec *) p), lo), top);
+  MygrepVec b = _mm_xor_si128 (_mm_sub_epi16 (_mm_loadu_si128 ((const
+                  MygrepVec *) (p + 8)), lo), top);
+  MygrepVec s = _mm_xor_si128 (span, top);
+  MygrepVec out = _mm_packs_epi16 (_mm_cmpgt_epi16 (a, s),
+      _mm_cmpgt_epi16 (b, s));
+
+  _mm_storeu_si128 ((MygrepVec *) keep,
+      _mm_andnot_si128 (_mm_xor_si128 (out, flip),
+          _mm_loadu_si128 ((const MygrepVec *) keep)));
+}
+#endif
+
+static size_t
+mygrep_count (const char *where, size_t size, const char *what,
+    size_t what_len, size_t *resume)
+{
+  size_t ans = 0, i = 0, end;
+
+  if (what_len == 0 || what_len > size) {
+    if (resume)
+      *resume = what_len ? 0 : size;
+    return 0;
+  }
+
+  /* one past the last position a match can start at */
+  end = size - what_len + 1;
+
+#ifdef MYGREP_LANES
+  {
+    const MygrepVec first = mygrep_splat (what[0]);
+    const MygrepVec last = mygrep_splat (what[what_len - 1]);
+
+    /* the loads of the last byte end right at the end of the buffer */
+    while (i + MYGREP_LANES <= end) {
+      uint32_t mask = mygrep_candidates (where + i, where + i + what_len - 1,
+          first, last);
+      size_t next = i + MYGREP_LANES;
+
+      while (mask) {
+        size_t pos = i + __builtin_ctz (mask);
+
+        if (what_len > 2 && memcmp (where + pos + 1, what + 1, what_len - 2)) {
+          mask &= mask - 1;
+          continue;
+        }
+
+        ans++;
+        /* the next match can't overlap this one */
+        if (pos + what_len >= next) {
+          next = pos + what_len;
+          break;
+        }
+        mask &= ~0u << (pos + what_len - i);
+      }
+
+      i = next;
+    }
+  }
+#endif
+
+  while (i < end) {
+    const char *p = memchr (where + i, what[0], end - i);
+
+    if (!p) {
+      i = end;
+      break;
+    }
+
+    i = p - where;
+    if (!memcmp (p, what, what_len)) {
+      ans++;
+      i += what_len;
+    } else {
+      i++;
+    }
+  }
+
+  if (resume)
+    *resume = i;
+
+  return ans;
+}
+
+static const char *
+mygrep_find (const char *where, size_t size, const char *what,
+    size_t what_len)
+{
+  size_t i = 0, end;
+
+  if (what_len == 0 || what_len > size)
+    return NULL;
+
+  end = size - what_len + 1;
+
+#ifdef MYGREP_LANES
+  {
+    const MygrepVec first = mygrep_splat (what[0]);
+    const MygrepVec last = mygrep_splat (what[what_len - 1]);
+
+    for (; i + MYGREP_LANES <= end; i += MYGREP_LANES) {
+      uint32_t mask = mygrep_candidates (where + i, where + i + what_len - 1,
+          first, last);
+
+      for (; mask; mask &= mask - 1) {
+        size_t pos = i + __builtin_ctz (mask);
+
+        if (what_len <= 2 || !memcmp (where + pos + 1, what + 1, what_len - 2))
+          return where + pos;
+      }
+    }
+  }
+#endif
+
+  while (i < end) {
+    const char *p = memchr (where + i, what[0], end - i);
+
+    if (!p)
+      break;
+    if (!memcmp (p, what, what_len))
+      return p;
+    i = p - where + 1;
+  }
+
+  return NULL;
+}
+
+static size_t
+mygrep_count_byte (const char *where, size_t size, char c)
+{
+  size_t ans = 0, i = 0;
+
+#ifdef MYGREP_LANES
+  i = size / MYGREP_LANES * MYGREP_LANES;
+  ans = mygrep_count_vecs (where, size / MYGREP_LANES, mygrep_splat (c));
+#endif
+
+  for (; i < size; i++)
+    ans += where[i] == c;
+
+  return ans;
+}
+
+/* Whether a match of @fold may start at @p, by its two bytes */
+static inline int
+mygrep_fold_candidate (const char *p, const MygrepFold * fold)
+{
+  return ((uint8_t) p[fold->off[0]] | fold->mask[0]) == fold->byte[0] &&
+      ((uint8_t) p[fold->off[1]] | fold->mask[1]) == fold->byte[1];
+}
+
+static size_t
+mygrep_count_fold (const char *where, size_t size, const MygrepFold * fold,
+    size_t *resume)
+{
+  size_t ans = 0, i = 0, end, len = fold->len;
+
+  if (len == 0 || len > size) {
+    if (resume)
+      *resume = len ? 0 : size;
+    return 0;
+  }
+
+  end = size - len + 1;
+
+#ifdef MYGREP_LANES
+  {
+    const MygrepVec first = mygrep_splat (fold->byte[0]);
+    const MygrepVec last = mygrep_splat (fold->byte[1]);
+    const MygrepVec fmask = mygrep_splat (fold->mask[0]);
+    const MygrepVec lmask = mygrep_splat (fold->mask[1]);
+
+    while (i + MYGREP_LANES <= end) {
+      uint32_t mask = mygrep_candidates_fold (where + i + fold->off[0],
+          where + i + fold->off[1], first, last, fmask, lmask);
+      size_t next = i + MYGREP_LANES;
+
+      while (mask) {
+        size_t pos = i + __builtin_ctz (mask);
+
+        if (!mygrep_fold_equal (where + pos, fold->folded, len)) {
+          mask &= mask - 1;
+          continue;
+        }
+
+        ans++;
+        if (pos + len >= next) {
+          next = pos + len;
+          break;
+        }
+        mask &= ~0u << (pos + len - i);
+      }
+
+      i = next;
+    }
+  }
+#endif
+
+  while (i < end) {
+    if (mygrep_fold_candidate (where + i, fold) &&
+        mygrep_fold_equal (where + i, fold->folded, len)) {
+      ans++;
+      i += len;
+    } else {
+      i++;
+    }
+  }
+
+  if (resume)
+    *resume = i;
+
+  return ans;
+}
+
+static const char *
+mygrep_find_fold (const char *where, size_t size, const MygrepFold * fold)
+{
+  size_t i = 0, end, len = fold->len;
+
+  if (len == 0 || len > size)
+    return NULL;
+
+  end = size - len + 1;
+
+#ifdef MYGREP_LANES
+  {
+    const MygrepVec first = mygrep_splat (fold->byte[0]);
+    const MygrepVec last = mygrep_splat (fold->byte[1]);
+    const MygrepVec fmask = mygrep_splat (fold->mask[0]);
+    const MygrepVec lmask = mygrep_splat (fold->mask[1]);
+
+    for (; i + MYGREP_LANES <= end; i += MYGREP_LANES) {
+      uint32_t mask = mygrep_candidates_fold (where + i + fold->off[0],
+          where + i + fold->off[1], first, last, fmask, lmask);
+
+      for (; mask; mask &= mask - 1) {
+        size_t pos = i + __builtin_ctz (mask);
+
+        if (mygrep_fold_equal (where + pos, fold->folded, len))
+          return where + pos;
+      }
+    }
+  }
+#endif
+
+  for (; i < end; i++) {
+    if (mygrep_fold_candidate (where + i, fold) &&
+        mygrep_fold_equal (where + i, fold->folded, len))
+      return where + i;
+  }
+
+  return NULL;
+}
+
+static void
+mygrep_select_u8 (const uint8_t * column, size_t n, uint8_t lo, uint8_t hi,
+    int outside, uint8_t * keep)
+{
+  size_t i = 0;
+
+#ifdef MYGREP_LANES
+  MygrepVec vlo = mygrep_splat (lo), span = mygrep_splat (hi - lo);
+  MygrepVec flip = mygrep_splat (outside ? 0xff : 0);
+
+  for (; i + MYGREP_LANES <= n; i += MYGREP_LANES)
+    mygrep_keep_u8 (column + i, keep + i, vlo, span, flip);
+#endif
+
+  for (; i < n; i++)
+    if (((uint8_t) (column[i] - lo) <= (uint8_t) (hi - lo)) == !!outside)
+      keep[i] = 0;
+}
+
+static void
+mygrep_select_u16 (const uint16_t * column, size_t n, uint16_t lo,
+    uint16_t hi, int outside, uint8_t * keep)
+{
+  size_t i = 0;
+
+#ifdef MYGREP_LANES
+  MygrepVec vlo = mygrep_splat16 (lo), span = mygrep_splat16 (hi - lo);
+  MygrepVec flip = mygrep_splat (outside ? 0xff : 0);
+
+  for (; i + MYGREP_LANES <= n; i += MYGREP_LANES)
+    mygrep_keep_u16 (column + i, keep + i, vlo, span, flip);
+#endif
+
+  for (; i < n; i++)
+    if (((uint16_t) (column[i] - lo) <= (uint16_t) (hi - lo)) == !!outside)
+      keep[i] = 0;
+}
+
+/* The columns of Myers' matrix as bit vectors, with the pattern at the top
+ * of the word: what's under it stays Pv = ~0, Mv = 0 and carries nothing
+ * up, and the last row is bit 63 whatever the length. The score goes as
+ * bias + the errors so far - m, negative is a match: no 64 bit compares,
+ * which SSE2 doesn't have, the sign bit is enough. */
+static unsigned
+mygrep_fuzzy (const uint64_t * peq, const uint64_t * bias, const char *text,
+    size_t size, unsigned want)
+{
+  size_t i;
+
+#if defined(__AVX2__)
+  __m256i pv = _mm256_set1_epi64x (-1), mv = _mm256_setzero_si256 ();
+  __m256i ones = pv, hit = mv;
+  __m256i d = _mm256_loadu_si256 ((const __m256i *) bias);
+
+  for (i = 0; i < size; i++) {
+    __m256i eq = _mm256_loadu_si256 ((const __m256i *) (peq +
+            (uint8_t) text[i] * MYGREP_FUZZY_WORDS));
+    __m256i xv = _mm256_or_si256 (eq, mv);
+    __m256i xh = _mm256_or_si256 (_mm256_xor_si256 (_mm256_add_epi64
+            (_mm256_and_si256 (eq, pv), pv), pv), eq);
+    __m256i ph = _mm256_or_si256 (mv,
+        _mm256_andnot_si256 (_mm256_or_si256 (xh, pv), ones));
+    __m256i mh = _mm256_and_si256 (pv, xh);
+
+    d = _mm256_sub_epi64 (_mm256_add_epi64 (d, _mm256_srli_epi64 (ph, 63)),
+        _mm256_srli_epi64 (mh, 63));
+    hit = _mm256_or_si256 (hit, d);
+
+    ph = _mm256_slli_epi64 (ph, 1);
+    mh = _mm256_slli_epi64 (mh, 1);
+    pv = _mm256_or_si256 (mh,
+        _mm256_andnot_si256 (_mm256_or_si256 (xv, ph), ones));
+    mv = _mm256_and_si256 (ph, xv);
+
+    if ((i & 63) == 63 &&
+        (_mm256_movemask_pd (_mm256_castsi256_pd (hit)) & want) == want)
+      break;
+  }
+
+  return _mm256_movemask_pd (_mm256_castsi256_pd (hit));
+#elif defined(__SSE2__)
+  __m128i pv[2], mv[2], d[2], hit[2];
+  __m128i ones = _mm_set1_epi32 (-1);
+  int h;
+
+  for (h = 0; h < 2; h++) {
+    pv[h] = ones;
+    mv[h] = hit[h] = _mm_setzero_si128 ();
+    d[h] = _mm_loadu_si128 ((const __m128i *) (bias + 2 * h));
+  }
+
+  for (i = 0; i < size; i++) {
+    const uint64_t *column = peq + (uint8_t) text[i] * MYGREP_FUZZY_WORDS;
+
+    for (h = 0; h < 2; h++) {
+      __m128i eq = _mm_loadu_si128 ((const __m128i *) (column + 2 * h));
+      __m128i xv = _mm_or_si128 (eq, mv[h]);
+      __m128i xh = _mm_or_si128 (_mm_xor_si128 (_mm_add_epi64
+              (_mm_and_si128 (eq, pv[h]), pv[h]), pv[h]), eq);
+      __m128i ph = _mm_or_si128 (mv[h],
+          _mm_andnot_si128 (_mm_or_si128 (xh, pv[h]), ones));
+      __m128i mh = _mm_and_si128 (pv[h], xh);
+
+      d[h] = _mm_sub_epi64 (_mm_add_epi64 (d[h], _mm_srli_epi64 (ph, 63)),
+          _mm_srli_epi64 (mh, 63));
+      hit[h] = _mm_or_si128 (hit[h], d[h]);
+
+      ph = _mm_slli_epi64 (ph, 1);
+      mh = _mm_slli_epi64 (mh, 1);
+      pv[h] = _mm_or_si128 (mh,
+          _mm_andnot_si128 (_mm_or_si128 (xv, ph), ones));
+      mv[h] = _mm_and_si128 (ph, xv);
+    }
+
+    if ((i & 63) == 63 &&
+        ((_mm_movemask_pd (_mm_castsi128_pd (hit[0])) |
+                _mm_movemask_pd (_mm_castsi128_pd (hit[1])) << 2) & want) ==
+        want)
+      break;
+  }
+
+  return _mm_movemask_pd (_mm_castsi128_pd (hit[0])) |
+      _mm_movemask_pd (_mm_castsi128_pd (hit[1])) << 2;
+#else
+  uint64_t pv[MYGREP_FUZZY_WORDS], mv[MYGREP_FUZZY_WORDS];
+  uint64_t d[MYGREP_FUZZY_WORDS];
+  unsigned found = 0;
+  int w;
+
+  for (w = 0; w < MYGREP_FUZZY_WORDS; w++) {
+    pv[w] = ~(uint64_t) 0;
+    mv[w] = 0;
+    d[w] = bias[w];
+  }
+
+  for (i = 0; i < size && (found & want) != want; i++) {
+    const uint64_t *column = peq + (uint8_t) text[i] * MYGREP_FUZZY_WORDS;
+
+    for (w = 0; w < MYGREP_FUZZY_WORDS; w++) {
+      uint64_t eq = column[w], xv = eq | mv[w];
+      uint64_t xh = (((eq & pv[w]) + pv[w]) ^ pv[w]) | eq;
+      uint64_t ph = mv[w] | ~(xh | pv[w]), mh = pv[w] & xh;
+
+      d[w] += (ph >> 63) - (mh >> 63);
+      found |= (unsigned) (d[w] >> 63) << w;
+
+      ph <<= 1;
+      mh <<= 1;
+      pv[w] = mh | ~(xv | ph);
+      mv[w] = ph & xv;
+    }
+  }
+
+  return found;
+#endif
+}
+
+IFTR_IFACE (MygrepSearch,
+    IFTR_FUNCTION (mygrep_count),
+    IFTR_FUNCTION (mygrep_find),
+    IFTR_FUNCTION (mygrep_count_byte),
+    IFTR_FUNCTION (mygrep_count_fold),
+    IFTR_FUNCTION (mygrep_find_fold),
+    IFTR_FUNCTION (mygrep_select_u8),
+    IFTR_FUNCTION (mygrep_select_u16),
+    IFTR_FUNCTION (mygrep_fuzzy)
+);
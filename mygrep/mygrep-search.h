@@ -0,0 +1,81 @@
+/* Search engines of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef MYGREP_SEARCH_H
+#define MYGREP_SEARCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mygrep-fold.h"
+
+/* Patterns of mygrep_fuzzy () at once, a 64 bit word each */
+#define MYGREP_FUZZY_WORDS 4
+
+/* Compiled once per IFTR backend, see mygrep-search.c */
+typedef struct _MygrepSearch
+{
+  /* Counts the matches of @what in the @size bytes of @where the way
+   * run_search () of the tools does: left to right, a match starts after the
+   * end of the previous one. Zero bytes are not special.
+   *
+   * If @resume is not NULL it gets the offset the search goes on from when
+   * more bytes come after these: the end of the last match, or the first of
+   * the last what_len - 1 bytes. Everything before it can be dropped. */
+  size_t (*mygrep_count) (const char *where, size_t size, const char *what,
+      size_t what_len, size_t *resume);
+
+  /* The first match, NULL if none */
+  const char *(*mygrep_find) (const char *where, size_t size,
+      const char *what, size_t what_len);
+
+  /* How many of the bytes are @c, newlines for example */
+  size_t (*mygrep_count_byte) (const char *where, size_t size, char c);
+
+  /* mygrep_count () and mygrep_find () ignoring the case, a match being as
+   * long as the pattern */
+  size_t (*mygrep_count_fold) (const char *where, size_t size,
+      const MygrepFold * fold, size_t *resume);
+  const char *(*mygrep_find_fold) (const char *where, size_t size,
+      const MygrepFold * fold);
+
+  /* Zero @keep[i] unless @lo <= @column[i] <= @hi, or unless it's not if
+   * @outside: a predicate over a column of mygrep-gstlog. @keep is 0 or
+   * 0xff per row. */
+  void (*mygrep_select_u8) (const uint8_t * column, size_t n, uint8_t lo,
+      uint8_t hi, int outside, uint8_t * keep);
+  void (*mygrep_select_u16) (const uint16_t * column, size_t n, uint16_t lo,
+      uint16_t hi, int outside, uint8_t * keep);
+
+  /* Myers' bit-parallel edit distance of MYGREP_FUZZY_WORDS patterns of up
+   * to 64 bytes over the @size bytes of @text. Each pattern is at the top
+   * of its word: bit 63 - m + 1 + j of @peq[c * MYGREP_FUZZY_WORDS + i] is
+   * set if byte j of pattern i is c. @bias[i] is its m - errors - 1, words
+   * that aren't patterns have a zero @peq and a huge bias.
+   *
+   * Returns bit i set if pattern i ends somewhere with at most its errors,
+   * done as soon as the bits of @want are. */
+  unsigned (*mygrep_fuzzy) (const uint64_t * peq, const uint64_t * bias,
+      const char *text, size_t size, unsigned want);
+} MygrepSearch;
+
+/* The instance of the best backend the CPU runs */
+const MygrepSearch *mygrep_search_get (void);
+
+#endif
@@ -0,0 +1,183 @@
+/* Synthetic GStreamer logs for the mygrep benchmarks
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Writes a GST_DEBUG log of the size asked for: the lines look like the
+ * ones of a running pipeline, with the levels, categories and messages
+ * about as frequent as in a real GST_DEBUG=5 log. The same seed gives the
+ * same bytes on every machine, so the variants of the tools built by meson
+ * can be compared over the years without keeping a 200 MB log around:
+ *
+ * $ ./build/mygrep-synth [--size <MiB>] [--seed <n>] <file>
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint64_t rng = 0x9e3779b97f4a7c15ull;
+
+static uint32_t
+mygrep_synth_random (void)
+{
+  rng ^= rng << 13;
+  rng ^= rng >> 7;
+  rng ^= rng << 17;
+  return rng >> 32;
+}
+
+#define PICK(array) (array[mygrep_synth_random () % \
+      (sizeof (array) / sizeof (array[0]))])
+
+/* per mille, DEBUG and LOG are most of it */
+static const struct
+{
+  const char *name;
+  int freq;
+} levels[] = {
+  {"ERROR", 2}, {"WARN", 8}, {"FIXME", 10}, {"INFO", 80}, {"DEBUG", 450},
+  {"LOG", 450}
+};
+
+static const struct
+{
+  const char *category, *file, *function;
+  int line;
+} places[] = {
+  {"GST_PADS", "gstpad.c", "gst_pad_push_data", 4451},
+  {"GST_PADS", "gstpad.c", "gst_pad_chain_data_unchecked", 4254},
+  {"GST_CAPS", "gstpad.c", "gst_pad_query_caps", 3139},
+  {"GST_CAPS", "gstcaps.c", "gst_caps_is_subset", 1719},
+  {"GST_EVENT", "gstpad.c", "gst_pad_send_event_unchecked", 5834},
+  {"GST_SCHEDULING", "gstpad.c", "gst_pad_chain_data_unchecked", 4335},
+  {"basesrc", "gstbasesrc.c", "gst_base_src_loop", 2959},
+  {"basesrc", "gstbasesrc.c", "gst_base_src_get_range", 2544},
+  {"basesink", "gstbasesink.c", "gst_base_sink_chain_unlocked", 3549},
+  {"basesink", "gstbasesink.c", "gst_base_sink_do_sync", 2683},
+  {"basetransform", "gstbasetransform.c", "default_prepare_output_buffer",
+      1457},
+  {"queue", "gstqueue.c", "gst_queue_chain_buffer_or_list", 1218},
+  {"queue_dataflow", "gstqueue.c", "gst_queue_loop", 1562},
+  {"videodecoder", "gstvideodecoder.c", "gst_video_decoder_chain", 2686},
+  {"bufferpool", "gstbufferpool.c", "default_acquire_buffer", 1161},
+  {"GST_BUS", "gstbus.c", "gst_bus_post", 337},
+};
+
+static const char *objects[] = {
+  "src", "sink", "videotestsrc0:src", "queue0:sink", "queue0:src",
+  "capsfilter0", "videoconvert0", "fakesink0", "pipeline0", "bus1"
+};
+
+static const char *messages[] = {
+  "calling chainfunction &gst_base_transform_chain with buffer "
+      "buffer: 0x7f3c2c00a360, pts 0:00:01.533333333, dts 99:99:99.999999999,"
+      " dur 0:00:00.033333333, size 115200, offset 46, offset_end 47, "
+      "flags 0x0",
+  "handled chainfunction &gst_base_transform_chain with buffer "
+      "0x7f3c2c00a360, returned ok",
+  "pushing, have 5 buffers, 576000 bytes in queue",
+  "query caps video/x-raw, format=(string)I420, width=(int)320, "
+      "height=(int)240, framerate=(fraction)30/1",
+  "caps are not compatible, not-negotiated",
+  "got buffer 0x7f3c2c00a360 from pool",
+  "clock time 0:00:01.533333333, base_time 0:00:00.000000000, "
+      "running_time 0:00:01.533333333",
+  "do sync on buffer, jitter -0:00:00.000412332",
+  "[msg 0x7f3c30002b00] posting on bus element message from pipeline0",
+  "stream-start event with stream-id "
+      "8f3e7d6a9c1b2e4f5a6d7c8b9e0f1a2b3c4d5e6f7a8b9c0d1e2f3a4b5c6d7e8f",
+  "received event 0x7f3c2c0022d0 (segment) time segment start=0:00:00",
+  "Internal data stream error.",
+};
+
+static const char *
+mygrep_synth_level (void)
+{
+  int r = mygrep_synth_random () % 1000, i;
+
+  for (i = 0; i < (int) (sizeof (levels) / sizeof (levels[0])); i++) {
+    r -= levels[i].freq;
+    if (r < 0)
+      return levels[i].name;
+  }
+  return "LOG";
+}
+
+int
+main (int argc, char **argv)
+{
+  size_t size = 64 << 20, written = 0;
+  uint64_t ns = 0;
+  int arg, len, p;
+  FILE *f;
+
+  for (arg = 1; arg < argc && argv[arg][0] == '-'; arg++) {
+    if (!strcmp (argv[arg], "--size") && arg + 1 < argc) {
+      size = (size_t) atoi (argv[++arg]) << 20;
+    } else if (!strcmp (argv[arg], "--seed") && arg + 1 < argc) {
+      rng += strtoull (argv[++arg], NULL, 0);
+    } else {
+      break;
+    }
+  }
+
+  if (arg + 1 != argc) {
+    printf ("usage:\nmygrep-synth [--size <MiB>] [--seed <n>] <file>\n");
+    return 1;
+  }
+
+  f = fopen (argv[arg], "w");
+  if (!f) {
+    perror (argv[arg]);
+    return 1;
+  }
+
+  while (written < size) {
+    /* one at a time, the order of the arguments is up to the compiler */
+    unsigned pid, thread;
+    const char *level, *object, *message;
+
+    ns += mygrep_synth_random () % 200000;
+    pid = 4242 + mygrep_synth_random () % 2;
+    thread = mygrep_synth_random () % 8 * 0x1040;
+    level = mygrep_synth_level ();
+    p = mygrep_synth_random () % (sizeof (places) / sizeof (places[0]));
+    object = PICK (objects);
+    message = PICK (messages);
+
+    len = fprintf (f, "%u:%02u:%02u.%09u %5u 0x55d0c%07x %-7s %20s %s:%d:%s:"
+        "<%s> %s\n", (unsigned) (ns / 3600000000000ull),
+        (unsigned) (ns / 60000000000ull % 60),
+        (unsigned) (ns / 1000000000ull % 60),
+        (unsigned) (ns % 1000000000ull), pid, thread, level,
+        places[p].category, places[p].file, places[p].line,
+        places[p].function, object, message);
+    if (len < 0)
+      break;
+    written += len;
+  }
+
+  if (fclose (f) != 0 || written < size) {
+    perror (argv[arg]);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,610 @@
+/* Recursive search of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define _GNU_SOURCE
+#include "mygrep-tree.h"
+#include "mygrep-uring.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MYGREP_TREE_OPEN_FLAGS (O_RDONLY | O_CLOEXEC | O_NOCTTY)
+
+/* what an io_uring completion is of, above the index of the job */
+#define MYGREP_TREE_OPEN (1ull << 32)
+#define MYGREP_TREE_CLOSE (2ull << 32)
+
+typedef struct
+{
+  char *path;
+  int dir;
+} MygrepTreeItem;
+
+/* The owner pushes and pops at the end, the others steal at the start */
+typedef struct
+{
+  pthread_mutex_t lock;
+  MygrepTreeItem *items;
+  size_t first, len, alloc;
+} MygrepTreeDeque;
+
+/* A file being read, in a slot of the buffer. The path is NULL once it's
+ * done. */
+typedef struct
+{
+  MygrepTreeFile file;
+  int fd;
+  /* given to IORING_OP_CLOSE, closed here if the kernel doesn't have it */
+  int closing;
+  off_t offset;
+  char *slot;
+  /* of the previous pieces, in front of the slot */
+  size_t tail;
+  /* per pattern, the bytes of the tail it goes on from */
+  size_t *kept;
+} MygrepTreeJob;
+
+typedef struct _MygrepTreePool MygrepTreePool;
+
+typedef struct
+{
+  MygrepTreePool *pool;
+  int id;
+  MygrepTreeDeque deque;
+
+  MygrepUring *uring;
+  char *buffer;
+  MygrepTreeJob jobs[MYGREP_TREE_BATCH];
+  int n_jobs;
+
+  MygrepTreeFile *files;
+  size_t n_files, alloc_files, n_errors;
+
+  pthread_t thread;
+  int started;
+} MygrepTreeWorker;
+
+struct _MygrepTreePool
+{
+  const MygrepPattern *const *patterns;
+  int n_patterns;
+  MygrepTreeFlags flags;
+  /* in front of every slot: the longest pattern - 1 */
+  size_t room;
+
+  MygrepTreeWorker *workers;
+  int n_workers;
+  /* items pushed and not done yet, nobody is done before it's 0 */
+  size_t pending;
+  /* something couldn't be allocated, the counts miss some files */
+  int failed;
+};
+
+static void
+mygrep_tree_fail (MygrepTreePool * pool)
+{
+  __atomic_store_n (&pool->failed, 1, __ATOMIC_SEQ_CST);
+}
+
+/* Takes @path, it's freed if it can't be pushed */
+static void
+mygrep_tree_push (MygrepTreeWorker * w, char *path, int dir)
+{
+  MygrepTreeDeque *d = &w->deque;
+
+  if (!path) {
+    mygrep_tree_fail (w->pool);
+    return;
+  }
+
+  pthread_mutex_lock (&d->lock);
+  if (d->len == d->alloc && d->first > 0) {
+    memmove (d->items, d->items + d->first,
+        (d->len - d->first) * sizeof (MygrepTreeItem));
+    d->len -= d->first;
+    d->first = 0;
+  }
+  if (d->len == d->alloc) {
+    size_t alloc = d->alloc ? d->alloc * 2 : 64;
+    MygrepTreeItem *items = realloc (d->items,
+        alloc * sizeof (MygrepTreeItem));
+
+    if (!items) {
+      pthread_mutex_unlock (&d->lock);
+      free (path);
+      mygrep_tree_fail (w->pool);
+      return;
+    }
+    d->items = items;
+    d->alloc = alloc;
+  }
+  /* before anybody can take it and be done with it */
+  __atomic_add_fetch (&w->pool->pending, 1, __ATOMIC_SEQ_CST);
+  d->items[d->len].path = path;
+  d->items[d->len].dir = dir;
+  d->len++;
+  pthread_mutex_unlock (&d->lock);
+}
+
+static int
+mygrep_tree_pop (MygrepTreeDeque * d, MygrepTreeItem * item, int steal)
+{
+  int got = 0;
+
+  pthread_mutex_lock (&d->lock);
+  if (d->len > d->first) {
+    *item = steal ? d->items[d->first++] : d->items[--d->len];
+    if (d->first == d->len)
+      d->first = d->len = 0;
+    got = 1;
+  }
+  pthread_mutex_unlock (&d->lock);
+
+  return got;
+}
+
+static int
+mygrep_tree_take (MygrepTreeWorker * w, MygrepTreeItem * item)
+{
+  MygrepTreePool *pool = w->pool;
+  int i;
+
+  if (mygrep_tree_pop (&w->deque, item, 0))
+    return 1;
+  for (i = 1; i < pool->n_workers; i++)
+    if (mygrep_tree_pop (&pool->workers[(w->id + i) % pool->n_workers].deque,
+            item, 1))
+      return 1;
+
+  return 0;
+}
+
+static void
+mygrep_tree_done (MygrepTreeWorker * w)
+{
+  __atomic_sub_fetch (&w->pool->pending, 1, __ATOMIC_SEQ_CST);
+}
+
+static void
+mygrep_tree_list (MygrepTreeWorker * w, const char *path)
+{
+  size_t len = strlen (path);
+  struct dirent *de;
+  DIR *dir;
+
+  dir = opendir (path);
+  if (!dir) {
+    w->n_errors++;
+    return;
+  }
+
+  while ((de = readdir (dir))) {
+    unsigned char type = de->d_type;
+    size_t name_len, sep = len && path[len - 1] != '/';
+    char *child;
+
+    if (!strcmp (de->d_name, ".") || !strcmp (de->d_name, ".."))
+      continue;
+
+    /* some file systems don't say */
+    if (type == DT_UNKNOWN) {
+      struct stat st;
+
+      if (fstatat (dirfd (dir), de->d_name, &st, AT_SYMLINK_NOFOLLOW) < 0)
+        continue;
+      type = S_ISDIR (st.st_mode) ? DT_DIR : S_ISREG (st.st_mode) ?
+          DT_REG : DT_UNKNOWN;
+    }
+    if (type != DT_DIR && type != DT_REG)
+      continue;
+
+    name_len = strlen (de->d_name);
+    child = malloc (len + sep + name_len + 1);
+    if (child) {
+      memcpy (child, path, len);
+      if (sep)
+        child[len] = '/';
+      memcpy (child + len + sep, de->d_name, name_len + 1);
+    }
+
+    mygrep_tree_push (w, child, type == DT_DIR);
+  }
+
+  closedir (dir);
+}
+
+static void
+mygrep_tree_finish (MygrepTreeWorker * w, MygrepTreeJob * job)
+{
+  if (job->fd >= 0)
+    close (job->fd);
+  job->fd = -1;
+
+  if (w->n_files == w->alloc_files) {
+    size_t alloc = w->alloc_files ? w->alloc_files * 2 : 256;
+    MygrepTreeFile *files = realloc (w->files,
+        alloc * sizeof (MygrepTreeFile));
+
+    if (files) {
+      w->files = files;
+      w->alloc_files = alloc;
+    }
+  }
+  if (w->n_files < w->alloc_files) {
+    w->files[w->n_files++] = job->file;
+  } else {
+    free (job->file.path);
+    free (job->file.counts);
+    mygrep_tree_fail (w->pool);
+  }
+  job->file.path = NULL;
+  mygrep_tree_done (w);
+}
+
+/* Counts the @res bytes read to the slot. Returns 1 if there's more to
+ * read, with the end of the file so far moved in front of the slot. */
+static int
+mygrep_tree_piece (MygrepTreeWorker * w, MygrepTreeJob * job, int res)
+{
+  MygrepTreePool *pool = w->pool;
+  size_t resume, filled, room = pool->room;
+  int p;
+
+  if (res < 0) {
+    job->file.error = -res;
+    return 0;
+  }
+
+  for (p = 0; p < pool->n_patterns; p++) {
+    filled = job->kept[p] + res;
+    job->file.counts[p] += mygrep_pattern_count (pool->patterns[p],
+        job->slot - job->kept[p], filled, &resume);
+    job->kept[p] = filled - resume;
+  }
+
+  /* a regular file reads short only at its end */
+  if (res < MYGREP_TREE_PIECE)
+    return 0;
+
+  job->offset += res;
+  job->tail = job->tail + res < room ? job->tail + res : room;
+  memmove (job->slot - job->tail, job->slot + res - job->tail, job->tail);
+
+  return 1;
+}
+
+static void
+mygrep_tree_start (MygrepTreeWorker * w, char *path)
+{
+  MygrepTreePool *pool = w->pool;
+  MygrepTreeJob *job = &w->jobs[w->n_jobs];
+
+  job->file.path = path;
+  job->file.counts = calloc (pool->n_patterns, sizeof (size_t));
+  job->file.error = 0;
+  if (!job->file.counts) {
+    free (path);
+    job->file.path = NULL;
+    mygrep_tree_fail (pool);
+    mygrep_tree_done (w);
+    return;
+  }
+  job->offset = 0;
+  job->tail = 0;
+  memset (job->kept, 0, pool->n_patterns * sizeof (size_t));
+
+  /* io_uring opens the batch at once */
+  job->fd = w->uring ? -1 : open (path, MYGREP_TREE_OPEN_FLAGS);
+  if (!w->uring && job->fd < 0) {
+    job->file.error = errno;
+    mygrep_tree_finish (w, job);
+    return;
+  }
+
+  w->n_jobs++;
+}
+
+/* All the jobs in flight at once: a completion of an open queues the first
+ * read, of a read the next one, or the close */
+static int
+mygrep_tree_batch_uring (MygrepTreeWorker * w)
+{
+  int j, res, inflight = 0;
+  uint64_t tag;
+
+  for (j = 0; j < w->n_jobs; j++, inflight++)
+    mygrep_uring_open (w->uring, AT_FDCWD, w->jobs[j].file.path,
+        MYGREP_TREE_OPEN_FLAGS, MYGREP_TREE_OPEN | j);
+
+  while (inflight) {
+    if (mygrep_uring_submit (w->uring, 1) < 0)
+      return -1;
+
+    while (mygrep_uring_reap (w->uring, &tag, &res)) {
+      MygrepTreeJob *job = &w->jobs[(uint32_t) tag];
+
+      inflight--;
+      if (tag & MYGREP_TREE_CLOSE) {
+        /* no IORING_OP_CLOSE before 5.6 either, or the fds pile up */
+        if (res < 0)
+          close (job->closing);
+        continue;
+      }
+
+      if (tag & MYGREP_TREE_OPEN) {
+        /* no IORING_OP_OPENAT before 5.6 */
+        if (res == -EINVAL)
+          res = open (job->file.path, MYGREP_TREE_OPEN_FLAGS);
+        if (res < 0) {
+          job->file.error = res == -1 ? errno : -res;
+          mygrep_tree_finish (w, job);
+          continue;
+        }
+        job->fd = res;
+        mygrep_uring_read (w->uring, job->fd, job->slot, MYGREP_TREE_PIECE,
+            0, (uint32_t) tag);
+      } else if (mygrep_tree_piece (w, job, res)) {
+        mygrep_uring_read (w->uring, job->fd, job->slot, MYGREP_TREE_PIECE,
+            job->offset, tag);
+      } else {
+        mygrep_uring_close (w->uring, job->fd, MYGREP_TREE_CLOSE | tag);
+        job->closing = job->fd;
+        job->fd = -1;
+        mygrep_tree_finish (w, job);
+      }
+      inflight++;
+    }
+  }
+
+  return 0;
+}
+
+static void
+mygrep_tree_batch (MygrepTreeWorker * w)
+{
+  ssize_t res;
+  int j;
+
+  /* io_uring doesn't break once it's set up, but if it does, the ring goes
+   * with what's in flight and the files not done start over */
+  if (w->uring && mygrep_tree_batch_uring (w) == 0) {
+    w->n_jobs = 0;
+    return;
+  }
+
+  for (j = 0; j < w->n_jobs; j++) {
+    MygrepTreeJob *job = &w->jobs[j];
+
+    if (!job->file.path)
+      continue;
+    if (w->uring) {
+      memset (job->file.counts, 0,
+          w->pool->n_patterns * sizeof (size_t));
+      memset (job->kept, 0, w->pool->n_patterns * sizeof (size_t));
+      job->offset = 0;
+      job->tail = 0;
+    }
+    if (job->fd < 0 &&
+        (job->fd = open (job->file.path, MYGREP_TREE_OPEN_FLAGS)) < 0) {
+      job->file.error = errno;
+      mygrep_tree_finish (w, job);
+      continue;
+    }
+
+    do {
+      do
+        res = pread (job->fd, job->slot, MYGREP_TREE_PIECE, job->offset);
+      while (res < 0 && errno == EINTR);
+      if (res < 0)
+        res = -errno;
+    } while (mygrep_tree_piece (w, job, res));
+    mygrep_tree_finish (w, job);
+  }
+  w->n_jobs = 0;
+
+  if (w->uring) {
+    mygrep_uring_free (w->uring);
+    w->uring = NULL;
+  }
+}
+
+static void *
+mygrep_tree_run (void *data)
+{
+  MygrepTreeWorker *w = data;
+  MygrepTreeItem item;
+
+  for (;;) {
+    if (mygrep_tree_take (w, &item)) {
+      if (item.dir) {
+        mygrep_tree_list (w, item.path);
+        free (item.path);
+        mygrep_tree_done (w);
+      } else {
+        mygrep_tree_start (w, item.path);
+        if (w->n_jobs == MYGREP_TREE_BATCH)
+          mygrep_tree_batch (w);
+      }
+    } else if (w->n_jobs) {
+      mygrep_tree_batch (w);
+    } else if (__atomic_load_n (&w->pool->pending, __ATOMIC_SEQ_CST) == 0) {
+      break;
+    } else {
+      /* the others still list or read, and may push more */
+      sched_yield ();
+    }
+  }
+
+  return NULL;
+}
+
+static int
+mygrep_tree_compare (const void *a, const void *b)
+{
+  return strcmp (((const MygrepTreeFile *) a)->path,
+      ((const MygrepTreeFile *) b)->path);
+}
+
+static void
+mygrep_tree_workers_free (MygrepTreePool * pool)
+{
+  int t, j;
+
+  for (t = 0; t < pool->n_workers; t++) {
+    MygrepTreeWorker *w = &pool->workers[t];
+
+    free (w->files);
+    free (w->deque.items);
+    pthread_mutex_destroy (&w->deque.lock);
+    for (j = 0; j < MYGREP_TREE_BATCH; j++)
+      free (w->jobs[j].kept);
+    if (w->uring)
+      mygrep_uring_free (w->uring);
+    free (w->buffer);
+  }
+  free (pool->workers);
+}
+
+int
+mygrep_tree_count (const char *root, const MygrepPattern * const *patterns,
+    int n_patterns, int threads, MygrepTreeFlags flags,
+    MygrepTreeResult * result)
+{
+  MygrepTreePool pool;
+  struct stat st;
+  size_t len, slot_size, n_files = 0;
+  int t, j;
+
+  memset (result, 0, sizeof (MygrepTreeResult));
+  if (stat (root, &st) < 0)
+    return -1;
+
+  memset (&pool, 0, sizeof (pool));
+  pool.patterns = patterns;
+  pool.n_patterns = n_patterns;
+  pool.flags = flags;
+  for (j = 0; j < n_patterns; j++) {
+    len = mygrep_pattern_length (patterns[j]);
+    if (len > pool.room + 1)
+      pool.room = len - 1;
+  }
+  slot_size = pool.room + MYGREP_TREE_PIECE;
+
+  if (threads < 1)
+    threads = 1;
+  pool.workers = calloc (threads, sizeof (MygrepTreeWorker));
+  if (!pool.workers) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  for (t = 0; t < threads; t++) {
+    MygrepTreeWorker *w = &pool.workers[t];
+
+    w->pool = &pool;
+    w->id = t;
+    pthread_mutex_init (&w->deque.lock, NULL);
+    pool.n_workers++;
+    w->buffer = malloc (MYGREP_TREE_BATCH * slot_size);
+    if (!w->buffer)
+      goto no_memory;
+    for (j = 0; j < MYGREP_TREE_BATCH; j++) {
+      w->jobs[j].slot = w->buffer + j * slot_size + pool.room;
+      w->jobs[j].kept = calloc (n_patterns, sizeof (size_t));
+      if (!w->jobs[j].kept)
+        goto no_memory;
+    }
+    if (!(flags & MYGREP_TREE_PREAD))
+      w->uring = mygrep_uring_new (MYGREP_TREE_BATCH, w->buffer,
+          MYGREP_TREE_BATCH * slot_size);
+  }
+  result->uring = pool.workers[0].uring != NULL;
+
+  mygrep_tree_push (&pool.workers[0], strdup (root), S_ISDIR (st.st_mode));
+
+  /* the first one is us */
+  for (t = 1; t < threads; t++)
+    pool.workers[t].started = !pthread_create (&pool.workers[t].thread, NULL,
+        mygrep_tree_run, &pool.workers[t]);
+  mygrep_tree_run (&pool.workers[0]);
+  for (t = 1; t < threads; t++)
+    if (pool.workers[t].started)
+      pthread_join (pool.workers[t].thread, NULL);
+
+  for (t = 0; t < threads; t++)
+    n_files += pool.workers[t].n_files;
+  result->files = malloc ((n_files ? n_files : 1) * sizeof (MygrepTreeFile));
+  if (!result->files)
+    pool.failed = 1;
+
+  for (t = 0; t < threads; t++) {
+    MygrepTreeWorker *w = &pool.workers[t];
+    size_t f;
+
+    if (!result->files) {
+      for (f = 0; f < w->n_files; f++) {
+        free (w->files[f].path);
+        free (w->files[f].counts);
+      }
+      continue;
+    }
+    memcpy (result->files + result->n_files, w->files,
+        w->n_files * sizeof (MygrepTreeFile));
+    result->n_files += w->n_files;
+    result->n_errors += w->n_errors;
+  }
+  mygrep_tree_workers_free (&pool);
+
+  /* counts of some of the files would look like the ones of all */
+  if (pool.failed) {
+    mygrep_tree_result_clear (result);
+    errno = ENOMEM;
+    return -1;
+  }
+
+  qsort (result->files, result->n_files, sizeof (MygrepTreeFile),
+      mygrep_tree_compare);
+
+  return 0;
+
+no_memory:
+  mygrep_tree_workers_free (&pool);
+  errno = ENOMEM;
+  return -1;
+}
+
+void
+mygrep_tree_result_clear (MygrepTreeResult * result)
+{
+  size_t f;
+
+  for (f = 0; f < result->n_files; f++) {
+    free (result->files[f].path);
+    free (result->files[f].counts);
+  }
+  free (result->files);
+  memset (result, 0, sizeof (MygrepTreeResult));
+}
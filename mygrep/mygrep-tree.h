@@ -0,0 +1,79 @@
+/* Recursive search of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Every regular file under a directory, counted by a pool of threads. The
+ * directories and files are work items: a thread takes the newest of its
+ * own, and when it has none steals the oldest of another one, which is
+ * usually a directory high up and so plenty of work. Symbolic links aren't
+ * followed, like grep -r.
+ *
+ * A thread takes a batch of files and opens, reads and closes them all
+ * through io_uring, a few submissions for the whole batch, reading into its
+ * registered buffer, a slot per file. A big file goes on a piece at a time
+ * with the end of the previous piece in front. Without io_uring the same
+ * slots are filled with open () and pread (). The type of an entry comes
+ * from the directory, so there's no stat () per file either. */
+
+#ifndef MYGREP_TREE_H
+#define MYGREP_TREE_H
+
+#include <stddef.h>
+#include "mygrep-algo.h"
+
+/* files read at once by a thread */
+#define MYGREP_TREE_BATCH 32
+/* read at once from a file */
+#define MYGREP_TREE_PIECE (128 << 10)
+
+typedef enum
+{
+  /* pread () even if there's io_uring */
+  MYGREP_TREE_PREAD = 1 << 0,
+} MygrepTreeFlags;
+
+typedef struct
+{
+  char *path;
+  /* a count per pattern */
+  size_t *counts;
+  /* errno of opening or reading it, 0 */
+  int error;
+} MygrepTreeFile;
+
+typedef struct
+{
+  /* sorted by path */
+  MygrepTreeFile *files;
+  size_t n_files;
+  /* directories that couldn't be listed */
+  size_t n_errors;
+  /* the threads read with io_uring */
+  int uring;
+} MygrepTreeResult;
+
+/* Counts the @patterns in every file under @root, with @threads threads.
+ * Returns -1 and leaves errno if @root itself can't be opened, or if
+ * something couldn't be allocated. */
+int mygrep_tree_count (const char *root,
+    const MygrepPattern * const *patterns, int n_patterns, int threads,
+    MygrepTreeFlags flags, MygrepTreeResult * result);
+void mygrep_tree_result_clear (MygrepTreeResult * result);
+
+#endif
@@ -0,0 +1,248 @@
+/* io_uring reads of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#define _GNU_SOURCE
+#include "mygrep-uring.h"
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+struct _MygrepUring
+{
+  int fd;
+  /* the buffer is registered, reads are READ_FIXED */
+  int fixed;
+  char *buffer;
+
+  void *sq_map, *cq_map;
+  size_t sq_map_size, cq_map_size;
+  struct io_uring_sqe *sqes;
+  size_t sqes_size;
+
+  unsigned *sq_head, *sq_tail, *sq_mask, *sq_array, sq_entries;
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  struct io_uring_cqe *cqes;
+
+  /* queued since the last submission */
+  unsigned queued;
+};
+
+MygrepUring *
+mygrep_uring_new (unsigned entries, char *buffer, size_t size)
+{
+  struct io_uring_params p;
+  struct iovec iov = { buffer, size };
+  MygrepUring *u;
+  char *sq, *cq;
+  int err;
+
+  u = calloc (1, sizeof (MygrepUring));
+  if (!u)
+    return NULL;
+
+  memset (&p, 0, sizeof (p));
+  u->fd = syscall (__NR_io_uring_setup, entries, &p);
+  if (u->fd < 0) {
+    free (u);
+    return NULL;
+  }
+
+  u->sq_map_size = p.sq_off.array + p.sq_entries * sizeof (unsigned);
+  u->cq_map_size = p.cq_off.cqes + p.cq_entries * sizeof (struct io_uring_cqe);
+  /* one mapping for both rings since 5.4 */
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    if (u->cq_map_size > u->sq_map_size)
+      u->sq_map_size = u->cq_map_size;
+    u->cq_map_size = 0;
+  }
+
+  u->sq_map = mmap (NULL, u->sq_map_size, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_SQ_RING);
+  if (u->sq_map == MAP_FAILED)
+    goto fail;
+  if (u->cq_map_size) {
+    u->cq_map = mmap (NULL, u->cq_map_size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_CQ_RING);
+    if (u->cq_map == MAP_FAILED)
+      goto fail;
+  } else {
+    u->cq_map = u->sq_map;
+  }
+
+  u->sqes_size = p.sq_entries * sizeof (struct io_uring_sqe);
+  u->sqes = mmap (NULL, u->sqes_size, PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_SQES);
+  if (u->sqes == MAP_FAILED)
+    goto fail;
+
+  sq = u->sq_map;
+  u->sq_head = (unsigned *) (sq + p.sq_off.head);
+  u->sq_tail = (unsigned *) (sq + p.sq_off.tail);
+  u->sq_mask = (unsigned *) (sq + p.sq_off.ring_mask);
+  u->sq_array = (unsigned *) (sq + p.sq_off.array);
+  u->sq_entries = p.sq_entries;
+
+  cq = u->cq_map;
+  u->cq_head = (unsigned *) (cq + p.cq_off.head);
+  u->cq_tail = (unsigned *) (cq + p.cq_off.tail);
+  u->cq_mask = (unsigned *) (cq + p.cq_off.ring_mask);
+  u->cqes = (struct io_uring_cqe *) (cq + p.cq_off.cqes);
+
+  /* locked memory can be scarce, plain reads do too */
+  u->buffer = buffer;
+  u->fixed = syscall (__NR_io_uring_register, u->fd,
+      IORING_REGISTER_BUFFERS, &iov, 1) == 0;
+
+  return u;
+
+fail:
+  err = errno;
+  mygrep_uring_free (u);
+  errno = err;
+  return NULL;
+}
+
+void
+mygrep_uring_free (MygrepUring * u)
+{
+  if (u->sqes && u->sqes != MAP_FAILED)
+    munmap (u->sqes, u->sqes_size);
+  if (u->cq_map_size && u->cq_map && u->cq_map != MAP_FAILED)
+    munmap (u->cq_map, u->cq_map_size);
+  if (u->sq_map && u->sq_map != MAP_FAILED)
+    munmap (u->sq_map, u->sq_map_size);
+  close (u->fd);
+  free (u);
+}
+
+/* The next entry of the queue, cleared, NULL if it's full */
+static struct io_uring_sqe *
+mygrep_uring_sqe (MygrepUring * u, uint64_t tag)
+{
+  unsigned tail = *u->sq_tail, index;
+  struct io_uring_sqe *sqe;
+
+  if (tail - __atomic_load_n (u->sq_head, __ATOMIC_ACQUIRE) >= u->sq_entries)
+    return NULL;
+
+  index = tail & *u->sq_mask;
+  sqe = &u->sqes[index];
+  memset (sqe, 0, sizeof (*sqe));
+  sqe->user_data = tag;
+
+  u->sq_array[index] = index;
+  return sqe;
+}
+
+/* The kernel sees it from here on */
+static void
+mygrep_uring_queue (MygrepUring * u)
+{
+  __atomic_store_n (u->sq_tail, *u->sq_tail + 1, __ATOMIC_RELEASE);
+  u->queued++;
+}
+
+int
+mygrep_uring_open (MygrepUring * u, int dirfd, const char *path, int flags,
+    uint64_t tag)
+{
+  struct io_uring_sqe *sqe = mygrep_uring_sqe (u, tag);
+
+  if (!sqe)
+    return -1;
+  sqe->opcode = IORING_OP_OPENAT;
+  sqe->fd = dirfd;
+  sqe->addr = (uintptr_t) path;
+  sqe->open_flags = flags;
+  mygrep_uring_queue (u);
+
+  return 0;
+}
+
+int
+mygrep_uring_read (MygrepUring * u, int fd, char *dst, size_t len,
+    off_t offset, uint64_t tag)
+{
+  struct io_uring_sqe *sqe = mygrep_uring_sqe (u, tag);
+
+  if (!sqe)
+    return -1;
+  sqe->opcode = u->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+  sqe->fd = fd;
+  sqe->addr = (uintptr_t) dst;
+  sqe->len = len;
+  sqe->off = offset;
+  sqe->buf_index = 0;
+  mygrep_uring_queue (u);
+
+  return 0;
+}
+
+int
+mygrep_uring_close (MygrepUring * u, int fd, uint64_t tag)
+{
+  struct io_uring_sqe *sqe = mygrep_uring_sqe (u, tag);
+
+  if (!sqe)
+    return -1;
+  sqe->opcode = IORING_OP_CLOSE;
+  sqe->fd = fd;
+  mygrep_uring_queue (u);
+
+  return 0;
+}
+
+int
+mygrep_uring_submit (MygrepUring * u, unsigned wait)
+{
+  int ret;
+
+  do
+    ret = syscall (__NR_io_uring_enter, u->fd, u->queued, wait,
+        wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+  while (ret < 0 && errno == EINTR);
+  if (ret < 0)
+    return -1;
+
+  u->queued -= ret;
+  return 0;
+}
+
+int
+mygrep_uring_reap (MygrepUring * u, uint64_t * tag, int *res)
+{
+  unsigned head = *u->cq_head;
+  struct io_uring_cqe *cqe;
+
+  if (head == __atomic_load_n (u->cq_tail, __ATOMIC_ACQUIRE))
+    return 0;
+
+  cqe = &u->cqes[head & *u->cq_mask];
+  *tag = cqe->user_data;
+  *res = cqe->res;
+  __atomic_store_n (u->cq_head, head + 1, __ATOMIC_RELEASE);
+
+  return 1;
+}
@@ -0,0 +1,58 @@
+/* io_uring reads of the mygrep tools
+ *
+ * Copyright (C) 2025 Alexander Slobodeniuk <aleksandr.slobodeniuk@gmx.es>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Just enough of io_uring to open, read and close many files with one
+ * system call: these go into a queue, one submission sends them all and
+ * waits for some. The
+ * ring is set up with the raw system calls, there's no liburing needed.
+ * The buffer given at creation is registered with the kernel when it
+ * allows it, so it doesn't map the pages again for every read. */
+
+#ifndef MYGREP_URING_H
+#define MYGREP_URING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+typedef struct _MygrepUring MygrepUring;
+
+/* Reads land in the @size bytes of @buffer. Returns NULL and leaves errno
+ * if the kernel has no io_uring, or doesn't let us use it. */
+MygrepUring *mygrep_uring_new (unsigned entries, char *buffer, size_t size);
+void mygrep_uring_free (MygrepUring * uring);
+
+/* Queue an openat (), a read of @len bytes at @offset of @fd to @dst
+ * inside the buffer, or a close (). Return -1 if the queue is full. */
+int mygrep_uring_open (MygrepUring * uring, int dirfd, const char *path,
+    int flags, uint64_t tag);
+int mygrep_uring_read (MygrepUring * uring, int fd, char *dst, size_t len,
+    off_t offset, uint64_t tag);
+int mygrep_uring_close (MygrepUring * uring, int fd, uint64_t tag);
+
+/* Submits the queued reads and waits for @wait of them. Returns -1 and
+ * leaves errno on failure. */
+int mygrep_uring_submit (MygrepUring * uring, unsigned wait);
+
+/* A finished one, 0 if none is left: its @tag and what the system call
+ * would have returned, -errno on failure */
+int mygrep_uring_reap (MygrepUring * uring, uint64_t * tag, int *res);
+
+#endif
@@ -0,0 +1,17 @@
+#!/bin/sh
+# Trains a -pgo-gen build of the tools for its -pgo twin, from meson:
+#
+#   pgo-train.sh <profile> <tool> <args...>
+#
+# <profile> is where the -dumpdir and -dumpbase of both builds put it, the
+# tool writes it on exit. The counts add up run after run, the old one goes
+# first.
+
+set -e
+
+PROFILE=$1
+shift
+
+rm -f "$PROFILE"
+"$@" > /dev/null
+test -f "$PROFILE"
@@ -33,43 +33,126 @@
    $ ./mygrep_with_pure log.txt gst
      Time to search elapsed: 37842701 us
      matches found: 805307
- */
 
+   7. Or build everything with meson in the top directory, and compare to
+   the vector search of mygrep/
 
-#include <stdio.h>
-#include <stdlib.h>
-#include "pure.h"
+   $ ./build/mygrep-pure --simd log.txt gst
 
-static char *
-read_whole_file (const char *fname)
-{
-  FILE *f;
-  long fsize;
-  char *string;
+   --mmap maps the file instead of reading it, --stream goes through it a
+   chunk at a time (with the vector search), "-" is stdin.
 
-  f = fopen (fname, "rb");
-  if (!f) {
-    printf ("File %s not found\n", fname);
-  }
+   --threads splits the vector search over threads, --scaling shows how it
+   scales up to that many (or all the cores).
 
-  fseek (f, 0, SEEK_END);
-  fsize = ftell (f);
-  fseek (f, 0, SEEK_SET);
+   More strings are searched one after another, or all in one pass with
+   --multi, and counted each on its own.
 
-  string = malloc (fsize + 1);
-  fread (string, 1, fsize, f);
-  fclose (f);
+   --algo picks the search algorithm (--simd is --algo simd), "auto" goes
+   by the string: memchr for a byte, Two-Way for the repetitive strings,
+   Horspool for long ones of a few distinct bytes, the vector search for
+   the rest. mygrep-bench compares them all.
 
-  string[fsize] = 0;
+   8. The time of every run is kept, after --warmup runs (1), and the median
+   of --runs (100) is printed with its 95% confidence interval: the
+   intervals of the pure and the non-pure builds have to not overlap for a
+   difference to mean anything. --cpu pins the process, --json appends the
+   stats and the samples to a file, with the cycles and the branch misses
+   where perf allows.
 
-  return string;
-}
+   $ ./build/mygrep-pure --cpu 2 --json runs.json log.txt gst
+   $ ./build/mygrep-no-pure --cpu 2 --json runs.json log.txt gst
 
-static void
-usage (void)
-{
-  printf ("usage:\nmygrep <filename> <string to search>\n");
-}
+   9. --lines prints the lines with a match of any of the strings instead
+   of counting, once, like grep. --line-number and --byte-offset put the
+   line number and the offset of the line in front.
+
+   10. --regex takes the strings for extended regular expressions and
+   counts the lines they match, like grep -E -c. The DFA is built as the
+   text asks for it, in at most --regex-cache bytes (1 MiB), and the longest
+   literal of the expression is searched for first. Against the plain
+   search of a literal:
+
+   $ ./build/mygrep-pure log.txt gst
+   $ ./build/mygrep-pure --regex log.txt gst
+   $ ./build/mygrep-pure --regex --lines log.txt '0:00:0[0-9].*ERROR.*pad'
+
+   11. --ignore-case finds gst, Gst and GST alike, and é and É, with the
+   vector filter still in front (mygrep-bench has it as "simd -i"). With
+   --regex it's the case of the ASCII letters. run_search () and
+   char_match () stay case sensitive, it's them the pure experiment is
+   about, and so does --multi.
+
+   $ ./build/mygrep-pure --simd log.txt gst
+   $ ./build/mygrep-pure --ignore-case log.txt gst
+
+   12. --index builds log.txt.mgi the first time, with the 64 KiB blocks
+   each trigram is in, and afterwards searches only the blocks that have
+   all the trigrams of the string. The size and mtime of the file, and the
+   checksums of the blocks, tell a stale index:
+
+   $ ./build/mygrep-pure --index log.txt not-negotiated
+   $ ./build/mygrep-pure --index --runs 10 log.txt 0:00:05.1
+
+   13. A gzip or zstd file, or pipe, is searched as it's decompressed: a
+   thread fills a ring of buffers ahead of the search, a match can go over
+   two of them. zlib and libzstd are needed at build time.
+
+   $ ./build/mygrep-pure log.txt.gz gst
+   $ ./build/mygrep-pure log.txt.zst gst
+
+   14. --recursive searches every file under a directory, with --threads
+   (or all the cores) stealing work from each other. The files are opened,
+   read and closed 32 at a time with io_uring where the kernel has it,
+   --pread does it a system call at a time:
+
+   $ ./build/mygrep-pure --recursive logs/ gst
+   $ ./build/mygrep-pure --recursive --pread logs/ gst
+
+   15. --gst splits a GST_DEBUG log into a column per field, and the
+   strings are queries over them, predicates joined by "and". The level and
+   category are filtered with SIMD over a byte or two per line, the message
+   is only searched in the lines left:
+
+   $ ./build/mygrep-pure --gst log.txt 'level<=WARN and category=basesrc and message contains caps'
+   $ ./build/mygrep-pure --gst log.txt 'pid=1234 and function=gst_pad_push'
+
+   16. --follow keeps searching what's appended to the file, waiting for it
+   with inotify and printing what every write brought, until ^C or until the
+   file is removed. A match split over two writes is still one:
+
+   $ ./build/mygrep-pure --follow log.txt not-negotiated
+
+   17. --fuzzy <k> counts the lines that have the strings with up to k
+   errors, a byte inserted, deleted or changed each. It's bit-parallel, a
+   64 bit word per string and 4 strings in the lanes of a vector, over the
+   lines that have one of the k + 1 pieces of a string as it is:
+
+   $ ./build/mygrep-pure --fuzzy 1 log.txt not-negociated
+
+   18. meson builds 1 to 4 too, and pure and no-pure with LTO, where the
+   compiler sees the helpers anyway, and no-pure with PGO. bench-variants
+   generates a log with mygrep-synth instead of 5, runs every variant over
+   it instead of 6, and prints the speedups over no-pure with the p of a
+   Mann-Whitney U test, so it can be run again after a compiler upgrade:
+
+   $ meson setup build && ninja -C build bench-variants
+ */
+
+
+#include "pure.h"
+#include "mygrep-main.h"
+
+#ifdef WITH_PURE
+#define MYGREP_VARIANT "pure"
+#else
+#define MYGREP_VARIANT "no-pure"
+#endif
+
+/* how meson built it besides, -lto or -pgo */
+#ifndef MYGREP_BUILD
+#define MYGREP_BUILD ""
+#endif
 
 static int
 run_search (const char *where, const char *what)
@@ -85,8 +168,8 @@ run_search (const char *where, const char *what)
        * - match is found. */
       if (end_of_string (what[what_i])) {
         ans++;
-        /* no need to scan this part again */
-        where_i = wi;
+        /* no need to scan this part again, the loop steps to wi */
+        where_i = wi - 1;
         break;
       }
 
@@ -108,46 +191,9 @@ run_search (const char *where, const char *what)
 int
 main (int argc, char **argv)
 {
-  char *file;
-  gint64 measurement_start, measurement = 0;
-  int ans = -1, nr, num_runs = 100;
-
-  if (argc < 2) {
-    printf ("need file name\n");
-    goto bad_arguments;
-  }
-
-  if (argc < 3) {
-    printf ("need search string\n");
-    goto bad_arguments;
-  }
-
-  if (!(file = read_whole_file (argv[1])))
-    return 1;
-
-  for (nr = 0; nr < num_runs; nr++) {
-    int prev_ans = -1;
-    if (ans != -1)
-      prev_ans = ans;
-
-    measurement_start = g_get_monotonic_time ();
-    ans = run_search (file, argv[2]);
-    measurement += g_get_monotonic_time () - measurement_start;
-
-    if (prev_ans != -1 && ans != prev_ans) {
-      printf ("Sanity check failed\n");
-      g_abort ();
-    }
-  }
-
-  printf ("Time to search elapsed: %" G_GINT64_FORMAT " us\n", measurement);
-
-  printf ("matches found: %d\n", ans);
-
-  free (file);
-  return 0;
+  static const MygrepTool tool = {
+    "pure", MYGREP_VARIANT MYGREP_BUILD, run_search
+  };
 
-bad_arguments:
-  usage ();
-  return 1;
+  return mygrep_main (argc, argv, &tool);
 }
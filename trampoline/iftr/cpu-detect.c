@@ -19,33 +19,78 @@
  */
 
 #include "iface-trampoline.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
-/* FIXME!!!! */
-#define HAVE_AMD64 1
-/* --------------- */
-
+/* The backends are the x86-64 microarchitecture levels of the psABI, which
+ * every compiler knows as -march=x86-64-v2 and so on:
+ *
+ *   SSE     x86-64-v2: SSE3, SSSE3, SSE4.1, SSE4.2, POPCNT, CMPXCHG16B, LAHF
+ *   AVX     x86-64-v3: v2 + AVX, AVX2, BMI1, BMI2, F16C, FMA, LZCNT, MOVBE
+ *   AVX512  x86-64-v4: v3 + AVX-512 F, BW, CD, DQ and VL
+ *
+ * The bits of CPUID leaves 1 and 7 mean the same whoever made the CPU. The
+ * vector registers count only if the OS saves them too, which XGETBV says. */
+
+/* leaf 1, ecx */
+#define IFTR_CPUID_SSE3       (1u << 0)
+#define IFTR_CPUID_SSSE3      (1u << 9)
+#define IFTR_CPUID_FMA        (1u << 12)
+#define IFTR_CPUID_CX16       (1u << 13)
+#define IFTR_CPUID_SSE41      (1u << 19)
+#define IFTR_CPUID_SSE42      (1u << 20)
+#define IFTR_CPUID_MOVBE      (1u << 22)
+#define IFTR_CPUID_POPCNT     (1u << 23)
+#define IFTR_CPUID_OSXSAVE    (1u << 27)
+#define IFTR_CPUID_AVX        (1u << 28)
+#define IFTR_CPUID_F16C       (1u << 29)
+
+/* leaf 7, ebx */
+#define IFTR_CPUID_BMI1       (1u << 3)
+#define IFTR_CPUID_AVX2       (1u << 5)
+#define IFTR_CPUID_BMI2       (1u << 8)
+#define IFTR_CPUID_AVX512F    (1u << 16)
+#define IFTR_CPUID_AVX512DQ   (1u << 17)
+#define IFTR_CPUID_AVX512CD   (1u << 28)
+#define IFTR_CPUID_AVX512BW   (1u << 30)
+#define IFTR_CPUID_AVX512VL   (1u << 31)
+
+/* leaf 0x80000001, ecx */
+#define IFTR_CPUID_LAHF       (1u << 0)
+#define IFTR_CPUID_LZCNT      (1u << 5)
+
+/* XCR0: SSE and AVX state, and the opmask and upper ZMM of AVX-512 */
+#define IFTR_XCR0_AVX         0x06u
+#define IFTR_XCR0_AVX512      0xe6u
+
+#define IFTR_ALL(bits, want) (((bits) & (want)) == (want))
+
+/* @op is the leaf, the subleaf is 0 */
 static int
 iftr_get_cpuid (unsigned op, unsigned *a, unsigned *b, unsigned *c, unsigned *d)
 {
-#if defined(_MSC_VER)
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
   {
     int tmp[4];
-    __cpuid (tmp, op);
+    __cpuidex (tmp, op, 0);
     *a = tmp[0];
     *b = tmp[1];
     *c = tmp[2];
     *d = tmp[3];
     return 0;
   }
-#elif defined(__GNUC__) || defined (__SUNPRO_C)
+#elif (defined(__GNUC__) || defined (__SUNPRO_C)) && \
+    (defined(__x86_64__) || defined(__i386__))
   {
     *a = op;
     *c = 0;
-#if defined(HAVE_I386)
+#if defined(__i386__)
+    /* ebx is the PIC register */
   __asm__ ("  pushl %%ebx\n" "  cpuid\n" "  mov %%ebx, %%esi\n" "  popl %%ebx\n":"+a" (*a), "=S" (*b), "+c" (*c),
         "=d"
         (*d));
-#elif defined(HAVE_AMD64)
+#else
   __asm__ ("  cpuid\n":"+a" (*a), "=b" (*b), "+c" (*c), "=d" (*d));
 #endif
 
@@ -56,118 +101,80 @@ iftr_get_cpuid (unsigned op, unsigned *a, unsigned *b, unsigned *c, unsigned *d)
 #endif
 }
 
-static int
-iftr_intel_has_sse (unsigned ecx, unsigned edx)
+/* What the OS saves on a context switch, only if OSXSAVE */
+static unsigned
+iftr_get_xcr0 (void)
 {
-  /* SSE2 */
-  if (edx & (1 << 26))
-    return 1;
-
-  /* SSE3 */
-  if ((ecx & (1 << 0)) || (ecx & (1 << 9)))
-    return 1;
-
-  /* SSE4 */
-  if ((ecx & (1 << 19)) || (ecx & (1 << 20)))
-    return 1;
-
-  /* No SSE supported? */
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  return (unsigned) _xgetbv (0);
+#elif (defined(__GNUC__) || defined (__SUNPRO_C)) && \
+    (defined(__x86_64__) || defined(__i386__))
+  unsigned lo, hi;
+
+  /* xgetbv, spelled out for the assemblers that don't know it */
+  __asm__ (".byte 0x0f, 0x01, 0xd0":"=a" (lo), "=d" (hi):"c" (0));
+  return lo;
+#else
   return 0;
+#endif
 }
 
 static int
-iftr_intel_has_avx (void)
+iftr_has_v2 (unsigned ecx1, unsigned ecx81)
 {
-  /* Pending investigation */
-  return 0;
+  return IFTR_ALL (ecx1, IFTR_CPUID_SSE3 | IFTR_CPUID_SSSE3 |
+      IFTR_CPUID_SSE41 | IFTR_CPUID_SSE42 | IFTR_CPUID_POPCNT |
+      IFTR_CPUID_CX16) && (ecx81 & IFTR_CPUID_LAHF);
 }
 
-static IFTR_backend
-iftr_intel_select (unsigned level)
+static int
+iftr_has_v3 (unsigned ecx1, unsigned ebx7, unsigned ecx81, unsigned xcr0)
 {
-  unsigned eax, ebx, ecx, edx;
-
-  if (level == 0)
-    return DEFAULT;
-
-  iftr_get_cpuid (1, &eax, &ebx, &ecx, &edx);
-
-  if (iftr_intel_has_avx ()) {
-    return AVX;
-  }
-
-  if (iftr_intel_has_sse (ecx, edx)) {
-    return SSE;
-  }
-
-  return DEFAULT;
+  return IFTR_ALL (ecx1, IFTR_CPUID_AVX | IFTR_CPUID_FMA | IFTR_CPUID_F16C |
+      IFTR_CPUID_MOVBE) &&
+      IFTR_ALL (ebx7, IFTR_CPUID_AVX2 | IFTR_CPUID_BMI1 | IFTR_CPUID_BMI2) &&
+      (ecx81 & IFTR_CPUID_LZCNT) && IFTR_ALL (xcr0, IFTR_XCR0_AVX);
 }
 
-
-static IFTR_backend
-iftr_amd_select (unsigned level)
+static int
+iftr_has_v4 (unsigned ebx7, unsigned xcr0)
 {
-  IFTR_backend std;
-  unsigned ebx, ecx, edx;
-
-  std = iftr_intel_select (level);
-  if (DEFAULT != std)
-    return std;
-
-  iftr_get_cpuid (0x80000000, &level, &ebx, &ecx, &edx);
-
-  if (level == 0)
-    return DEFAULT;
-
-  /* SSE4 */
-  if (ecx & (1 << 6)) {
-    return SSE;
-  }
-  /* SSE5 */
-  if (ecx & (1 << 11)) {
-    return SSE;
-  }
-
-  return DEFAULT;
+  return IFTR_ALL (ebx7, IFTR_CPUID_AVX512F | IFTR_CPUID_AVX512BW |
+      IFTR_CPUID_AVX512CD | IFTR_CPUID_AVX512DQ | IFTR_CPUID_AVX512VL) &&
+      IFTR_ALL (xcr0, IFTR_XCR0_AVX512);
 }
 
-
 IFTR_backend
 iftr_select_backend (void)
 {
-  unsigned ebx, edx;
-  unsigned level;
-  unsigned vendor;
-  int i;
+  unsigned eax, ebx, ecx, edx;
+  unsigned level, ext_level, ecx1, ebx7 = 0, ecx81 = 0, xcr0 = 0;
   static IFTR_backend ret;
 
   if (ret)
     return ret;
 
-  if (-1 == iftr_get_cpuid (0, &level, &ebx, &vendor, &edx) || level == 0) {
+  if (-1 == iftr_get_cpuid (0, &level, &ebx, &ecx, &edx) || level == 0) {
     return (ret = DEFAULT);
   }
 
-  struct
-  {
-    union
-    {
-      char c[4];
-      unsigned u;
-    } u;
-
-      IFTR_backend (*select) (unsigned);
-  } known_vendors[] = {
-    {{{'n', 't', 'e', 'l'}}, iftr_intel_select},
-    {{{'c', 'A', 'M', 'D'}}, iftr_amd_select},
-    {{{'u', 'i', 'n', 'e'}}, iftr_intel_select}
-  };
-
-  for (i = 0; i < (sizeof (known_vendors) / sizeof (int)); i++) {
-    if (known_vendors[i].u.u == vendor) {
-      return (ret = known_vendors[i].select (level));
-    }
-  }
+  iftr_get_cpuid (1, &eax, &ebx, &ecx1, &edx);
+  if (level >= 7)
+    iftr_get_cpuid (7, &eax, &ebx7, &ecx, &edx);
+
+  iftr_get_cpuid (0x80000000, &ext_level, &ebx, &ecx, &edx);
+  if (ext_level >= 0x80000001)
+    iftr_get_cpuid (0x80000001, &eax, &ebx, &ecx81, &edx);
+
+  if (ecx1 & IFTR_CPUID_OSXSAVE)
+    xcr0 = iftr_get_xcr0 ();
+
+  if (!iftr_has_v2 (ecx1, ecx81))
+    return (ret = DEFAULT);
+  if (!iftr_has_v3 (ecx1, ebx7, ecx81, xcr0))
+    return (ret = SSE);
+  if (!iftr_has_v4 (ebx7, xcr0))
+    return (ret = AVX);
 
-  return (ret = DEFAULT);
+  return (ret = AVX512);
 }
@@ -22,8 +22,10 @@ typedef enum
 {
   DEBUG,
   DEFAULT,
+  /* x86-64-v2, v3 and v4, see cpu-detect.c */
   SSE,
-  AVX
+  AVX,
+  AVX512
 } IFTR_backend;
 
 typedef struct
@@ -47,12 +49,14 @@ typedef struct
   IFTR_IFACE_DECLARE (type, DEFAULT);                             \
   IFTR_IFACE_DECLARE (type, SSE);                                 \
   IFTR_IFACE_DECLARE (type, AVX);                                 \
+  IFTR_IFACE_DECLARE (type, AVX512);                              \
                                                                   \
   static ItrmpIfaceMap IFTR_IFACES_ARRAY (type)[] = {             \
     IFTR_MAP_MEMBER (type, DEBUG),                                \
     IFTR_MAP_MEMBER (type, DEFAULT),                              \
     IFTR_MAP_MEMBER (type, SSE),                                  \
     IFTR_MAP_MEMBER (type, AVX),                                  \
+    IFTR_MAP_MEMBER (type, AVX512),                               \
     {0, 0}                                                        \
   };                                                              \
                                                                   \
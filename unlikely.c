@@ -40,7 +40,7 @@
  * --------------------------
  * $ ./a.out big_log.txt caps
  * ....
- *   Total time elapsed: 44782600 us
+ *   Time to search elapsed: 44782600 us
  *
  * --------------------------
  * 4. compile without likelies
@@ -53,28 +53,164 @@
  * --------------------------
  * $ ./a.out big_log.txt caps
  * ....
- *   Total time elapsed: 50572310 us
+ *   Time to search elapsed: 50572310 us
  *
  * --------------------------
  * 6. estimate the speedup: 50572310 / 44782600 = 1,129
  *
  * P.S. example was compiled with gcc 9.4.0
+ *
+ * --------------------------
+ * 7. against the vector search of mygrep/
+ * --------------------------
+ * $ meson setup build && ninja -C build
+ * $ ./build/mygrep-likely --simd big_log.txt caps
+ *
+ * --mmap maps the file instead of reading it into the heap, --stream goes
+ * through it a chunk at a time (with the vector search), "-" is stdin:
+ * $ zcat big_log.txt.gz | ./build/mygrep-likely - caps
+ *
+ * --threads splits the vector search over threads, --scaling shows how it
+ * scales up to that many (or all the cores):
+ * $ ./build/mygrep-likely --mmap --scaling big_log.txt caps
+ *
+ * More strings are searched one after another, or all in one pass with
+ * --multi, and counted each on its own:
+ * $ ./build/mygrep-likely --multi big_log.txt caps error not-negotiated
+ *
+ * --algo picks the search algorithm (--simd is --algo simd), "auto" goes by
+ * the string: memchr for a byte, Two-Way for the repetitive strings,
+ * Horspool for long ones of a few distinct bytes, the vector search for the
+ * rest. mygrep-bench compares them all. The tool says what it took for
+ * each string:
+ * $ ./build/mygrep-likely --algo auto big_log.txt c caps "a long string..."
+ *
+ * --------------------------
+ * 8. compare with some confidence
+ * --------------------------
+ * One total says nothing of how much the runs vary. Every run is timed on
+ * its own after --warmup runs (1), and the median of --runs (100) comes with
+ * its 95% confidence interval, which have to not overlap for a speedup to
+ * count. --cpu pins the process, --json appends the samples and the stats
+ * to a file, along with the cycles and the branch misses where perf allows:
+ * $ for t in likely no-likely; do
+ *     ./build/mygrep-$t --cpu 2 --json runs.json big_log.txt caps; done
+ *
+ * --------------------------
+ * 9. the lines themselves
+ * --------------------------
+ * --lines prints the lines with a match of any of the strings instead of
+ * counting, once, like grep. --line-number and --byte-offset put the line
+ * number and the offset of the line in front:
+ * $ ./build/mygrep-likely --line-number big_log.txt not-negotiated
+ *
+ * --------------------------
+ * 10. regular expressions
+ * --------------------------
+ * --regex takes the strings for extended regular expressions and counts
+ * the lines they match, grep -E -c. The DFA is built as the text asks for
+ * it, in at most --regex-cache bytes (1 MiB), and the longest literal of
+ * the expression goes through the substring search first. Against the
+ * plain search of a literal:
+ * $ ./build/mygrep-likely big_log.txt caps
+ * $ ./build/mygrep-likely --regex big_log.txt caps
+ * $ ./build/mygrep-likely --regex --lines big_log.txt '0:00:0[0-9].*ERROR.*pad'
+ *
+ * --------------------------
+ * 11. without the case
+ * --------------------------
+ * --ignore-case finds caps, Caps and CAPS alike, and é and É, with the
+ * vector filter still in front (mygrep-bench has it as "simd -i"). With
+ * --regex it's the case of the ASCII letters. run_search () stays the
+ * case sensitive one, --multi too:
+ * $ ./build/mygrep-likely --simd big_log.txt caps
+ * $ ./build/mygrep-likely --ignore-case big_log.txt caps
+ *
+ * 12. the index
+ * --------------------------
+ * --index builds big_log.txt.mgi the first time, a bitmap of the 64 KiB
+ * blocks per trigram, and afterwards searches only the blocks that have
+ * all the trigrams of the string. A string of less than 3 bytes takes them
+ * all. The size and mtime of the file say when to build it again, and the
+ * checksum of each block searched that it didn't change in between:
+ * $ ./build/mygrep-likely --index big_log.txt not-negotiated
+ * $ ./build/mygrep-likely --index --runs 10 big_log.txt 0:00:05.1
+ *
+ * 13. compressed logs
+ * --------------------------
+ * A gzip or zstd file, or pipe, is searched as it's decompressed: a thread
+ * fills a ring of buffers ahead of the search, so the time is close to the
+ * longer of the two rather than both. It takes zlib and libzstd at build
+ * time:
+ * $ ./build/mygrep-likely big_log.txt.gz caps
+ * $ ./build/mygrep-likely big_log.txt.zst caps
+ *
+ * 14. directories
+ * --------------------------
+ * --recursive searches every file under a directory, with --threads (or
+ * all the cores) taking directories and files from each other. A thread
+ * opens, reads and closes 32 files at a time with one io_uring system call
+ * where it can, --pread goes back to a call per file for comparison. The
+ * files with matches are printed with their count:
+ * $ ./build/mygrep-likely --recursive /var/log/gst caps
+ * $ ./build/mygrep-likely --recursive --pread /var/log/gst caps
+ *
+ * 15. GStreamer queries
+ * --------------------------
+ * --gst reads a GST_DEBUG log into a column per field once, and the strings
+ * are queries over them: ts, pid, thread, level, category, file, line,
+ * function and object compared with = != < <= > >=, and "message contains",
+ * joined by "and". The level and category go through the vector predicates
+ * of the engines, and only the lines left have their message searched:
+ * $ ./build/mygrep-likely --gst big_log.txt 'level<=WARN and category=basesrc and message contains caps'
+ * $ ./build/mygrep-likely --gst big_log.txt 'ts>=0:00:05 and level=ERROR'
+ *
+ * 16. following a log
+ * --------------------------
+ * --follow searches the file, and then only what's written to it, printing
+ * the new matches of every append as it comes, like tail -f. It sleeps in
+ * inotify in between, a match written in two goes counts once, and it ends
+ * with the totals on ^C or when the file is removed or renamed:
+ * $ GST_DEBUG=4 GST_DEBUG_FILE=big_log.txt gst-launch-1.0 ... &
+ * $ ./build/mygrep-likely --follow big_log.txt not-negotiated
+ *
+ * 17. typos
+ * --------------------------
+ * --fuzzy <k> counts the lines with the strings in them give or take k
+ * bytes inserted, deleted or changed, 64 bytes a string at most. Myers'
+ * algorithm goes a byte at a time over 4 strings at once in the vector
+ * lanes, and only over the lines where one of the k + 1 pieces of a string
+ * is as it is, which any line with k errors has:
+ * $ ./build/mygrep-likely --fuzzy 1 big_log.txt not-negociated
+ * $ ./build/mygrep-likely --fuzzy 2 --ignore-case big_log.txt "Internal data stream eror"
+ *
+ * 18. every variant
+ * --------------------------
+ * meson builds steps 2 and 4 and the rest of the experiments: likely and
+ * no-likely, each with LTO, and no-likely with PGO, trained at build time
+ * over a synthetic log by a -pgo-gen build. bench-variants runs them all
+ * over a 64 MiB synthetic log and tells the speedup over no-likely and if
+ * it's significant, a Mann-Whitney U test of the runs:
+ * $ meson setup build && ninja -C build bench-variants
+ * $ RUNS=50 CPU=2 ninja -C build bench-variants
  */
 
 #include <glib.h>
-
-static void
-usage (void)
-{
-  g_message ("usage:\nmygrep <filename> <string to search>\n");
-}
+#include "mygrep-main.h"
 
 #ifdef WITH_G_LIKELY
 #define UNLIKELY G_UNLIKELY
 #define LIKELY G_LIKELY
+#define MYGREP_VARIANT "likely"
 #else
 #define UNLIKELY(x) x
 #define LIKELY(x) x
+#define MYGREP_VARIANT "no-likely"
+#endif
+
+/* how meson built it besides, -lto or -pgo */
+#ifndef MYGREP_BUILD
+#define MYGREP_BUILD ""
 #endif
 
 static int
@@ -91,8 +227,8 @@ run_search (const char *where, const char *what)
        * - match is found. */
       if (UNLIKELY (what[what_i] == 0)) {
         ans++;
-        /* no need to scan this part again */
-        where_i = wi;
+        /* no need to scan this part again, the loop steps to wi */
+        where_i = wi - 1;
         break;
       }
 
@@ -114,52 +250,9 @@ run_search (const char *where, const char *what)
 int
 main (int argc, char **argv)
 {
-  char *file;
-  gsize length;
-  gint64 measurement_start, measurement = 0;
-  int ans = -1, nr, num_runs = 100;
-
-  if (argc < 2) {
-    g_warning ("need file name\n");
-    goto bad_arguments;
-  }
-
-  if (argc < 3) {
-    g_warning ("need search string\n");
-    goto bad_arguments;
-  }
-
-  if (!g_file_get_contents (argv[1], &file, &length, NULL)) {
-    g_warning ("couldn't read file");
-    return 1;
-  }
-
-  g_message ("File size = %" G_GSIZE_FORMAT " bytes, checking %d times", length,
-      num_runs);
-
-  for (nr = 0; nr < num_runs; nr++) {
-    int prev_ans = -1;
-    if (ans != -1)
-      prev_ans = ans;
-
-    g_message ("check number %d", nr);
-    measurement_start = g_get_monotonic_time ();
-    ans = run_search (file, argv[2]);
-    measurement += g_get_monotonic_time () - measurement_start;
-
-    if (prev_ans != -1 && ans != prev_ans) {
-      g_error ("Sanity check failed\n");
-    }
-  }
-
-  g_message ("---------------------------------------------------------------");
-  g_message ("Total time elapsed: %" G_GINT64_FORMAT " us\n", measurement);
-  g_message ("matches found: %d\n", ans);
-
-  g_free (file);
-  return 0;
+  static const MygrepTool tool = {
+    "unlikely", MYGREP_VARIANT MYGREP_BUILD, run_search
+  };
 
-bad_arguments:
-  usage ();
-  return 1;
+  return mygrep_main (argc, argv, &tool);
 }